@@ -15,6 +15,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/string_cast.hpp>
 
+#include "framebuffer_display.h"
+
 using namespace glm;
 
 // -------------------------------------------------
@@ -22,7 +24,8 @@ using namespace glm;
 // -------------------------------------------------
 int Width = 1280;
 int Height = 720;
-std::vector<float> OutputImage;
+Framebuffer OutputImage;
+FramebufferDisplay Display;
 // -------------------------------------------------
 
 
@@ -34,7 +37,7 @@ void render()
 	//want a responsive display of our beautiful image.
 	//Instead we draw to another buffer and copy this to the 
 	//framebuffer using glDrawPixels(...) every refresh
-	OutputImage.clear();
+	OutputImage.resize(Width, Height);
 	for (int j = 0; j < Height; ++j) 
 	{
 		for (int i = 0; i < Width; ++i) 
@@ -53,9 +56,7 @@ void render()
 			}
 			
 			// set the color
-			OutputImage.push_back(color.x); // R
-			OutputImage.push_back(color.y); // G
-			OutputImage.push_back(color.z); // B
+			OutputImage.set(i, j, color.x, color.y, color.z);
 		}
 	}
 }
@@ -80,15 +81,19 @@ void resize_callback(GLFWwindow*, int nw, int nh)
 		, 0.0, static_cast<double>(Height)
 		, 1.0, -1.0);
 
-	//Reserve memory for our render so that we don't do 
-	//excessive allocations and render the image
-	OutputImage.reserve(Width * Height * 3);
+	//Resize our render target (it only reallocates when the window grows)
+	//and render the image
+	OutputImage.resize(Width, Height);
 	render();
+	display_mark_dirty(Display);
 }
 
 
 int main(int argc, char* argv[])
 {
+	// "-display pixels": draw with glDrawPixels every frame (for comparison)
+	DisplayMode displayMode = display_mode_from_args(argc, argv);
+
 	// -------------------------------------------------
 	// Initialize Window
 	// -------------------------------------------------
@@ -119,6 +124,10 @@ int main(int argc, char* argv[])
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
+	//Upload the image into a texture through a pixel buffer object only when
+	//it changes (or use glDrawPixels every frame with "-display pixels")
+	display_init(Display, displayMode);
+
 	//We call our resize function once to set everything up initially
 	//after registering it as a callback with glfw
 	glfwSetFramebufferSizeCallback(window, resize_callback);
@@ -132,7 +141,7 @@ int main(int argc, char* argv[])
 
 		// -------------------------------------------------------------
 		//Rendering begins!
-		glDrawPixels(Width, Height, GL_RGB, GL_FLOAT, &OutputImage[0]);
+		display_draw(Display, OutputImage);
 		//and ends.
 		// -------------------------------------------------------------
 
@@ -150,6 +159,7 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	display_release(Display);
 	glfwDestroyWindow(window);
 	glfwTerminate();
 	return 0;
@@ -15,6 +15,10 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/string_cast.hpp>
 
+#include "camera.h"
+#include "framebuffer_display.h"
+#include "scene_file.h"
+
 using namespace glm;
 
 // -------------------------------------------------
@@ -22,16 +26,29 @@ using namespace glm;
 // -------------------------------------------------
 int Width = 512;
 int Height = 512;
-std::vector<float> OutputImage;
+Framebuffer OutputImage;
+FramebufferDisplay Display;
+
+//  Ͽ д´ (⺻ ../scenes/hw2.json,  HW2 )
+SceneData gScene;
 // -------------------------------------------------
 
 
 
 void render()
 {
-	OutputImage.clear();
+	OutputImage.resize(Width, Height);
+
+	//  ǥ (eye, u, v, w)  ̹  (l, r, b, t, ̹  Ÿ d)
+	Camera camera;
+	camera_setup(camera, gScene.camera, Width, Height);
+	const SceneSpheres& spheres = gScene.spheres;
+	std::vector<float> row_dirs(3 * Width);	//     (x , y , z )
+
 	for (int j = 0; j < Height; ++j)
 	{
+		// ȼ ߽     Ѳ 
+		camera_row_dirs(camera, j, &row_dirs[0], &row_dirs[Width], &row_dirs[2 * Width]);
 		for (int i = 0; i < Width; ++i)
 		{
 			// ---------------------------------------------------
@@ -40,47 +57,19 @@ void render()
 
 			// ------------------------------------------
 
-			vec3 eye(0.0f, 0.0f, 0.0f);
-			vec3 u(1, 0, 0), v(0, 1, 0), w(0, 0, 1); //  ǥ
-			float l = -0.1f, r = 0.1f;
-			float b = -0.1f, t = 0.1f;
-			float d = 0.1f; // ̹  Ÿ
-
-			// ȼ ߽ ǥ  u, v ġ 
-			float u_coord = l + (r - l) * (i + 0.5f) / Width;
-			float v_coord = b + (t - b) * (j + 0.5f) / Height;
-
-			// ̹  ȼ ġ
-			vec3 pixel_pos = eye - d * w + u_coord * u + v_coord * v;
-			vec3 ray_dir = normalize(pixel_pos - eye);
-
 			//  
-			vec3 ray_origin = eye;
-			vec3 ray_direction = ray_dir;
-
-
+			vec3 ray_origin(camera.eye[0], camera.eye[1], camera.eye[2]);
+			vec3 ray_direction(row_dirs[i], row_dirs[Width + i], row_dirs[2 * Width + i]);
 
-			//  3 
-			struct Sphere {
-				vec3 center;
-				float radius;
-			};
-			std::vector<Sphere> spheres = {
-				{ vec3(-4, 0, -7), 1.0f },
-				{ vec3(0, 0, -7), 2.0f },
-				{ vec3(4, 0, -7), 1.0f }
-			};
 
-			//   (y = -2)
-			float plane_y = -2.0f;
 
 			// ̿   ˻
 			bool hit = false;
-			for (const auto& s : spheres) {
-				vec3 oc = ray_origin - s.center;
+			for (size_t k = 0; k < spheres.size(); ++k) {
+				vec3 oc = ray_origin - vec3(spheres.cx[k], spheres.cy[k], spheres.cz[k]);
 				float a = dot(ray_direction, ray_direction);
 				float b = 2.0f * dot(oc, ray_direction);
-				float c = dot(oc, oc) - s.radius * s.radius;
+				float c = dot(oc, oc) - spheres.radius[k] * spheres.radius[k];
 				float discriminant = b * b - 4 * a * c;
 				if (discriminant > 0.0f) {
 					hit = true;
@@ -88,18 +77,21 @@ void render()
 				}
 			}
 
-			// ̿   ˻ (y = -2)
-			if (!hit && ray_direction.y != 0.0f) {
-				float t = (plane_y - ray_origin.y) / ray_direction.y;
-				if (t > 0.0f) hit = true;
+			// ̿   ˻ (dot(n, p) = offset)
+			for (size_t k = 0; !hit && k < gScene.planes.size(); ++k) {
+				const ScenePlane& plane = gScene.planes[k];
+				vec3 n(plane.normal[0], plane.normal[1], plane.normal[2]);
+				float denom = dot(n, ray_direction);
+				if (denom != 0.0f) {
+					float t = (plane.offset - dot(n, ray_origin)) / denom;
+					if (t > 0.0f) hit = true;
+				}
 			}
 
 			// ȼ  
 			vec3 color = hit ? vec3(1.0f) : vec3(0.0f);  //  or 
 
-			OutputImage.push_back(color.x); // R
-			OutputImage.push_back(color.y); // G
-			OutputImage.push_back(color.z); // B
+			OutputImage.set(i, j, color.x, color.y, color.z);
 
 		}
 	}
@@ -125,15 +117,21 @@ void resize_callback(GLFWwindow*, int nw, int nh)
 		, 0.0, static_cast<double>(Height)
 		, 1.0, -1.0);
 
-	//Reserve memory for our render so that we don't do 
-	//excessive allocations and render the image
-	OutputImage.reserve(Width * Height * 3);
+	//Resize our render target (it only reallocates when the window grows)
+	//and render the image
+	OutputImage.resize(Width, Height);
 	render();
+	display_mark_dirty(Display);
 }
 
 
 int main(int argc, char* argv[])
 {
+	// "-display pixels": draw with glDrawPixels every frame (for comparison)
+	DisplayMode displayMode = display_mode_from_args(argc, argv);
+	//   (ϸ ../scenes/hw2.json)
+	load_scene_or_default(argc > 1 ? argv[1] : "../scenes/hw2.json", gScene);
+
 	// -------------------------------------------------
 	// Initialize Window
 	// -------------------------------------------------
@@ -164,6 +162,10 @@ int main(int argc, char* argv[])
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
+	//Upload the image into a texture through a pixel buffer object only when
+	//it changes (or use glDrawPixels every frame with "-display pixels")
+	display_init(Display, displayMode);
+
 	//We call our resize function once to set everything up initially
 	//after registering it as a callback with glfw
 	glfwSetFramebufferSizeCallback(window, resize_callback);
@@ -177,7 +179,7 @@ int main(int argc, char* argv[])
 
 		// -------------------------------------------------------------
 		//Rendering begins!
-		glDrawPixels(Width, Height, GL_RGB, GL_FLOAT, &OutputImage[0]);
+		display_draw(Display, OutputImage);
 		//and ends.
 		// -------------------------------------------------------------
 
@@ -195,6 +197,7 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	display_release(Display);
 	glfwDestroyWindow(window);
 	glfwTerminate();
 	return 0;
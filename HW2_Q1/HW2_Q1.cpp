@@ -16,8 +16,14 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/string_cast.hpp>
 
+#include "camera.h"
+#include "framebuffer_display.h"
+#include "material_table.h"
+#include "scene_file.h"
+
 using namespace glm;
 
 // -------------------------------------------------
@@ -25,137 +31,134 @@ using namespace glm;
 // -------------------------------------------------
 int Width = 512;
 int Height = 512;
-std::vector<float> OutputImage;
+Framebuffer OutputImage;
+FramebufferDisplay Display;
+
+//  Ͽ д´ (⺻ ../scenes/hw2.json,  HW2 )
+SceneData gScene;
+// ̵  ̺ (gScene.materials  Ӽ 迭 ű , ȣ )
+MaterialTable gMaterials;
 // -------------------------------------------------
 
+void build_material_table()
+{
+	gMaterials = MaterialTable();
+	for (const SceneMaterial& m : gScene.materials)
+		gMaterials.add(m.ka, m.kd, m.ks, m.specPow);
+}
 
 
 void render()
 {
-	OutputImage.clear();
+	OutputImage.resize(Width, Height);
+
+	Camera camera;
+	camera_setup(camera, gScene.camera, Width, Height);
+	const SceneSpheres& spheres = gScene.spheres;
+	std::vector<float> row_dirs(3 * Width);	//     (x , y , z )
+
 	for (int j = 0; j < Height; ++j)
 	{
+		camera_row_dirs(camera, j, &row_dirs[0], &row_dirs[Width], &row_dirs[2 * Width]);
 		for (int i = 0; i < Width; ++i)
 		{
-			vec3 eye(0.0f, 0.0f, 0.0f);
-			vec3 u(1, 0, 0), v(0, 1, 0), w(0, 0, 1);
-			float l = -0.1f, r = 0.1f;
-			float b = -0.1f, t = 0.1f;
-			float d = 0.1f;
-
-			float u_coord = l + (r - l) * (i + 0.5f) / Width;
-			float v_coord = b + (t - b) * (j + 0.5f) / Height;
-			vec3 pixel_pos = eye - d * w + u_coord * u + v_coord * v;
-			vec3 ray_dir = normalize(pixel_pos - eye);
-
-			vec3 ray_origin = eye;
-			vec3 ray_direction = ray_dir;
-
-			struct Sphere {
-				vec3 center;
-				float radius;
-			};
-
-			std::vector<Sphere> spheres = {
-				{ vec3(-4, 0, -7), 1.0f },
-				{ vec3(0, 0, -7), 2.0f },
-				{ vec3(4, 0, -7), 1.0f }
-			};
-
-			float plane_y = -2.0f;
+			vec3 ray_origin(camera.eye[0], camera.eye[1], camera.eye[2]);
+			vec3 ray_direction(row_dirs[i], row_dirs[Width + i], row_dirs[2 * Width + i]);
+
 			vec3 color(0.0f);
 
 			float closest_t = std::numeric_limits<float>::infinity();
-			int hit_sphere_index = -1;
+			uint32_t hit_material = 0;
 			vec3 hit_point, normal;
 
 			//  
-			for (int k = 0; k < spheres.size(); ++k) {
-				vec3 oc = ray_origin - spheres[k].center;
+			for (size_t k = 0; k < spheres.size(); ++k) {
+				vec3 center(spheres.cx[k], spheres.cy[k], spheres.cz[k]);
+				vec3 oc = ray_origin - center;
 				float a = dot(ray_direction, ray_direction);
 				float b = 2.0f * dot(oc, ray_direction);
-				float c = dot(oc, oc) - spheres[k].radius * spheres[k].radius;
+				float c = dot(oc, oc) - spheres.radius[k] * spheres.radius[k];
 				float discriminant = b * b - 4 * a * c;
 				if (discriminant > 0.0f) {
 					float t = (-b - std::sqrt(discriminant)) / (2.0f * a);
 					if (t > 0.001f && t < closest_t) {
 						closest_t = t;
-						hit_sphere_index = k;
+						hit_material = spheres.material[k];
 						hit_point = ray_origin + t * ray_direction;
-						normal = normalize(hit_point - spheres[k].center);
+						normal = normalize(hit_point - center);
 					}
 				}
 			}
 
-			//  
-			if (ray_direction.y != 0.0f) {
-				float t = (plane_y - ray_origin.y) / ray_direction.y;
-				if (t > 0.001f && t < closest_t) {
-					closest_t = t;
-					hit_sphere_index = -2;
-					hit_point = ray_origin + t * ray_direction;
-					normal = vec3(0, 1, 0);
+			//   (dot(n, p) = offset)
+			for (const ScenePlane& plane : gScene.planes) {
+				vec3 n = make_vec3(plane.normal);
+				float denom = dot(n, ray_direction);
+				if (denom != 0.0f) {
+					float t = (plane.offset - dot(n, ray_origin)) / denom;
+					if (t > 0.001f && t < closest_t) {
+						closest_t = t;
+						hit_material = plane.material;
+						hit_point = ray_origin + t * ray_direction;
+						normal = n;
+					}
 				}
 			}
 
 			if (closest_t < std::numeric_limits<float>::infinity()) {
-				vec3 light_pos(-4, 4, -3);
-				vec3 light_color(1, 1, 1);
-				vec3 to_light = normalize(light_pos - hit_point);
 				vec3 to_camera = normalize(-ray_direction);
-				vec3 reflect_dir = reflect(-to_light, normal);
-
-				// ׸ ˻
 				vec3 shadow_origin = hit_point + 0.001f * normal;
-				vec3 shadow_ray = to_light;
-				bool in_shadow = false;
-				for (const auto& s : spheres) {
-					vec3 oc = shadow_origin - s.center;
-					float a = dot(shadow_ray, shadow_ray);
-					float b = 2.0f * dot(oc, shadow_ray);
-					float c = dot(oc, oc) - s.radius * s.radius;
-					float discriminant = b * b - 4 * a * c;
-					if (discriminant > 0.0f) {
-						float t = (-b - std::sqrt(discriminant)) / (2.0f * a);
-						if (t > 0.001f) {
-							in_shadow = true;
-							break;
+
+				//   ( ȣ ̺ ȸ)
+				vec3 ka = make_vec3(&gMaterials.ka[3 * hit_material]);
+				vec3 kd = make_vec3(&gMaterials.kd[3 * hit_material]);
+				vec3 ks = make_vec3(&gMaterials.ks[3 * hit_material]);
+				float spec_pow = gMaterials.specPow[hit_material];
+
+				for (const SceneLight& light : gScene.lights) {
+					vec3 light_color = make_vec3(light.color);
+					vec3 to_light = normalize(make_vec3(light.position) - hit_point);
+
+					// ׸ ˻ ( )
+					vec3 shadow_ray = to_light;
+					bool in_shadow = false;
+					for (size_t k = 0; k < spheres.size(); ++k) {
+						vec3 oc = shadow_origin - vec3(spheres.cx[k], spheres.cy[k], spheres.cz[k]);
+						float a = dot(shadow_ray, shadow_ray);
+						float b = 2.0f * dot(oc, shadow_ray);
+						float c = dot(oc, oc) - spheres.radius[k] * spheres.radius[k];
+						float discriminant = b * b - 4 * a * c;
+						if (discriminant > 0.0f) {
+							float t = (-b - std::sqrt(discriminant)) / (2.0f * a);
+							if (t > 0.001f) {
+								in_shadow = true;
+								break;
+							}
 						}
 					}
-				}
-
-				//  
-				vec3 ka, kd, ks;
-				float spec_pow;
-				if (hit_sphere_index == 0) {
-					ka = vec3(0.2, 0, 0); kd = vec3(1, 0, 0); ks = vec3(0); spec_pow = 0;
-				}
-				else if (hit_sphere_index == 1) {
-					ka = vec3(0, 0.2, 0); kd = vec3(0, 0.5, 0); ks = vec3(0.5); spec_pow = 32;
-				}
-				else if (hit_sphere_index == 2) {
-					ka = vec3(0, 0, 0.2); kd = vec3(0, 0, 1); ks = vec3(0); spec_pow = 0;
-				}
-				else {
-					ka = vec3(0.2); kd = vec3(1); ks = vec3(0); spec_pow = 0;
-				}
 
-				//  
-				color += ka * light_color;
-				if (!in_shadow) {
-					float diff = max(dot(normal, to_light), 0.0f);
-					float spec = pow(max(dot(reflect_dir, to_camera), 0.0f), spec_pow);
-					color += kd * light_color * diff;
-					color += ks * light_color * spec;
+					//  
+					color += ka * light_color;
+					if (!in_shadow) {
+						float diff = max(dot(normal, to_light), 0.0f);
+						color += kd * light_color * diff;
+						// spec_pow == 0: pow(x, 0) = 1 ̹Ƿ ݻ Ϳ pow  ks ״
+						if (spec_pow == 0.0f) {
+							color += ks * light_color;
+						}
+						else {
+							vec3 reflect_dir = reflect(-to_light, normal);
+							float spec = pow(max(dot(reflect_dir, to_camera), 0.0f), spec_pow);
+							color += ks * light_color * spec;
+						}
+					}
 				}
 
 				color = clamp(color, 0.0f, 1.0f);
 			}
 
 			// ̹  
-			OutputImage.push_back(color.r);
-			OutputImage.push_back(color.g);
-			OutputImage.push_back(color.b);
+			OutputImage.set(i, j, color.r, color.g, color.b);
 		}
 	}
 }
@@ -180,21 +183,29 @@ void resize_callback(GLFWwindow*, int nw, int nh)
 		, 0.0, static_cast<double>(Height)
 		, 1.0, -1.0);
 
-	//Reserve memory for our render so that we don't do 
-	//excessive allocations and render the image
-	OutputImage.reserve(Width * Height * 3);
+	//Resize our render target (it only reallocates when the window grows)
+	//and render the image
+	OutputImage.resize(Width, Height);
 	render();
+	display_mark_dirty(Display);
 }
 
 
 int main(int argc, char* argv[])
 {
+	// "-display pixels": draw with glDrawPixels every frame (for comparison)
+	DisplayMode displayMode = display_mode_from_args(argc, argv);
+	//   (ϸ ../scenes/hw2.json)
+	load_scene_or_default(argc > 1 ? argv[1] : "../scenes/hw2.json", gScene);
+
 	// -------------------------------------------------
 	// Initialize Window
 	// -------------------------------------------------
 
 	GLFWwindow* window;
 
+	build_material_table();
+
 	/* Initialize the library */
 	if (!glfwInit())
 		return -1;
@@ -219,6 +230,10 @@ int main(int argc, char* argv[])
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
+	//Upload the image into a texture through a pixel buffer object only when
+	//it changes (or use glDrawPixels every frame with "-display pixels")
+	display_init(Display, displayMode);
+
 	//We call our resize function once to set everything up initially
 	//after registering it as a callback with glfw
 	glfwSetFramebufferSizeCallback(window, resize_callback);
@@ -232,7 +247,7 @@ int main(int argc, char* argv[])
 
 		// -------------------------------------------------------------
 		//Rendering begins!
-		glDrawPixels(Width, Height, GL_RGB, GL_FLOAT, &OutputImage[0]);
+		display_draw(Display, OutputImage);
 		//and ends.
 		// -------------------------------------------------------------
 
@@ -250,6 +265,7 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	display_release(Display);
 	glfwDestroyWindow(window);
 	glfwTerminate();
 	return 0;
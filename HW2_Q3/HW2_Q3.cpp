@@ -1,15 +1,21 @@
 #include <Windows.h>
+#include <atomic>
 #include <iostream>
 #include <GL/glew.h>
 #include <GL/GL.h>
 #include <GL/freeglut.h>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <chrono>
 #include <limits>
+#include <sys/stat.h>
 
 #define GLFW_INCLUDE_GLU
 #define GLFW_DLL
 #include <GLFW/glfw3.h>
+#include <thread>
 #include <vector>
 
 #define GLM_SWIZZLE
@@ -18,131 +24,472 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/string_cast.hpp>
 
+#include "camera.h"
+#include "framebuffer_display.h"
+#include "material_table.h"
+#include "mesh_bvh.h"
+#include "path_tracer.h"
+#include "scene_file.h"
+
 using namespace glm;
 
 int Width = 512;
 int Height = 512;
-std::vector<float> OutputImage;
+Framebuffer OutputImage;
+FramebufferDisplay Display;
 
-void render()
+//  Ͽ д´ (⺻ ../scenes/hw2.json,  HW2 )
+SceneData gScene;
+// ̵  ̺ (gScene.materials  Ӽ 迭 ű , ȣ )
+MaterialTable gMaterials;
+
+//  .obj ޽.   center/scale  ű BVH  
+struct TracedMesh {
+	TriMesh mesh;
+	MeshBvh bvh;
+	uint32_t material;
+};
+std::vector<TracedMesh> gMeshes;
+
+//  kSphereBvhMin  ̸̻ BVH  ã´ (  ˻ϴ  )
+const size_t kSphereBvhMin = 32;
+const uint32_t kSphereLeafSize = 4;
+BvhBuildResult gSphereBvh;
+
+// -path:   б   (â ׸   н )
+bool gPathMode = false;
+PathTracer gPath;
+
+// -stream: Whitted   Ʈ (ĸ , )  
+bool gStreamMode = false;
+
+// -wavefront: Whitted  ܰ躰 ĸ  (SoA ť, ۾ )  
+bool gWavefrontMode = false;
+
+vec3 to_vec3(const float* v)
+{
+	return vec3(v[0], v[1], v[2]);
+}
+
+void build_material_table()
+{
+	gMaterials = MaterialTable();
+	for (const SceneMaterial& m : gScene.materials)
+		gMaterials.add(m.ka, m.kd, m.ks, m.specPow, m.kr, m.kt, m.ior);
+}
+
+bool is_obj_file(const std::string& source)
 {
-	OutputImage.clear();
+	return source.size() > 4 && _stricmp(source.c_str() + source.size() - 4, ".obj") == 0;
+}
 
-	vec3 eye(0.0f);
-	vec3 u(1, 0, 0), v(0, 1, 0), w(0, 0, 1);
-	float l = -0.1f, r = 0.1f, b = -0.1f, t = 0.1f, d = 0.1f;
+void load_meshes()
+{
+	gMeshes.clear();
+	for (const SceneMesh& m : gScene.meshes) {
+		if (!is_obj_file(m.source)) {
+			printf("[Mesh] skipping '%s' (only .obj meshes are ray traced)\n", m.source.c_str());
+			continue;
+		}
+		gMeshes.emplace_back();
+		TracedMesh& traced = gMeshes.back();
+		if (!load_obj_mesh(m.source.c_str(), traced.mesh)) {
+			gMeshes.pop_back();
+			continue;
+		}
+		place_mesh(traced.mesh, m.center, m.scale);
+		build_mesh_bvh(traced.bvh, traced.mesh);
+		size_t binaryBytes = mesh_bvh_bytes(traced.bvh);
+		collapse_mesh_bvh4(traced.bvh);
+		traced.material = m.material;
+
+		// ﰢ ޸: BVH ( +  )  ޽ (, , ε)
+		double tris = (double)traced.mesh.triangle_count();
+		double meshBytes = (traced.mesh.positions.size() + traced.mesh.normals.size()) * sizeof(float)
+			+ traced.mesh.indices.size() * sizeof(uint32_t);
+		printf("[Mesh] %s: %d tris, BVH %d nodes / %d leaves, build %.1f ms, %.1f bytes/tri (BVH %.1f + mesh %.1f), %s kernel\n",
+			m.source.c_str(), (int)tris, (int)traced.bvh.nodes.size(), (int)traced.bvh.blocks.size(), traced.bvh.buildMs,
+			(mesh_bvh_bytes(traced.bvh) + meshBytes) / tris, mesh_bvh_bytes(traced.bvh) / tris, meshBytes / tris,
+			mesh_bvh_kernel_name());
+		printf("[Mesh]   BVH4 %d nodes, collapse %.1f ms, %.1f bytes/tri (binary %.1f)\n",
+			(int)traced.bvh.wide.size(), traced.bvh.collapseMs, mesh_bvh_bytes(traced.bvh) / tris, binaryBytes / tris);
+	}
+}
+
+void build_sphere_bvh(BvhBuildMethod method)
+{
+	const SceneSpheres& spheres = gScene.spheres;
+	gSphereBvh = BvhBuildResult();
+	if (spheres.size() < kSphereBvhMin)
+		return;
+	std::vector<float> bounds(spheres.size() * 6);
+	for (size_t k = 0; k < spheres.size(); ++k) {
+		// ġ   ݿø   ۿ   ־  
+		float c[3] = { spheres.cx[k], spheres.cy[k], spheres.cz[k] };
+		float r = spheres.radius[k] * 1.001f;
+		for (int a = 0; a < 3; ++a) {
+			bounds[k * 6 + a] = c[a] - r;
+			bounds[k * 6 + 3 + a] = c[a] + r;
+		}
+	}
+	BvhBuildOptions options;
+	options.method = method;
+	options.maxLeafSize = kSphereLeafSize;
+	build_bvh(bounds.data(), spheres.size(), options, gSphereBvh);
+	printf("[Spheres] %d spheres, %s BVH %d nodes, build %.1f ms\n", (int)spheres.size(), bvh_build_method_name(method),
+		(int)gSphereBvh.nodes.size(), gSphereBvh.ms);
+}
+
+//  k   t ( -1). farRoot    0.001   ( ȿ )  
+float hit_sphere(size_t k, const vec3& origin, const vec3& dir, bool farRoot)
+{
+	const SceneSpheres& spheres = gScene.spheres;
+	vec3 oc = origin - vec3(spheres.cx[k], spheres.cy[k], spheres.cz[k]);
+	float a = dot(dir, dir);
+	float b = 2.0f * dot(oc, dir);
+	float c = dot(oc, oc) - spheres.radius[k] * spheres.radius[k];
+	float discriminant = b * b - 4 * a * c;
+	if (discriminant <= 0.0f)
+		return -1.0f;
+	float root = std::sqrt(discriminant);
+	float t = (-b - root) / (2.0f * a);
+	if (farRoot && t <= 0.001f)
+		t = (-b + root) / (2.0f * a);
+	return t;
+}
+
+bool occluded_spheres(const vec3& origin, const vec3& dir)
+{
+	const SceneSpheres& spheres = gScene.spheres;
+	if (gSphereBvh.nodes.empty()) {
+		for (size_t k = 0; k < spheres.size(); ++k)
+			if (hit_sphere(k, origin, dir, false) > 0.001f)
+				return true;
+		return false;
+	}
+	float tMax = std::numeric_limits<float>::infinity();
+	return traverse_bvh(gSphereBvh.nodes, &origin[0], &dir[0], tMax, true, [&](uint32_t first, uint32_t count, float&) {
+		for (uint32_t q = 0; q < count; ++q)
+			if (hit_sphere(gSphereBvh.order[first + q], origin, dir, false) > 0.001f)
+				return true;
+		return false;
+	});
+}
+
+bool occluded_meshes(const vec3& origin, const vec3& dir)
+{
+	for (const TracedMesh& m : gMeshes)
+		if (occluded_mesh_bvh(m.bvh, &origin[0], &dir[0], std::numeric_limits<float>::infinity()))
+			return true;
+	return false;
+}
+
+// ׸    ޽ 
+bool occluded(const vec3& origin, const vec3& dir)
+{
+	return occluded_spheres(origin, dir) || occluded_meshes(origin, dir);
+}
+
+// -------------------------------------------------
+// Whitted :    ũ  
+//    ݻ/  ִ 2 װ  켱 .
+//     ̰ 1 ð ̺   ϳ Ƿ
+//   ÿ kMaxDepth + 1  ̻  ʴ´.
+//   ⿩ (weight)  kRouletteWeight    Russian roulette  ´.
+// -------------------------------------------------
+const int kMaxDepth = 5;
+const int kRayStackSize = kMaxDepth + 1;
+const float kRouletteWeight = 0.05f;
+
+struct RayTask {
+	vec3 origin, dir;
+	vec3 weight;		//    ȼ  
+	int depth;			// 0: 1 
+};
+
+// ̺   (render  )
+struct RayStats {
+	uint64_t rays[kMaxDepth + 1];
+	uint64_t shadowRays;
+	uint64_t roulette;	// Russian roulette   
+};
+RayStats gRayStats;
+
+// xorshift32. ȼ Ϳ rand()   ٲ ʵ  д
+uint32_t gRouletteState = 1;
+
+float roulette_random(uint32_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+double elapsed_ms(std::chrono::high_resolution_clock::time_point t0)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+//    ( -1).  ȿ   ()     . closest_t   ͸
+int closest_sphere(const vec3& ray_origin, const vec3& ray_direction, float& closest_t)
+{
+	const SceneSpheres& spheres = gScene.spheres;
+	int closest = -1;
 
-	struct Sphere {
-		vec3 center;
-		float radius;
+	// --- ̿   ˻ ( BVH) ---
+	auto test_sphere = [&](size_t k) {
+		float t = hit_sphere(k, ray_origin, ray_direction, true);
+		if (t > 0.001f && t < closest_t) {
+			closest_t = t;
+			closest = (int)k;
+			return true;
+		}
+		return false;
 	};
+	if (gSphereBvh.nodes.empty()) {
+		for (size_t k = 0; k < spheres.size(); ++k)
+			test_sphere(k);
+	}
+	else {
+		// closest_t  tMax  ѱǷ test_sphere    ״ ȸ δ
+		traverse_bvh(gSphereBvh.nodes, &ray_origin[0], &ray_direction[0], closest_t, false, [&](uint32_t first, uint32_t count, float&) {
+			bool hit = false;
+			for (uint32_t q = 0; q < count; ++q)
+				hit = test_sphere(gSphereBvh.order[first + q]) || hit;
+			return hit;
+		});
+	}
+	return closest;
+}
+
+void sphere_hit(size_t k, const vec3& ray_origin, const vec3& ray_direction, float t, vec3& hit_point, vec3& normal,
+	uint32_t& hit_material)
+{
+	const SceneSpheres& spheres = gScene.spheres;
+	hit_material = spheres.material[k];
+	hit_point = ray_origin + t * ray_direction;
+	normal = normalize(hit_point - vec3(spheres.cx[k], spheres.cy[k], spheres.cz[k]));
+}
+
+//    ޽ ˻Ѵ. closest_t     closest_t    ٲ۴
+void intersect_planes_meshes(const vec3& ray_origin, const vec3& ray_direction, float& closest_t, vec3& hit_point,
+	vec3& normal, uint32_t& hit_material)
+{
+	// --- ̿   ˻ (dot(n, p) = offset) ---
+	for (const ScenePlane& plane : gScene.planes) {
+		vec3 n = to_vec3(plane.normal);
+		float denom = dot(n, ray_direction);
+		if (denom != 0.0f) {
+			float t = (plane.offset - dot(n, ray_origin)) / denom;
+			if (t > 0.001f && t < closest_t) {
+				closest_t = t;
+				hit_material = plane.material;
+				hit_point = ray_origin + t * ray_direction;
+				normal = n;
+			}
+		}
+	}
+
+	// --- ̿ ﰢ ޽  ˻ (BVH) ---
+	for (const TracedMesh& m : gMeshes) {
+		MeshHit hit;
+		if (intersect_mesh_bvh(m.bvh, &ray_origin[0], &ray_direction[0], closest_t, hit)) {
+			closest_t = hit.t;
+			hit_material = m.material;
+			hit_point = ray_origin + hit.t * ray_direction;
+			mesh_hit_normal(m.mesh, hit, &normal[0]);
 
-	std::vector<Sphere> spheres = {
-		{ vec3(-4, 0, -7), 1.0f },
-		{ vec3(0, 0, -7), 2.0f },
-		{ vec3(4, 0, -7), 1.0f }
+			// Ƿ翧 ó    ݴ ϸ    (/   ʰ)
+			//   ϰ    ٱ 
+			vec3 face;
+			mesh_triangle_normal(m.mesh, hit.triangle, &face[0]);
+			if (dot(face, normal) < 0.0f)
+				face = -face;
+			if ((dot(face, ray_direction) < 0.0f) != (dot(normal, ray_direction) < 0.0f))
+				normal = face;
+		}
+	}
+}
+
+//   
+bool intersect(const vec3& ray_origin, const vec3& ray_direction, vec3& hit_point, vec3& normal, uint32_t& hit_material)
+{
+	float closest_t = std::numeric_limits<float>::infinity();
+	int sphere = closest_sphere(ray_origin, ray_direction, closest_t);
+	if (sphere >= 0)
+		sphere_hit(sphere, ray_origin, ray_direction, closest_t, hit_point, normal, hit_material);
+	intersect_planes_meshes(ray_origin, ray_direction, closest_t, hit_point, normal, hit_material);
+	return closest_t < std::numeric_limits<float>::infinity();
+}
+
+// --- Phong    ( ׸  ϳ) ---
+// visible   ׸   ʰ  ̸     ( Ʈ, ĸ).
+// ̶ ׸   ȣ  
+vec3 shade_phong(const vec3& hit_point, const vec3& normal, const vec3& ray_direction, uint32_t hit_material,
+	const uint8_t* visible = nullptr)
+{
+	// --- (Material) Ķ: ü   ȣ ȸ ---
+	vec3 ka = to_vec3(&gMaterials.ka[3 * hit_material]);
+	vec3 kd = to_vec3(&gMaterials.kd[3 * hit_material]);
+	vec3 ks = to_vec3(&gMaterials.ks[3 * hit_material]);
+	float spec_pow = gMaterials.specPow[hit_material];
+
+	vec3 color(0.0f);
+	vec3 to_camera = normalize(-ray_direction);
+	vec3 shadow_origin = hit_point + 0.001f * normal;
+	for (size_t l = 0; l < gScene.lights.size(); ++l) {
+		const SceneLight& light = gScene.lights[l];
+		vec3 light_color = to_vec3(light.color);
+		vec3 to_light = normalize(to_vec3(light.position) - hit_point);
+
+		// --- Phong shading  (׸ ˻ ) ---
+		color += ka * light_color;
+		bool lit;
+		if (visible) {
+			lit = visible[l] != 0;
+		}
+		else {
+			++gRayStats.shadowRays;
+			lit = !occluded(shadow_origin, to_light);
+		}
+		if (lit) {
+			float diff = max(dot(normal, to_light), 0.0f);
+			color += kd * light_color * diff;
+			// spec_pow == 0: pow(x, 0) = 1 ̹Ƿ ݻ Ϳ pow  ks ״
+			if (spec_pow == 0.0f) {
+				color += ks * light_color;
+			}
+			else {
+				vec3 reflect_dir = reflect(-to_light, normal);
+				float spec = pow(max(dot(reflect_dir, to_camera), 0.0f), spec_pow);
+				color += ks * light_color * spec;
+			}
+		}
+	}
+	return color;
+}
+
+// ray  hit_point   ݻ/  (Russian roulette   ͸)  out    ش
+// normal    ϵ  ־ Ѵ (inside:   鿡 ¾Ҵ).
+// roulette  ¿  Ѱܹ޴´ (ĸ  ۾ 帶  д)
+int spawn_secondary(const RayTask& ray, const vec3& hit_point, const vec3& normal, bool inside, uint32_t m, RayTask out[2],
+	uint32_t& rouletteState, RayStats& stats)
+{
+	float kr = gMaterials.kr[m], kt = gMaterials.kt[m];
+	if (ray.depth == kMaxDepth || (kr == 0.0f && kt == 0.0f))
+		return 0;
+
+	vec3 reflect_weight = ray.weight * kr;
+	vec3 refract_weight(0.0f);
+	vec3 refract_dir(0.0f);
+	if (kt > 0.0f) {
+		// Schlick ٻ.    ->      cos  
+		float ior = gMaterials.ior[m];
+		float r0 = (1.0f - ior) / (1.0f + ior);
+		r0 *= r0;
+		refract_dir = refract(ray.dir, normal, inside ? ior : 1.0f / ior);
+		float fresnel = 1.0f;	// ݻ (refract  0 )
+		if (dot(refract_dir, refract_dir) > 0.0f) {
+			float c = inside ? -dot(refract_dir, normal) : -dot(ray.dir, normal);
+			fresnel = r0 + (1.0f - r0) * pow(1.0f - c, 5.0f);
+		}
+		reflect_weight += ray.weight * (kt * fresnel);
+		refract_weight = ray.weight * (kt * (1.0f - fresnel));
+	}
+
+	const RayTask children[2] = {
+		{ hit_point + 0.001f * normal, reflect(ray.dir, normal), reflect_weight, ray.depth + 1 },
+		{ hit_point - 0.001f * normal, refract_dir, refract_weight, ray.depth + 1 },
 	};
+	int count = 0;
+	for (const RayTask& child : children) {
+		float w = max(child.weight.r, max(child.weight.g, child.weight.b));
+		if (w <= 0.0f)
+			continue;
+		RayTask next = child;
+		if (w < kRouletteWeight) {
+			// Ƴ   Ȯ   Ѵ
+			float survive = w / kRouletteWeight;
+			if (roulette_random(rouletteState) >= survive) {
+				++stats.roulette;
+				continue;
+			}
+			next.weight /= survive;
+		}
+		out[count++] = next;
+	}
+	return count;
+}
+
+// 1  ϳ :  Phong + kr * ݻ + kt * (Fresnel   ݻ/)
+vec3 trace(const vec3& origin, const vec3& dir)
+{
+	RayTask stack[kRayStackSize];
+	int top = 0;
+	stack[top++] = { origin, dir, vec3(1.0f), 0 };
+
+	vec3 color(0.0f);
+	while (top > 0) {
+		RayTask ray = stack[--top];
+		++gRayStats.rays[ray.depth];
+
+		vec3 hit_point, normal;
+		uint32_t m = 0;
+		if (!intersect(ray.origin, ray.dir, hit_point, normal, m))
+			continue;
+
+		//   (    )     ָ   ´
+		bool inside = dot(normal, ray.dir) > 0.0f;
+		if (inside)
+			normal = -normal;
+		else
+			color += ray.weight * clamp(shade_phong(hit_point, normal, ray.dir, m), 0.0f, 1.0f);
+
+		top += spawn_secondary(ray, hit_point, normal, inside, m, &stack[top], gRouletteState, gRayStats);
+	}
+	return color;
+}
+
+void print_ray_stats(int samples, double ms)
+{
+	double pixels = double(Width) * Height;
+	uint64_t total = gRayStats.shadowRays;
+	for (int d = 0; d <= kMaxDepth; ++d)
+		total += gRayStats.rays[d];
+
+	printf("[Whitted] %dx%d, %d samples/pixel, max depth %d: %.1f rays/pixel, %.0f ms, %.2f M rays/s\n",
+		Width, Height, samples, kMaxDepth, total / pixels, ms, total / (ms * 1000.0));
+	for (int d = 0; d <= kMaxDepth && gRayStats.rays[d]; ++d)
+		printf("  depth %d : %8.2f rays/pixel\n", d, gRayStats.rays[d] / pixels);
+	printf("  shadow  : %8.2f rays/pixel\n", gRayStats.shadowRays / pixels);
+	printf("  roulette: %llu rays terminated\n", (unsigned long long)gRayStats.roulette);
+}
+
+// width x height  ȼ N ÷ fb  ׸ (N == 1 ̸   ȼ ߽ ϳ)
+void render_whitted(Framebuffer& fb, int width, int height, int N)
+{
+	fb.resize(width, height);
 
-	float plane_y = -2.0f;
+	Camera camera;
+	camera_setup(camera, gScene.camera, width, height);
+	vec3 eye = to_vec3(camera.eye);
 
-	for (int j = 0; j < Height; ++j) {
-		for (int i = 0; i < Width; ++i) {
+	for (int j = 0; j < height; ++j) {
+		for (int i = 0; i < width; ++i) {
 			vec3 color_sum(0.0f);
-			int N = 64;
 
 			for (int s = 0; s < N; ++s) {
 				// ȼ ο  ø ǥ 
-				float ru = static_cast<float>(rand()) / RAND_MAX;
-				float rv = static_cast<float>(rand()) / RAND_MAX;
-
-				float u_coord = l + (r - l) * (i + ru) / Width;
-				float v_coord = b + (t - b) * (j + rv) / Height;
-
-				// ̹  ȼ ġ 
-				vec3 pixel_pos = eye - d * w + u_coord * u + v_coord * v;
-				vec3 ray_dir = normalize(pixel_pos - eye);
-				vec3 ray_origin = eye;
-				vec3 ray_direction = ray_dir;
-
-				float closest_t = std::numeric_limits<float>::infinity();
-				int hit_sphere_index = -1;
-				vec3 hit_point, normal;
-
-				// --- ̿   ˻ ---
-				for (int k = 0; k < spheres.size(); ++k) {
-					vec3 oc = ray_origin - spheres[k].center;
-					float a = dot(ray_direction, ray_direction);
-					float b = 2.0f * dot(oc, ray_direction);
-					float c = dot(oc, oc) - spheres[k].radius * spheres[k].radius;
-					float discriminant = b * b - 4 * a * c;
-					if (discriminant > 0.0f) {
-						float t = (-b - std::sqrt(discriminant)) / (2.0f * a);
-						if (t > 0.001f && t < closest_t) {
-							closest_t = t;
-							hit_sphere_index = k;
-							hit_point = ray_origin + t * ray_direction;
-							normal = normalize(hit_point - spheres[k].center);
-						}
-					}
-				}
+				float ru = N > 1 ? static_cast<float>(rand()) / RAND_MAX : 0.5f;
+				float rv = N > 1 ? static_cast<float>(rand()) / RAND_MAX : 0.5f;
 
-				// --- ̿   ˻ ---
-				if (ray_direction.y != 0.0f) {
-					float t = (plane_y - ray_origin.y) / ray_direction.y;
-					if (t > 0.001f && t < closest_t) {
-						closest_t = t;
-						hit_sphere_index = -2;
-						hit_point = ray_origin + t * ray_direction;
-						normal = vec3(0, 1, 0);
-					}
-				}
-
-				// --- Phong    ---
-				vec3 color(0.0f);
-				if (closest_t < std::numeric_limits<float>::infinity()) {
-					vec3 light_pos(-4, 4, -3);
-					vec3 light_color(1);
-					vec3 to_light = normalize(light_pos - hit_point);
-					vec3 to_camera = normalize(-ray_direction);
-					vec3 reflect_dir = reflect(-to_light, normal);
-
-					// --- ׸ ˻ ---
-					vec3 shadow_origin = hit_point + 0.001f * normal;
-					bool in_shadow = false;
-					for (const auto& s : spheres) {
-						vec3 oc = shadow_origin - s.center;
-						float a = dot(to_light, to_light);
-						float b = 2.0f * dot(oc, to_light);
-						float c = dot(oc, oc) - s.radius * s.radius;
-						float discriminant = b * b - 4 * a * c;
-						if (discriminant > 0.0f) {
-							float t = (-b - std::sqrt(discriminant)) / (2.0f * a);
-							if (t > 0.001f) {
-								in_shadow = true;
-								break;
-							}
-						}
-					}
-
-					// --- (Material) Ķ  ---
-					vec3 ka, kd, ks; float spec_pow;
-					if (hit_sphere_index == 0) { ka = vec3(0.2, 0, 0); kd = vec3(1, 0, 0); ks = vec3(0); spec_pow = 0; }
-					else if (hit_sphere_index == 1) { ka = vec3(0, 0.2, 0); kd = vec3(0, 0.5, 0); ks = vec3(0.5); spec_pow = 32; }
-					else if (hit_sphere_index == 2) { ka = vec3(0, 0, 0.2); kd = vec3(0, 0, 1); ks = vec3(0); spec_pow = 0; }
-					else { ka = vec3(0.2); kd = vec3(1); ks = vec3(0); spec_pow = 0; }
-
-					// --- Phong shading  ---
-					color += ka * light_color;
-					if (!in_shadow) {
-						float diff = max(dot(normal, to_light), 0.0f);
-						float spec = pow(max(dot(reflect_dir, to_camera), 0.0f), spec_pow);
-						color += kd * light_color * diff;
-						color += ks * light_color * spec;
-					}
-				}
+				// ̹   ġ  
+				vec3 ray_dir;
+				camera_ray_dir(camera, i + ru, j + rv, &ray_dir[0]);
 
 				// ---   ջ ---
-				color_sum += clamp(color, 0.0f, 1.0f);
+				color_sum += clamp(trace(eye, ray_dir), 0.0f, 1.0f);
 			}
 
 			// ---     ---
@@ -152,14 +499,626 @@ void render()
 			final_color = clamp(final_color, 0.0f, 1.0f);
 
 			// --- ȼ   ---
-			OutputImage.push_back(final_color.r);
-			OutputImage.push_back(final_color.g);
-			OutputImage.push_back(final_color.b);
+			fb.set(i, j, final_color.r, final_color.g, final_color.b);
+		}
+	}
+}
+
+void render()
+{
+	memset(&gRayStats, 0, sizeof(gRayStats));
+	auto t0 = std::chrono::high_resolution_clock::now();
+
+	int N = 64;
+	render_whitted(OutputImage, Width, Height, N);
+
+	print_ray_stats(N, elapsed_ms(t0));
+}
+
+// -------------------------------------------------
+//  Ʈ (-stream): ȼ  켱 ϴ  ĸ (wave) 
+//   1.  kStreamBatch  1   Ѳ Ų (ʹ render()   rand() )
+//   2.   ׸   ( 8и,  Morton ڵ)    
+//   3. ̵ϰ ݻ/        ĸ
+//         ޾  BVH  ﰢ Ƿ ĳð  鸰.
+//   2    render()   .   ȿ ⿩ ϴ 
+//   Russian roulette   ޶   ٸ.
+// -------------------------------------------------
+const int kStreamBatch = 16384;
+
+struct StreamRay {
+	RayTask task;
+	uint32_t sample;	// ġ   ȣ (׸   ȣ *   + )
+};
+
+struct StreamStats {
+	double sortMs;
+	uint64_t sorted;
+};
+StreamStats gStreamStats;
+
+// Ű:  8и  3 Ʈ,   bounding box ȿ  9 Ʈ ȭ Morton ڵ带
+// Ʒ 27 Ʈ (30 Ʈ    )
+void sort_stream(std::vector<StreamRay>& rays, std::vector<StreamRay>& scratch)
+{
+	auto t0 = std::chrono::high_resolution_clock::now();
+	vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+	for (const StreamRay& r : rays) {
+		lo = min(lo, r.task.origin);
+		hi = max(hi, r.task.origin);
+	}
+	vec3 extent = hi - lo;
+	vec3 scale(extent.x > 0.0f ? 511.0f / extent.x : 0.0f, extent.y > 0.0f ? 511.0f / extent.y : 0.0f,
+		extent.z > 0.0f ? 511.0f / extent.z : 0.0f);
+
+	std::vector<uint64_t> keys(rays.size());
+	std::vector<uint32_t> order(rays.size());
+	for (size_t k = 0; k < rays.size(); ++k) {
+		const RayTask& t = rays[k].task;
+		uint32_t octant = (t.dir.x < 0.0f ? 4u : 0u) | (t.dir.y < 0.0f ? 2u : 0u) | (t.dir.z < 0.0f ? 1u : 0u);
+		uvec3 q = uvec3(min((t.origin - lo) * scale, vec3(511.0f)));
+		keys[k] = (uint64_t)octant << 27 | morton_code30(q.x, q.y, q.z);
+		order[k] = (uint32_t)k;
+	}
+	radix_sort_by_key(keys, order, 30, 1);
+	scratch.resize(rays.size());
+	for (size_t k = 0; k < rays.size(); ++k)
+		scratch[k] = rays[order[k]];
+	rays.swap(scratch);
+	gStreamStats.sortMs += elapsed_ms(t0);
+	gStreamStats.sorted += rays.size();
+}
+
+void render_stream(bool sortRays)
+{
+	OutputImage.resize(Width, Height);
+	memset(&gRayStats, 0, sizeof(gRayStats));
+	memset(&gStreamStats, 0, sizeof(gStreamStats));
+	auto t0 = std::chrono::high_resolution_clock::now();
+
+	Camera camera;
+	camera_setup(camera, gScene.camera, Width, Height);
+	vec3 eye = to_vec3(camera.eye);
+
+	int N = 64;
+	size_t lights = gScene.lights.size();
+	size_t total = (size_t)Width * Height * N;
+	std::vector<vec3> pixelSum((size_t)Width * Height, vec3(0.0f));
+	std::vector<vec3> sampleColor(kStreamBatch);
+	std::vector<StreamRay> rays, next, shadows, scratch;
+	std::vector<vec3> hitPoint, hitNormal;
+	std::vector<uint32_t> hitMaterial;
+	std::vector<uint8_t> hitState, visible;		// hitState: 0 , 1 ٱ , 2  
+
+	for (size_t first = 0; first < total; first += kStreamBatch) {
+		uint32_t count = (uint32_t)min(total - first, (size_t)kStreamBatch);
+
+		// --- 1  (ȭ  ̹  ִ) ---
+		rays.clear();
+		for (uint32_t k = 0; k < count; ++k) {
+			size_t pixel = (first + k) / N;
+			int i = (int)(pixel % Width), j = (int)(pixel / Width);
+			float ru = static_cast<float>(rand()) / RAND_MAX;
+			float rv = static_cast<float>(rand()) / RAND_MAX;
+			vec3 dir;
+			camera_ray_dir(camera, i + ru, j + rv, &dir[0]);
+			rays.push_back({ { eye, dir, vec3(1.0f), 0 }, k });
+			sampleColor[k] = vec3(0.0f);
+		}
+
+		while (!rays.empty()) {
+			if (sortRays && rays[0].task.depth > 0)
+				sort_stream(rays, scratch);
+			gRayStats.rays[rays[0].task.depth] += rays.size();
+
+			// ---  ---
+			size_t n = rays.size();
+			hitPoint.resize(n);
+			hitNormal.resize(n);
+			hitMaterial.resize(n);
+			hitState.assign(n, 0);
+			for (size_t k = 0; k < n; ++k) {
+				const RayTask& ray = rays[k].task;
+				if (!intersect(ray.origin, ray.dir, hitPoint[k], hitNormal[k], hitMaterial[k]))
+					continue;
+				bool inside = dot(hitNormal[k], ray.dir) > 0.0f;
+				if (inside)
+					hitNormal[k] = -hitNormal[k];
+				hitState[k] = inside ? 2 : 1;
+			}
+
+			// --- ׸ : ٱ 鿡   x  ---
+			shadows.clear();
+			for (size_t k = 0; k < n; ++k) {
+				if (hitState[k] != 1)
+					continue;
+				vec3 shadow_origin = hitPoint[k] + 0.001f * hitNormal[k];
+				for (size_t li = 0; li < lights; ++li) {
+					vec3 to_light = normalize(to_vec3(gScene.lights[li].position) - hitPoint[k]);
+					shadows.push_back({ { shadow_origin, to_light, vec3(0.0f), 0 }, (uint32_t)(k * lights + li) });
+				}
+			}
+			if (sortRays)
+				sort_stream(shadows, scratch);
+			gRayStats.shadowRays += shadows.size();
+			visible.assign(n * lights, 0);
+			for (const StreamRay& sr : shadows)
+				visible[sr.sample] = !occluded(sr.task.origin, sr.task.dir);
+
+			// --- ̵  ĸ ---
+			next.clear();
+			for (size_t k = 0; k < n; ++k) {
+				if (hitState[k] == 0)
+					continue;
+				const StreamRay& ray = rays[k];
+				if (hitState[k] == 1)
+					sampleColor[ray.sample] += ray.task.weight
+						* clamp(shade_phong(hitPoint[k], hitNormal[k], ray.task.dir, hitMaterial[k],
+							lights ? visible.data() + k * lights : nullptr), 0.0f, 1.0f);
+				RayTask children[2];
+				int spawned = spawn_secondary(ray.task, hitPoint[k], hitNormal[k], hitState[k] == 2, hitMaterial[k], children,
+					gRouletteState, gRayStats);
+				for (int c = 0; c < spawned; ++c)
+					next.push_back({ children[c], ray.sample });
+			}
+			rays.swap(next);
+		}
+
+		for (uint32_t k = 0; k < count; ++k)
+			pixelSum[(first + k) / N] += clamp(sampleColor[k], 0.0f, 1.0f);
+	}
+
+	// ---     ---
+	for (size_t p = 0; p < pixelSum.size(); ++p) {
+		vec3 final_color = pixelSum[p] / float(N);
+		float gamma = 2.2f;
+		final_color = pow(final_color, vec3(1.0f / gamma));
+		final_color = clamp(final_color, 0.0f, 1.0f);
+		OutputImage.set((int)(p % Width), (int)(p / Width), final_color.r, final_color.g, final_color.b);
+	}
+
+	double ms = elapsed_ms(t0);
+	print_ray_stats(N, ms);
+	printf("  stream  : %s, %.1f ms sorting %.2f M rays (%.1f%% of the frame)\n", sortRays ? "sorted" : "unsorted",
+		gStreamStats.sortMs, gStreamStats.sorted / 1e6, 100.0 * gStreamStats.sortMs / ms);
+}
+
+// -------------------------------------------------
+// ĸ (wavefront)  (-wavefront). render()     /  / ׸ / ̵  
+//  ϴ megakernel ̴. ⼭ ܰ踦  ܰ踶 ť ü   óѴ
+//   1.     : ȼ  1 . ʹ  ȣ õ    ϴ
+//   2.     :  (BVH    ť ü  SoA ), ״  ޽
+//   3. ׸  : ٱ 鿡   x  ׸  ť   ˻ ( 2   )
+//   4. ̵  : Phong, ݻ/   ĸ ť . ť   2  ݺ
+// ť к 迭 (SoA) ̰,  ĸ ť  L2 (kWavefrontL2Bytes)    ũ⸦ Ѵ.
+// ۾ 帶 ڱ ť  ȼ   īͷ Ƿ (L2  ھ )
+//  ܰ谡   ŭ ķ .  ȼ     ϰ .
+// render() ʹ  / roulette  ޶ ȼ   ٸ (-wavefront-bench  RMSE  )
+// -------------------------------------------------
+const size_t kWavefrontL2Bytes = 1 << 20;	// ھ L2 ( ũ 1 ~ 2 MB)
+
+//  ϳ ť ϴ Ʈ (L2    ũ )
+const size_t kRayQueueBytes = 9 * sizeof(float) + 2 * sizeof(uint32_t) + 1;
+const size_t kHitQueueBytes = 7 * sizeof(float) + 2 * sizeof(uint32_t) + 1;
+const size_t kShadowQueueBytes = 6 * sizeof(float) + sizeof(uint32_t) + 2;
+
+enum WavefrontStage { STAGE_GENERATE, STAGE_INTERSECT, STAGE_SHADOW, STAGE_SHADE, STAGE_COUNT };
+
+struct RayQueue {
+	std::vector<float> ox, oy, oz, dx, dy, dz;
+	std::vector<float> wr, wg, wb;			// weight
+	std::vector<uint32_t> sample;			//    ȣ
+	std::vector<uint32_t> rng;				// roulette  
+	std::vector<uint8_t> depth;
+
+	size_t size() const { return ox.size(); }
+
+	void clear()
+	{
+		for (std::vector<float>* v : { &ox, &oy, &oz, &dx, &dy, &dz, &wr, &wg, &wb })
+			v->clear();
+		sample.clear();
+		rng.clear();
+		depth.clear();
+	}
+
+	void resize(size_t n)
+	{
+		for (std::vector<float>* v : { &ox, &oy, &oz, &dx, &dy, &dz, &wr, &wg, &wb })
+			v->resize(n);
+		sample.resize(n);
+		rng.resize(n);
+		depth.resize(n);
+	}
+
+	void push(const RayTask& ray, uint32_t s, uint32_t state)
+	{
+		ox.push_back(ray.origin.x); oy.push_back(ray.origin.y); oz.push_back(ray.origin.z);
+		dx.push_back(ray.dir.x); dy.push_back(ray.dir.y); dz.push_back(ray.dir.z);
+		wr.push_back(ray.weight.r); wg.push_back(ray.weight.g); wb.push_back(ray.weight.b);
+		sample.push_back(s);
+		rng.push_back(state);
+		depth.push_back((uint8_t)ray.depth);
+	}
+
+	vec3 origin(size_t k) const { return vec3(ox[k], oy[k], oz[k]); }
+	vec3 dir(size_t k) const { return vec3(dx[k], dy[k], dz[k]); }
+	RayTask task(size_t k) const { return { origin(k), dir(k), vec3(wr[k], wg[k], wb[k]), depth[k] }; }
+};
+
+struct HitQueue {
+	std::vector<float> t;
+	std::vector<int32_t> sphere;			//    ( -1)
+	std::vector<float> px, py, pz, nx, ny, nz;	//     ִ
+	std::vector<uint32_t> material;
+	std::vector<uint8_t> state;				// 0 , 1 ٱ , 2  
+
+	void reset(size_t n)
+	{
+		t.assign(n, std::numeric_limits<float>::infinity());
+		sphere.assign(n, -1);
+		for (std::vector<float>* v : { &px, &py, &pz, &nx, &ny, &nz })
+			v->resize(n);
+		material.resize(n);
+		state.assign(n, 0);
+	}
+
+	vec3 point(size_t k) const { return vec3(px[k], py[k], pz[k]); }
+	vec3 normal(size_t k) const { return vec3(nx[k], ny[k], nz[k]); }
+};
+
+struct ShadowQueue {
+	std::vector<float> ox, oy, oz, dx, dy, dz;
+	std::vector<uint32_t> owner;			//  ȣ *   + 
+	std::vector<uint8_t> blocked;
+
+	size_t size() const { return ox.size(); }
+
+	void clear()
+	{
+		for (std::vector<float>* v : { &ox, &oy, &oz, &dx, &dy, &dz })
+			v->clear();
+		owner.clear();
+	}
+};
+
+// ۾  ϳ ť 
+struct WavefrontWorker {
+	RayQueue rays, next;
+	HitQueue hits;
+	ShadowQueue shadows;
+	std::vector<uint8_t> visible;			//  k,  l -> k *   + l
+	std::vector<vec3> sampleColor;
+	RayStats stats;
+	double stageMs[STAGE_COUNT];
+};
+
+//  ĸ ť ( /  , ,  ׸ ,  )  L2   1  
+size_t wavefront_batch_rays(size_t lights)
+{
+	size_t bytesPerRay = 2 * kRayQueueBytes + kHitQueueBytes + lights * kShadowQueueBytes + sizeof(vec3);
+	return max(kWavefrontL2Bytes / bytesPerRay, (size_t)1);
+}
+
+//  ؽ (lowbias32).  ȣ ->  õ
+uint32_t hash_u32(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x | 1u;		// xorshift ´ 0 ̸  ȴ
+}
+
+// --- 1. : ȼ [firstPixel, firstPixel + pixels)  samples  ---
+void wavefront_generate(RayQueue& rays, size_t firstPixel, size_t pixels, int samples)
+{
+	Camera camera;
+	camera_setup(camera, gScene.camera, Width, Height);
+	vec3 eye = to_vec3(camera.eye);
+
+	rays.resize(pixels * samples);
+	for (size_t p = 0; p < pixels; ++p) {
+		size_t pixel = firstPixel + p;
+		int i = (int)(pixel % Width), j = (int)(pixel / Width);
+		for (int n = 0; n < samples; ++n) {
+			size_t k = p * samples + n;
+			uint32_t state = hash_u32((uint32_t)(pixel * samples + n));
+			float ru = roulette_random(state);
+			float rv = roulette_random(state);
+			vec3 dir;
+			camera_ray_dir(camera, i + ru, j + rv, &dir[0]);
+			rays.ox[k] = eye.x; rays.oy[k] = eye.y; rays.oz[k] = eye.z;
+			rays.dx[k] = dir.x; rays.dy[k] = dir.y; rays.dz[k] = dir.z;
+			rays.wr[k] = rays.wg[k] = rays.wb[k] = 1.0f;
+			rays.sample[k] = (uint32_t)k;
+			rays.rng[k] = state;
+			rays.depth[k] = 0;
 		}
 	}
 }
 
-void resize_callback(GLFWwindow*, int nw, int nh)
+// --- 2.  ---
+void wavefront_intersect(const RayQueue& rays, HitQueue& hits)
+{
+	const SceneSpheres& spheres = gScene.spheres;
+	size_t n = rays.size();
+	hits.reset(n);
+
+	if (gSphereBvh.nodes.empty()) {
+		//  ť ü ȴ´.    SoA  Ϸ ȭѴ.
+		// İ   hit_sphere   ( Ʈ  )
+		for (size_t s = 0; s < spheres.size(); ++s) {
+			float cx = spheres.cx[s], cy = spheres.cy[s], cz = spheres.cz[s];
+			float r2 = spheres.radius[s] * spheres.radius[s];
+			float* tBest = hits.t.data();
+			int32_t* sBest = hits.sphere.data();
+			for (size_t k = 0; k < n; ++k) {
+				float dx = rays.dx[k], dy = rays.dy[k], dz = rays.dz[k];
+				float ocx = rays.ox[k] - cx, ocy = rays.oy[k] - cy, ocz = rays.oz[k] - cz;
+				float a = dx * dx + dy * dy + dz * dz;
+				float b = 2.0f * (ocx * dx + ocy * dy + ocz * dz);
+				float c = (ocx * ocx + ocy * ocy + ocz * ocz) - r2;
+				float discriminant = b * b - 4 * a * c;
+				float root = std::sqrt(max(discriminant, 0.0f));
+				float t = (-b - root) / (2.0f * a);
+				t = t <= 0.001f ? (-b + root) / (2.0f * a) : t;
+				bool hit = discriminant > 0.0f && t > 0.001f && t < tBest[k];
+				tBest[k] = hit ? t : tBest[k];
+				sBest[k] = hit ? (int32_t)s : sBest[k];
+			}
+		}
+	}
+	else {
+		for (size_t k = 0; k < n; ++k)
+			hits.sphere[k] = closest_sphere(rays.origin(k), rays.dir(k), hits.t[k]);
+	}
+
+	//  ޽  (intersect   )
+	for (size_t k = 0; k < n; ++k) {
+		vec3 origin = rays.origin(k), dir = rays.dir(k);
+		float closest_t = hits.t[k];
+		vec3 hit_point, normal;
+		uint32_t m = 0;
+		if (hits.sphere[k] >= 0)
+			sphere_hit(hits.sphere[k], origin, dir, closest_t, hit_point, normal, m);
+		intersect_planes_meshes(origin, dir, closest_t, hit_point, normal, m);
+		if (closest_t == std::numeric_limits<float>::infinity())
+			continue;
+		bool inside = dot(normal, dir) > 0.0f;
+		if (inside)
+			normal = -normal;
+		hits.t[k] = closest_t;
+		hits.px[k] = hit_point.x; hits.py[k] = hit_point.y; hits.pz[k] = hit_point.z;
+		hits.nx[k] = normal.x; hits.ny[k] = normal.y; hits.nz[k] = normal.z;
+		hits.material[k] = m;
+		hits.state[k] = inside ? 2 : 1;
+	}
+}
+
+// --- 3. ׸: visible[k *   + l] ---
+void wavefront_shadow(const HitQueue& hits, ShadowQueue& shadows, std::vector<uint8_t>& visible, RayStats& stats)
+{
+	const SceneSpheres& spheres = gScene.spheres;
+	size_t lights = gScene.lights.size();
+	size_t n = hits.state.size();
+
+	shadows.clear();
+	for (size_t k = 0; k < n; ++k) {
+		if (hits.state[k] != 1)
+			continue;
+		vec3 hit_point = hits.point(k);
+		vec3 shadow_origin = hit_point + 0.001f * hits.normal(k);
+		for (size_t l = 0; l < lights; ++l) {
+			vec3 to_light = normalize(to_vec3(gScene.lights[l].position) - hit_point);
+			shadows.ox.push_back(shadow_origin.x); shadows.oy.push_back(shadow_origin.y); shadows.oz.push_back(shadow_origin.z);
+			shadows.dx.push_back(to_light.x); shadows.dy.push_back(to_light.y); shadows.dz.push_back(to_light.z);
+			shadows.owner.push_back((uint32_t)(k * lights + l));
+		}
+	}
+	size_t count = shadows.size();
+	stats.shadowRays += count;
+	shadows.blocked.assign(count, 0);
+
+	if (gSphereBvh.nodes.empty()) {
+		//  ܰ  SoA  ( ٸ, occluded   )
+		for (size_t s = 0; s < spheres.size(); ++s) {
+			float cx = spheres.cx[s], cy = spheres.cy[s], cz = spheres.cz[s];
+			float r2 = spheres.radius[s] * spheres.radius[s];
+			uint8_t* blocked = shadows.blocked.data();
+			for (size_t k = 0; k < count; ++k) {
+				float dx = shadows.dx[k], dy = shadows.dy[k], dz = shadows.dz[k];
+				float ocx = shadows.ox[k] - cx, ocy = shadows.oy[k] - cy, ocz = shadows.oz[k] - cz;
+				float a = dx * dx + dy * dy + dz * dz;
+				float b = 2.0f * (ocx * dx + ocy * dy + ocz * dz);
+				float c = (ocx * ocx + ocy * ocy + ocz * ocz) - r2;
+				float discriminant = b * b - 4 * a * c;
+				float t = (-b - std::sqrt(max(discriminant, 0.0f))) / (2.0f * a);
+				blocked[k] |= (uint8_t)(discriminant > 0.0f && t > 0.001f);
+			}
+		}
+	}
+	else {
+		for (size_t k = 0; k < count; ++k)
+			shadows.blocked[k] = occluded_spheres(vec3(shadows.ox[k], shadows.oy[k], shadows.oz[k]),
+				vec3(shadows.dx[k], shadows.dy[k], shadows.dz[k]));
+	}
+
+	visible.assign(n * lights, 0);
+	for (size_t k = 0; k < count; ++k) {
+		if (shadows.blocked[k])
+			continue;
+		if (!gMeshes.empty() && occluded_meshes(vec3(shadows.ox[k], shadows.oy[k], shadows.oz[k]),
+			vec3(shadows.dx[k], shadows.dy[k], shadows.dz[k])))
+			continue;
+		visible[shadows.owner[k]] = 1;
+	}
+}
+
+// --- 4. ̵  ĸ ---
+void wavefront_shade(const RayQueue& rays, const HitQueue& hits, const std::vector<uint8_t>& visible,
+	std::vector<vec3>& sampleColor, RayQueue& next, RayStats& stats)
+{
+	size_t lights = gScene.lights.size();
+	next.clear();
+	for (size_t k = 0; k < rays.size(); ++k) {
+		if (hits.state[k] == 0)
+			continue;
+		RayTask ray = rays.task(k);
+		vec3 hit_point = hits.point(k), normal = hits.normal(k);
+		uint32_t m = hits.material[k];
+		if (hits.state[k] == 1)
+			sampleColor[rays.sample[k]] += ray.weight
+				* clamp(shade_phong(hit_point, normal, ray.dir, m, lights ? visible.data() + k * lights : nullptr), 0.0f, 1.0f);
+
+		RayTask children[2];
+		uint32_t state = rays.rng[k];
+		int spawned = spawn_secondary(ray, hit_point, normal, hits.state[k] == 2, m, children, state, stats);
+		//      ʵ ٽ ´
+		for (int c = 0; c < spawned; ++c)
+			next.push(children[c], rays.sample[k], hash_u32(state + c));
+	}
+}
+
+// threads: 0 ̸ hardware_concurrency
+void render_wavefront(int threads)
+{
+	auto t0 = std::chrono::high_resolution_clock::now();
+	int N = 64;
+	size_t pixels = (size_t)Width * Height;
+	size_t batchPixels = max(wavefront_batch_rays(gScene.lights.size()) / N, (size_t)1);
+	OutputImage.resize(Width, Height);
+
+	int count = threads > 0 ? threads : max((int)std::thread::hardware_concurrency(), 1);
+	std::vector<WavefrontWorker> workers(count);
+	std::atomic<size_t> nextBatch(0);
+
+	auto worker = [&](WavefrontWorker& wf) {
+		memset(&wf.stats, 0, sizeof(wf.stats));
+		memset(wf.stageMs, 0, sizeof(wf.stageMs));
+		auto stage = [&](WavefrontStage which, std::chrono::high_resolution_clock::time_point& t) {
+			auto now = std::chrono::high_resolution_clock::now();
+			wf.stageMs[which] += std::chrono::duration<double, std::milli>(now - t).count();
+			t = now;
+		};
+		for (size_t batch; (batch = nextBatch++) * batchPixels < pixels;) {
+			size_t firstPixel = batch * batchPixels;
+			size_t batchCount = min(batchPixels, pixels - firstPixel);
+			auto t = std::chrono::high_resolution_clock::now();
+			wavefront_generate(wf.rays, firstPixel, batchCount, N);
+			wf.sampleColor.assign(batchCount * N, vec3(0.0f));
+			stage(STAGE_GENERATE, t);
+
+			while (wf.rays.size() > 0) {
+				wf.stats.rays[wf.rays.depth[0]] += wf.rays.size();
+				wavefront_intersect(wf.rays, wf.hits);
+				stage(STAGE_INTERSECT, t);
+				wavefront_shadow(wf.hits, wf.shadows, wf.visible, wf.stats);
+				stage(STAGE_SHADOW, t);
+				wavefront_shade(wf.rays, wf.hits, wf.visible, wf.sampleColor, wf.next, wf.stats);
+				std::swap(wf.rays, wf.next);
+				stage(STAGE_SHADE, t);
+			}
+
+			// ---     (  Ѵ) ---
+			for (size_t p = 0; p < batchCount; ++p) {
+				vec3 pixel_color(0.0f);
+				for (int n = 0; n < N; ++n)
+					pixel_color += clamp(wf.sampleColor[p * N + n], 0.0f, 1.0f);
+				vec3 final_color = pixel_color / float(N);
+				float gamma = 2.2f;
+				final_color = pow(final_color, vec3(1.0f / gamma));
+				final_color = clamp(final_color, 0.0f, 1.0f);
+				size_t pixel = firstPixel + p;
+				OutputImage.set((int)(pixel % Width), (int)(pixel / Width), final_color.r, final_color.g, final_color.b);
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int k = 1; k < count; ++k)
+		pool.emplace_back(worker, std::ref(workers[k]));
+	worker(workers[0]);
+	for (std::thread& t : pool)
+		t.join();
+
+	// ۾  ġ (ܰ ð  ð )
+	memset(&gRayStats, 0, sizeof(gRayStats));
+	double stageMs[STAGE_COUNT] = {};
+	for (const WavefrontWorker& wf : workers) {
+		for (int d = 0; d <= kMaxDepth; ++d)
+			gRayStats.rays[d] += wf.stats.rays[d];
+		gRayStats.shadowRays += wf.stats.shadowRays;
+		gRayStats.roulette += wf.stats.roulette;
+		for (int s = 0; s < STAGE_COUNT; ++s)
+			stageMs[s] += wf.stageMs[s];
+	}
+	print_ray_stats(N, elapsed_ms(t0));
+	double stageTotal = stageMs[STAGE_GENERATE] + stageMs[STAGE_INTERSECT] + stageMs[STAGE_SHADOW] + stageMs[STAGE_SHADE];
+	printf("  wavefront: %d threads, %d primary rays/wave (%d KB L2), generate %.0f%% intersect %.0f%% shadow %.0f%% shade %.0f%%\n",
+		count, (int)(batchPixels * N), (int)(kWavefrontL2Bytes / 1024), 100.0 * stageMs[STAGE_GENERATE] / stageTotal,
+		100.0 * stageMs[STAGE_INTERSECT] / stageTotal, 100.0 * stageMs[STAGE_SHADOW] / stageTotal, 100.0 * stageMs[STAGE_SHADE] / stageTotal);
+}
+
+// -------------------------------------------------
+// â ũ 
+//     ũ⸶ ü  ϸ â  о . ׷ ݹ鿡
+//   - 1/kResizePreviewScale ػ, ȼ 1  ̸⸸ ׸ (kResizePreviewMs 
+//      ̸⿡ ɸ ð   ʿ  .  ð  ̻ ̸⿡  ʴ´)
+//   -  ̿   (̸ Ǵ  ũ ü )  â ũ ÷ ش
+//   - ũⰡ kResizeSettleMs  ״θ   ü ǰ ٽ ׸
+//   Windows      ߰ ݹ鸸 ҸǷ ݹ ȿ  ׸ ۸ ٲ۴.
+//    ݹ ð (  ), ̸ ð,  ̺Ʈ ü   Ѵ
+//      ̶  
+// -------------------------------------------------
+const int    kResizePreviewScale = 4;
+const double kResizePreviewMs = 30.0;
+const double kResizeSettleMs = 250.0;
+
+struct ResizeState {
+	bool   pending = false;             // ü ǰ ٽ ׷ Ѵ
+	std::chrono::high_resolution_clock::time_point firstEvent, lastEvent, lastPreview;
+	int    events = 0, previews = 0;
+	double callbackMs = 0.0, callbackMaxMs = 0.0, previewMs = 0.0;
+	double lastPreviewMs = 0.0;         //  ̸⿡ ɸ ð
+};
+ResizeState gResize;
+
+//   ü ǰ 
+void render_full()
+{
+	if (gStreamMode)
+		render_stream(true);
+	else if (gWavefrontMode)
+		render_wavefront(0);
+	else
+		render();
+}
+
+// ũⰡ kResizeSettleMs  ״ο ü ǰ ٽ ׸  Ѵ
+void render_if_resize_settled()
+{
+	if (!gResize.pending || elapsed_ms(gResize.lastEvent) < kResizeSettleMs)
+		return;
+	double waitMs = elapsed_ms(gResize.lastEvent);
+	auto t0 = std::chrono::high_resolution_clock::now();
+	render_full();
+	double renderMs = elapsed_ms(t0);
+	display_mark_dirty(Display);
+	gResize.pending = false;
+
+	printf("[Resize] %d events over %.0f ms, callback %.2f ms avg / %.2f ms max, %d previews (1/%d res, 1 spp, %.2f ms avg)\n",
+		gResize.events, std::chrono::duration<double, std::milli>(gResize.lastEvent - gResize.firstEvent).count(),
+		gResize.callbackMs / gResize.events, gResize.callbackMaxMs, gResize.previews, kResizePreviewScale,
+		gResize.previews ? gResize.previewMs / gResize.previews : 0.0);
+	printf("[Resize] full %dx%d image %.0f ms after the last event (%.0f ms settle + %.0f ms render)\n",
+		Width, Height, waitMs + renderMs, waitMs, renderMs);
+	gResize.events = gResize.previews = 0;
+	gResize.callbackMs = gResize.callbackMaxMs = gResize.previewMs = 0.0;
+}
+
+void resize_callback(GLFWwindow* window, int nw, int nh)
 {
 	//This is called in response to the window resizing.
 	//The new width and height are passed in so we make 
@@ -178,15 +1137,800 @@ void resize_callback(GLFWwindow*, int nw, int nh)
 		, 0.0, static_cast<double>(Height)
 		, 1.0, -1.0);
 
-	//Reserve memory for our render so that we don't do 
-	//excessive allocations and render the image
-	OutputImage.reserve(Width * Height * 3);
+	if (gPathMode) {
+		//Resize our render target (it only reallocates when the window grows)
+		OutputImage.resize(Width, Height);
+		path_tracer_reset(gPath, Width, Height);
+		OutputImage.fill(0.0f, 0.0f, 0.0f);
+		display_mark_dirty(Display);
+		return;
+	}
+	//The first call comes from main before the window is shown: render at full quality
+	if (!window) {
+		render_full();
+		display_mark_dirty(Display);
+		return;
+	}
+
+	auto t0 = std::chrono::high_resolution_clock::now();
+	if (!gResize.pending) {
+		gResize.pending = true;
+		gResize.firstEvent = t0;
+		gResize.lastPreview = t0 - std::chrono::hours(1);
+	}
+	gResize.lastEvent = t0;
+	gResize.events++;
+
+	// ̸ (ʹ   ǳʶٰ   ÷ ش)
+	if (elapsed_ms(gResize.lastPreview) >= max(kResizePreviewMs, gResize.lastPreviewMs) && Width > 0 && Height > 0) {
+		render_whitted(OutputImage, max(Width / kResizePreviewScale, 1), max(Height / kResizePreviewScale, 1), 1);
+		gResize.lastPreview = std::chrono::high_resolution_clock::now();
+		gResize.lastPreviewMs = elapsed_ms(t0);
+		gResize.previewMs += gResize.lastPreviewMs;
+		gResize.previews++;
+		display_mark_dirty(Display);
+	}
+	glClear(GL_COLOR_BUFFER_BIT);
+	display_draw(Display, OutputImage, Width, Height);
+	glfwSwapBuffers(window);
+
+	double ms = elapsed_ms(t0);
+	gResize.callbackMs += ms;
+	gResize.callbackMaxMs = max(gResize.callbackMaxMs, ms);
+}
+
+// -------------------------------------------------
+//     (â )
+//   -path-ref  : spp н     (PFM)  
+//   -path-conv : н ϸ鼭 spp  2  ŵ    RMSE .
+//                RMSE * sqrt(ð)  ϸ 1/sqrt(N)  ϰ ִٴ 
+// -------------------------------------------------
+void print_path_progress(const PathTracer& pt, double rmse)
+{
+	printf("[Path] %5d spp %9.0f ms %7.2f M samples/s", pt.passes, pt.renderMs,
+		path_tracer_samples_per_sec(pt) / 1e6);
+	if (rmse >= 0.0)
+		printf("  RMSE %.5f  RMSE*sqrt(s) %.5f", rmse, rmse * std::sqrt(pt.renderMs / 1000.0));
+	printf("\n");
+}
+
+int path_reference(int spp, const char* outFile)
+{
+	path_tracer_init(gPath, gScene, Width, Height);
+	for (int k = 0; k < spp; ++k) {
+		path_tracer_pass(gPath);
+		if ((gPath.passes & (gPath.passes - 1)) == 0 || gPath.passes == spp)
+			print_path_progress(gPath, -1.0);
+	}
+	Framebuffer mean;
+	mean.resize(Width, Height, FB_RGB32F);
+	path_tracer_mean(gPath, mean);
+	return write_pfm(outFile, mean) ? 0 : 1;
+}
+
+int path_convergence(int spp, const char* referenceFile)
+{
+	int w, h;
+	std::vector<float> reference;
+	if (!read_pfm(referenceFile, w, h, reference))
+		return 1;
+	if (w != Width || h != Height) {
+		printf("ERROR: %s is %dx%d, expected %dx%d\n", referenceFile, w, h, Width, Height);
+		return 1;
+	}
+	path_tracer_init(gPath, gScene, Width, Height);
+	for (int k = 0; k < spp; ++k) {
+		path_tracer_pass(gPath);
+		if ((gPath.passes & (gPath.passes - 1)) == 0 || gPath.passes == spp)
+			print_path_progress(gPath, path_tracer_rmse(gPath, reference));
+	}
+	return 0;
+}
+
+
+// -------------------------------------------------
+// "-bench N":  N   JSON / ̳ʸ  д ð 
+// -------------------------------------------------
+double file_mb(const char* filename)
+{
+	struct stat st;
+	return stat(filename, &st) == 0 ? st.st_size / (1024.0 * 1024.0) : 0.0;
+}
+
+// ī޶  (x -50..50, y -2..8, z -5..-100)     count 
+void make_random_spheres(SceneSpheres& spheres, int count, size_t materials)
+{
+	spheres = SceneSpheres();
+	srand(1);
+	for (int i = 0; i < count; ++i) {
+		float x = rand() / (float)RAND_MAX * 100.0f - 50.0f;
+		float y = rand() / (float)RAND_MAX * 10.0f - 2.0f;
+		float z = -5.0f - rand() / (float)RAND_MAX * 95.0f;
+		float r = 0.05f + rand() / (float)RAND_MAX * 0.5f;
+		spheres.add(x, y, z, r, (uint32_t)(rand() % materials));
+	}
+}
+
+void benchmark_scene_io(int count)
+{
+	SceneData scene;
+	make_hw2_scene(scene);
+	make_random_spheres(scene.spheres, count, scene.materials.size());
+
+	const char* files[2] = { "bench_scene.json", "bench_scene.bin" };
+	for (int f = 0; f < 2; ++f) {
+		auto t0 = std::chrono::high_resolution_clock::now();
+		bool ok = f == 0 ? save_scene_json(files[f], scene) : save_scene_binary(files[f], scene);
+		double writeMs = elapsed_ms(t0);
+		if (!ok)
+			continue;
+
+		// б       (ù °  ĳð    ִ)
+		double readMs = 1e30;
+		SceneData loaded;
+		for (int k = 0; k < 3; ++k) {
+			t0 = std::chrono::high_resolution_clock::now();
+			ok = load_scene(files[f], loaded);
+			readMs = min(readMs, elapsed_ms(t0));
+		}
+		printf("%-6s %d spheres, %.1f MB: write %.1f ms, read %.1f ms (%.2f M objects/s)%s\n",
+			f == 0 ? "JSON" : "binary", count, file_mb(files[f]), writeMs, readMs,
+			count / (readMs * 1000.0), ok && loaded.spheres.size() == (size_t)count ? "" : " FAILED");
+	}
+}
+
+// -------------------------------------------------
+// "-bvh-bench [ﰢ ]":  BVH  4-wide ȭ BVH 
+//     (⺻ 䳢 ũ 7 )  ī޶  (  ) 
+//   ǥ鿡   ׸  (ƹ )  
+//     /  湮 ,  ũ, ﰢ Ʈ, ʴ   .
+//     Ʈ   ˻ Ѵ (ָ    ޽ )
+// -------------------------------------------------
+void make_bumpy_sphere(TriMesh& mesh, int triangles)
+{
+	int rings = max((int)std::sqrt(triangles / 4.0), 4);
+	int segments = max(triangles / (2 * rings), 4);
+	mesh = TriMesh();
+	for (int i = 0; i <= rings; ++i) {
+		float theta = pi<float>() * i / rings;
+		for (int j = 0; j < segments; ++j) {
+			float phi = 2.0f * pi<float>() * j / segments;
+			float r = 1.0f + 0.05f * std::sin(7.0f * theta) * std::sin(9.0f * phi);
+			vec3 n(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+			vec3 p = r * n;
+			mesh.positions.insert(mesh.positions.end(), { p.x, p.y, p.z });
+			mesh.normals.insert(mesh.normals.end(), { n.x, n.y, n.z });
+		}
+	}
+	for (int i = 0; i < rings; ++i) {
+		for (int j = 0; j < segments; ++j) {
+			uint32_t a = i * segments + j, b = i * segments + (j + 1) % segments;
+			uint32_t c = a + segments, d = b + segments;
+			// ٱ  ݽð . ؿ  ġ ﰢ 
+			if (i > 0)
+				mesh.indices.insert(mesh.indices.end(), { a, b, c });
+			if (i < rings - 1)
+				mesh.indices.insert(mesh.indices.end(), { b, d, c });
+		}
+	}
+}
+
+struct BvhBenchResult {
+	double ms = 0.0;
+	int hits = 0;
+	BvhTraceStats stats;
+};
+
+BvhBenchResult bvh_bench_rays(const MeshBvh& bvh, const std::vector<float>& rays, bool shadow, bool wide)
+{
+	//   ð,   踸 (  ð  ʰ)
+	BvhBenchResult result;
+	size_t count = rays.size() / 7;
+	for (int pass = 0; pass < 2; ++pass) {
+		BvhTraceStats* stats = pass == 0 ? nullptr : &result.stats;
+		auto t0 = std::chrono::high_resolution_clock::now();
+		int hits = 0;
+		for (size_t k = 0; k < count; ++k) {
+			const float* r = &rays[k * 7];
+			MeshHit hit;
+			if (shadow)
+				hits += wide ? occluded_mesh_bvh(bvh, r, r + 3, r[6], stats) : occluded_mesh_bvh2(bvh, r, r + 3, r[6], stats);
+			else
+				hits += wide ? intersect_mesh_bvh(bvh, r, r + 3, r[6], hit, stats) : intersect_mesh_bvh2(bvh, r, r + 3, r[6], hit, stats);
+		}
+		if (pass == 0) {
+			result.ms = elapsed_ms(t0);
+			result.hits = hits;
+		}
+	}
+	return result;
+}
+
+// ī޶ : (0, 0, 3)    side x side  ( origin 3, dir 3, tMax)
+void make_bench_camera_rays(std::vector<float>& rays, int side)
+{
+	rays.clear();
+	for (int y = 0; y < side; ++y)
+		for (int x = 0; x < side; ++x) {
+			vec3 d((x + 0.5f) / side - 0.5f, (y + 0.5f) / side - 0.5f, -1.0f);
+			rays.insert(rays.end(), { 0.0f, 0.0f, 3.0f, d.x, d.y, d.z, 1e30f });
+		}
+}
+
+//  ﰢ ˻ϴ    (Moller-Trumbore, BVH Ȯο)
+bool brute_force_mesh_hit(const TriMesh& mesh, const float origin[3], const float dir[3], float tMax, float& tHit)
+{
+	vec3 o = to_vec3(origin), d = to_vec3(dir);
+	bool found = false;
+	for (size_t t = 0; t < mesh.triangle_count(); ++t) {
+		vec3 v0 = to_vec3(&mesh.positions[mesh.indices[t * 3] * 3]);
+		vec3 e1 = to_vec3(&mesh.positions[mesh.indices[t * 3 + 1] * 3]) - v0;
+		vec3 e2 = to_vec3(&mesh.positions[mesh.indices[t * 3 + 2] * 3]) - v0;
+		vec3 p = cross(d, e2);
+		float det = dot(e1, p);
+		if (det == 0.0f)
+			continue;
+		float inv = 1.0f / det;
+		vec3 s = o - v0;
+		float u = dot(s, p) * inv;
+		if (u < 0.0f || u > 1.0f)
+			continue;
+		vec3 q = cross(s, e1);
+		float v = dot(d, q) * inv;
+		if (v < 0.0f || u + v > 1.0f)
+			continue;
+		float tt = dot(e2, q) * inv;
+		if (tt > 0.0f && tt < tMax) {
+			tMax = tt;
+			found = true;
+		}
+	}
+	tHit = tMax;
+	return found;
+}
+
+// BVH4  BVH2   ˻ :  / ħ ٸų t  ( 1e-4 Ѱ) ٸ  
+void cross_check_mesh_bvh(const char* name, const TriMesh& mesh, const MeshBvh& bvh, const std::vector<float>& rays)
+{
+	int wrong[2] = { 0, 0 };
+	size_t count = rays.size() / 7;
+	for (size_t k = 0; k < count; ++k) {
+		const float* r = &rays[k * 7];
+		float tRef;
+		bool ref = brute_force_mesh_hit(mesh, r, r + 3, r[6], tRef);
+		for (int w = 0; w < 2; ++w) {
+			MeshHit hit;
+			bool got = w == 0 ? intersect_mesh_bvh2(bvh, r, r + 3, r[6], hit) : intersect_mesh_bvh(bvh, r, r + 3, r[6], hit);
+			if (got != ref || (got && std::abs(hit.t - tRef) > 1e-4f * tRef))
+				wrong[w]++;
+		}
+	}
+	printf("check %-22s %6d rays vs brute force: BVH2 %d wrong, BVH4 %d wrong\n", name, (int)count, wrong[0], wrong[1]);
+}
+
+//  ߽ extent ũ  ȿ   ﰢ count  (ٰ wide 尡  )
+void make_triangle_soup(TriMesh& mesh, int count, float extent)
+{
+	mesh = TriMesh();
+	srand(1);
+	auto random = [&]() { return static_cast<float>(rand()) / RAND_MAX - 0.5f; };
+	for (int t = 0; t < count; ++t) {
+		vec3 c(random() * extent, random() * extent, random() * extent);
+		for (int v = 0; v < 3; ++v) {
+			vec3 p = c + 0.05f * extent * vec3(random(), random(), random());
+			mesh.positions.insert(mesh.positions.end(), { p.x, p.y, p.z });
+			mesh.normals.insert(mesh.normals.end(), { 0.0f, 0.0f, 1.0f });
+			mesh.indices.push_back(t * 3 + v);
+		}
+	}
+}
+
+//  ó extent ũ ޽ distance ŭ  밢 ⿡  side x side 
+//   ָ ȭ ڽ 谡  ̿  (tNear == tFar)  ĭ  ó δ
+void make_far_rays(std::vector<float>& rays, int side, float extent, float distance)
+{
+	rays.clear();
+	float k = distance / std::sqrt(3.0f);
+	vec3 o(k, 0.9f * k, 1.1f * k);
+	for (int y = 0; y < side; ++y)
+		for (int x = 0; x < side; ++x) {
+			vec3 target(((x + 0.5f) / side - 0.5f) * extent, ((y + 0.5f) / side - 0.5f) * extent, 0.0f);
+			vec3 d = target - o;
+			rays.insert(rays.end(), { o.x, o.y, o.z, d.x, d.y, d.z, 1e30f });
+		}
+}
+
+void benchmark_bvh(int triangles)
+{
+	TriMesh mesh;
+	make_bumpy_sphere(mesh, triangles);
+	MeshBvh bvh;
+	build_mesh_bvh(bvh, mesh);
+	double tris = (double)mesh.triangle_count();
+	double binaryBytes = (double)mesh_bvh_bytes(bvh);
+	collapse_mesh_bvh4(bvh);
+	printf("%d tris, %s kernel: build %.1f ms, collapse %.1f ms\n", (int)tris, mesh_bvh_kernel_name(), bvh.buildMs, bvh.collapseMs);
+	printf("BVH2 %8d nodes x %2d B, %.1f bytes/tri (nodes + leaf blocks)\n", (int)bvh.nodes.size(), (int)sizeof(BvhNode), binaryBytes / tris);
+	printf("BVH4 %8d nodes x %2d B, %.1f bytes/tri\n", (int)bvh.wide.size(), (int)sizeof(Bvh4Node), mesh_bvh_bytes(bvh) / tris);
+
+	// ׸ :  ǥ (ﰢ ߽ɿ    )   (-4, 4, 3) 
+	const int side = 512;
+	std::vector<float> camera, shadow;
+	make_bench_camera_rays(camera, side);
+	srand(1);
+	vec3 light(-4.0f, 4.0f, 3.0f);
+	for (int k = 0; k < side * side; ++k) {
+		uint32_t t = (uint32_t)(rand() * (RAND_MAX + 1.0) + rand()) % mesh.triangle_count();
+		vec3 p(0.0f);
+		for (int c = 0; c < 3; ++c)
+			p += to_vec3(&mesh.positions[mesh.indices[t * 3 + c] * 3]) / 3.0f;
+		float n[3];
+		mesh_triangle_normal(mesh, t, n);
+		p += 1e-3f * to_vec3(n);
+		vec3 d = light - p;
+		shadow.insert(shadow.end(), { p.x, p.y, p.z, d.x, d.y, d.z, 1.0f });
+	}
+
+	const char* names[2] = { "camera", "shadow" };
+	for (int q = 0; q < 2; ++q) {
+		const std::vector<float>& rays = q == 0 ? camera : shadow;
+		double count = rays.size() / 7.0;
+		for (int w = 0; w < 2; ++w) {
+			BvhBenchResult r = bvh_bench_rays(bvh, rays, q == 1, w == 1);
+			printf("%s %s: %6.2f nodes/ray, %5.2f leaves/ray, %6.2f M rays/s, %d hits\n", w == 0 ? "BVH2" : "BVH4", names[q],
+				r.stats.nodes / count, r.stats.leaves / count, count / (r.ms * 1000.0), r.hits);
+		}
+	}
+
+	//  ˻ :  ޽ (  ٿ), ׸ ָ ִ   ޽
+	make_bench_camera_rays(camera, 64);
+	cross_check_mesh_bvh("camera", mesh, bvh, camera);
+	const float farCases[2][2] = { { 1e-6f, 100.0f }, { 1e-4f, 1e5f } };     // extent, distance
+	for (int f = 0; f < 2; ++f) {
+		TriMesh small;
+		make_triangle_soup(small, 3000, farCases[f][0]);
+		MeshBvh smallBvh;
+		build_mesh_bvh(smallBvh, small);
+		collapse_mesh_bvh4(smallBvh);
+		std::vector<float> rays;
+		make_far_rays(rays, 64, farCases[f][0], farCases[f][1]);
+		char name[64];
+		snprintf(name, sizeof(name), "%g mesh at %g", farCases[f][0], farCases[f][1]);
+		cross_check_mesh_bvh(name, small, smallBvh, rays);
+	}
+}
+
+// -------------------------------------------------
+// "-bvh-build [ﰢ ] [ִ ]":   ó refit
+//     1, 2, 4, ...    ﰢ     (make_random_spheres)
+//    BVH   ʴ Ƽ  Ѵ (     ).
+//     ޽ y    Ʋ鼭 refit  ٽ 带 ð    
+// -------------------------------------------------
+void benchmark_bvh_build(int triangles, int maxThreads)
+{
+	TriMesh mesh;
+	make_bumpy_sphere(mesh, triangles);
+	size_t tris = mesh.triangle_count();
+
+	SceneSpheres spheres;
+	make_random_spheres(spheres, (int)tris, 1);
+	std::vector<float> sphereBounds(tris * 6);
+	for (size_t k = 0; k < tris; ++k) {
+		float c[3] = { spheres.cx[k], spheres.cy[k], spheres.cz[k] };
+		for (int a = 0; a < 3; ++a) {
+			sphereBounds[k * 6 + a] = c[a] - spheres.radius[k];
+			sphereBounds[k * 6 + 3 + a] = c[a] + spheres.radius[k];
+		}
+	}
+
+	printf("%d tris / spheres, %d hardware threads\n", (int)tris, (int)std::thread::hardware_concurrency());
+	for (int threads = 1; threads <= maxThreads; threads *= 2) {
+		double meshMs = 1e30, sphereMs = 1e30;
+		for (int k = 0; k < 3; ++k) {
+			MeshBvh bvh;
+			build_mesh_bvh(bvh, mesh, threads);
+			meshMs = min(meshMs, bvh.buildMs);
+			BvhBuildOptions options;
+			options.threads = threads;
+			BvhBuildResult spheres;
+			build_bvh(sphereBounds.data(), tris, options, spheres);
+			sphereMs = min(sphereMs, spheres.ms);
+		}
+		printf("%2d threads: triangles %8.1f ms %6.2f M/s, spheres %8.1f ms %6.2f M/s\n", threads,
+			meshMs, tris / (meshMs * 1000.0), sphereMs, tris / (sphereMs * 1000.0));
+	}
+
+	// Ʋ:  y   y  twist * y  
+	std::vector<float> rest = mesh.positions;
+	std::vector<float> camera;
+	make_bench_camera_rays(camera, 256);
+	MeshBvh refitted;
+	build_mesh_bvh(refitted, mesh);
+	collapse_mesh_bvh4(refitted);
+	for (int frame = 1; frame <= 4; ++frame) {
+		float twist = 0.5f * frame;
+		for (size_t v = 0; v < rest.size(); v += 3) {
+			float angle = twist * rest[v + 1], c = std::cos(angle), s = std::sin(angle);
+			mesh.positions[v] = c * rest[v] + s * rest[v + 2];
+			mesh.positions[v + 2] = -s * rest[v] + c * rest[v + 2];
+		}
+		refit_mesh_bvh(refitted, mesh);
+		MeshBvh rebuilt;
+		build_mesh_bvh(rebuilt, mesh);
+		collapse_mesh_bvh4(rebuilt);
+		BvhBenchResult a = bvh_bench_rays(refitted, camera, false, true);
+		BvhBenchResult b = bvh_bench_rays(rebuilt, camera, false, true);
+		double count = camera.size() / 7.0;
+		printf("twist %.1f: refit %7.1f ms %6.2f nodes/ray | rebuild %7.1f ms %6.2f nodes/ray%s\n", twist,
+			refitted.refitMs, a.stats.nodes / count, rebuilt.buildMs + rebuilt.collapseMs, b.stats.nodes / count,
+			a.hits == b.hits ? "" : " HIT MISMATCH");
+	}
+}
+
+// -------------------------------------------------
+// "-lbvh-bench [ ] [ ]": SAH  LBVH (30/63 Ʈ)   +  ð
+//    ī޶ 512x512 1  (ȼ ߽)     =  +   Ѵ.
+//   ޽:  .obj (⺻ bunny.json,  䳢 ũ  )
+//   : make_random_spheres (  )
+// -------------------------------------------------
+void make_scene_camera_rays(std::vector<float>& rays, int side)
+{
+	Camera camera;
+	camera_setup(camera, gScene.camera, side, side);
+	std::vector<float> dirs(3 * side);
+	rays.clear();
+	for (int j = 0; j < side; ++j) {
+		camera_row_dirs(camera, j, &dirs[0], &dirs[side], &dirs[2 * side]);
+		for (int i = 0; i < side; ++i)
+			rays.insert(rays.end(), { camera.eye[0], camera.eye[1], camera.eye[2], dirs[i], dirs[side + i], dirs[2 * side + i], 1e30f });
+	}
+}
+
+void print_frame_time(const char* what, BvhBuildMethod method, int nodes, double buildMs, double traceMs, double rays, int hits)
+{
+	printf("%-7s %-6s %8d nodes, build %8.1f ms, trace %8.1f ms (%5.2f M rays/s, %d hits), frame %8.1f ms\n",
+		what, bvh_build_method_name(method), nodes, buildMs, traceMs, rays / (traceMs * 1000.0), hits, buildMs + traceMs);
+}
+
+void benchmark_lbvh(const char* sceneFile, int sphereCount)
+{
+	load_scene_or_default(sceneFile, gScene);
+	load_meshes();
+	if (gMeshes.empty()) {
+		gMeshes.emplace_back();
+		make_bumpy_sphere(gMeshes.back().mesh, 70000);
+		float center[3] = { 0.0f, 0.0f, -7.0f };
+		place_mesh(gMeshes.back().mesh, center, 2.0f);
+		printf("[Mesh] no .obj in the scene, using a %d-triangle bumpy sphere\n", (int)gMeshes.back().mesh.triangle_count());
+	}
+	std::vector<float> rays;
+	make_scene_camera_rays(rays, 512);
+	double count = rays.size() / 7.0;
+	const BvhBuildMethod methods[3] = { BVH_BUILD_SAH, BVH_BUILD_LBVH30, BVH_BUILD_LBVH63 };
+
+	for (TracedMesh& m : gMeshes) {
+		printf("mesh: %d tris\n", (int)m.mesh.triangle_count());
+		for (BvhBuildMethod method : methods) {
+			build_mesh_bvh(m.bvh, m.mesh, 0, method);
+			collapse_mesh_bvh4(m.bvh);
+			BvhBenchResult r = bvh_bench_rays(m.bvh, rays, false, true);
+			print_frame_time("mesh", method, (int)m.bvh.nodes.size(), m.bvh.buildMs + m.bvh.collapseMs, r.ms, count, r.hits);
+		}
+	}
+
+	make_random_spheres(gScene.spheres, sphereCount, gScene.materials.size());
+	printf("spheres: %d\n", sphereCount);
+	for (BvhBuildMethod method : methods) {
+		build_sphere_bvh(method);
+		auto t0 = std::chrono::high_resolution_clock::now();
+		int hits = 0;
+		for (size_t k = 0; k < rays.size(); k += 7) {
+			vec3 o = to_vec3(&rays[k]), d = to_vec3(&rays[k + 3]);
+			float tMax = std::numeric_limits<float>::infinity();
+			hits += traverse_bvh(gSphereBvh.nodes, &o[0], &d[0], tMax, false, [&](uint32_t first, uint32_t n, float& t) {
+				bool hit = false;
+				for (uint32_t q = 0; q < n; ++q) {
+					float ts = hit_sphere(gSphereBvh.order[first + q], o, d, true);
+					if (ts > 0.001f && ts < t) {
+						t = ts;
+						hit = true;
+					}
+				}
+				return hit;
+			});
+		}
+		double traceMs = elapsed_ms(t0);
+		print_frame_time("spheres", method, (int)gSphereBvh.nodes.size(), gSphereBvh.ms, traceMs, count, hits);
+	}
+}
+
+// -------------------------------------------------
+//  켱 (render)   Ʈ (   / )  (â )
+//     õ   ϰ, render()  8Ʈ ٸ ȼ  
+// -------------------------------------------------
+int count_pixel_mismatches(const std::vector<float>& a, const std::vector<float>& b)
+{
+	int mismatches = 0;
+	for (size_t k = 0; k + 2 < a.size(); k += 3)
+		for (int c = 0; c < 3; ++c)
+			if ((int)(a[k + c] * 255.0f + 0.5f) != (int)(b[k + c] * 255.0f + 0.5f)) {
+				++mismatches;
+				break;
+			}
+	return mismatches;
+}
+
+void benchmark_stream(const char* sceneFile)
+{
+	load_scene_or_default(sceneFile, gScene);
+	build_material_table();
+	load_meshes();
+	build_sphere_bvh(BVH_BUILD_SAH);
+
+	srand(1);
+	auto t0 = std::chrono::high_resolution_clock::now();
 	render();
+	double depthFirstMs = elapsed_ms(t0);
+	std::vector<float> reference, image;
+	OutputImage.to_rgb(reference);
+	uint64_t rays = gRayStats.shadowRays;
+	for (int d = 0; d <= kMaxDepth; ++d)
+		rays += gRayStats.rays[d];
+
+	printf("%-12s %9.1f ms %7.2f M rays/s\n", "depth-first", depthFirstMs, rays / (depthFirstMs * 1000.0));
+	for (int sorted = 0; sorted < 2; ++sorted) {
+		srand(1);
+		t0 = std::chrono::high_resolution_clock::now();
+		render_stream(sorted != 0);
+		double ms = elapsed_ms(t0);
+		OutputImage.to_rgb(image);
+		printf("%-12s %9.1f ms %7.2f M rays/s, %d / %d pixels differ from depth-first\n", sorted ? "stream+sort" : "stream",
+			ms, rays / (ms * 1000.0), count_pixel_mismatches(reference, image), Width * Height);
+	}
 }
 
+// -------------------------------------------------
+// megakernel (render)  ĸ   (â )
+//   ĸ   /    .   ޶ render() ʹ RMSE ,
+//        ״ Ѵ
+//        鵵   ( )
+// -------------------------------------------------
+double image_rmse(const std::vector<float>& a, const std::vector<float>& b)
+{
+	double sum = 0.0;
+	for (size_t k = 0; k < a.size(); ++k)
+		sum += double(a[k] - b[k]) * (a[k] - b[k]);
+	return a.empty() ? 0.0 : std::sqrt(sum / a.size());
+}
+
+void benchmark_wavefront(const char* sceneFile)
+{
+	load_scene_or_default(sceneFile, gScene);
+	build_material_table();
+	load_meshes();
+	build_sphere_bvh(BVH_BUILD_SAH);
+
+	srand(1);
+	auto t0 = std::chrono::high_resolution_clock::now();
+	render();
+	double megaMs = elapsed_ms(t0);
+	std::vector<float> reference, image;
+	OutputImage.to_rgb(reference);
+	printf("%-16s %9.1f ms\n", "megakernel", megaMs);
+
+	int maxThreads = max((int)std::thread::hardware_concurrency(), 1);
+	std::vector<float> single;
+	for (int threads : { 1, maxThreads }) {
+		if (threads == maxThreads && threads == 1 && !single.empty())
+			break;
+		t0 = std::chrono::high_resolution_clock::now();
+		render_wavefront(threads);
+		double ms = elapsed_ms(t0);
+		OutputImage.to_rgb(image);
+		printf("wavefront x%-5d %9.1f ms (%.2fx megakernel), RMSE %.5f vs megakernel", threads, ms, megaMs / ms,
+			image_rmse(reference, image));
+		if (single.empty())
+			single = image;
+		else
+			printf(", %s 1 thread", single == image ? "identical to" : "DIFFERENT from");
+		printf("\n");
+	}
+
+	//    ("lights": []): ׸ ť ü 迭  
+	std::vector<SceneLight> lights;
+	lights.swap(gScene.lights);
+	srand(1);
+	render();
+	OutputImage.to_rgb(reference);
+	render_wavefront(1);
+	OutputImage.to_rgb(image);
+	printf("%-16s RMSE %.5f vs megakernel\n", "no lights", image_rmse(reference, image));
+	lights.swap(gScene.lights);
+}
+
+// -------------------------------------------------
+// "-camera-bench [] []": 1   ⸸  (ްȼ ms)
+//   per-pixel :  . ȼ   ,  , normalize
+//   camera    : camera_ray_dir (̸  corner / du / dv   )
+//   row       : camera_row_dirs (du    SSE  ȭ)
+//   x64   : render() ó ȼ 64  (ʹ ǥ о rand()  )
+//   (ִ  )     ȮѴ
+// -------------------------------------------------
+void benchmark_camera(int width, int height)
+{
+	const SceneCamera& cam = gScene.camera;
+	vec3 eye = to_vec3(cam.eye);
+	vec3 u = to_vec3(cam.u), v = to_vec3(cam.v), w = to_vec3(cam.w);
+	Camera camera;
+	camera_setup(camera, cam, width, height, false);	//  İ  â (  ʴ´)
+
+	size_t pixels = (size_t)width * height;
+	double megapixels = pixels / 1e6;
+	int repeats = max(1, (int)(8.0 / megapixels));
+	std::vector<float> reference(3 * pixels), dirs(3 * pixels);
+	float* rx = &reference[0], *ry = &reference[pixels], *rz = &reference[2 * pixels];
+	float* dx = &dirs[0], *dy = &dirs[pixels], *dz = &dirs[2 * pixels];
+
+	auto report = [&](const char* name, double ms, const std::vector<float>* check) {
+		printf("%-18s %8.2f ms/MP", name, ms / repeats / megapixels);
+		if (check) {
+			float err = 0.0f;
+			for (size_t k = 0; k < check->size(); ++k)
+				err = max(err, std::abs((*check)[k] - reference[k]));
+			printf(", max error %.2e", err);
+		}
+		printf("\n");
+	};
+	printf("%dx%d, %s kernel\n", width, height, camera_kernel_name());
+
+	auto t0 = std::chrono::high_resolution_clock::now();
+	for (int rep = 0; rep < repeats; ++rep)
+		for (int j = 0; j < height; ++j)
+			for (int i = 0; i < width; ++i) {
+				float u_coord = cam.l + (cam.r - cam.l) * (i + 0.5f) / width;
+				float v_coord = cam.b + (cam.t - cam.b) * (j + 0.5f) / height;
+				vec3 pixel_pos = eye - cam.distance * w + u_coord * u + v_coord * v;
+				vec3 d = normalize(pixel_pos - eye);
+				size_t k = (size_t)j * width + i;
+				rx[k] = d.x;
+				ry[k] = d.y;
+				rz[k] = d.z;
+			}
+	report("per-pixel", elapsed_ms(t0), nullptr);
+
+	t0 = std::chrono::high_resolution_clock::now();
+	for (int rep = 0; rep < repeats; ++rep)
+		for (int j = 0; j < height; ++j)
+			for (int i = 0; i < width; ++i) {
+				float d[3];
+				camera_ray_dir(camera, i + 0.5f, j + 0.5f, d);
+				size_t k = (size_t)j * width + i;
+				dx[k] = d[0];
+				dy[k] = d[1];
+				dz[k] = d[2];
+			}
+	report("camera", elapsed_ms(t0), &dirs);
+
+	std::fill(dirs.begin(), dirs.end(), 0.0f);
+	t0 = std::chrono::high_resolution_clock::now();
+	for (int rep = 0; rep < repeats; ++rep)
+		for (int j = 0; j < height; ++j)
+			camera_row_dirs(camera, j, dx + (size_t)j * width, dy + (size_t)j * width, dz + (size_t)j * width);
+	report("row", elapsed_ms(t0), &dirs);
+
+	// 64 :    Ϸ   ʰ Ѵ
+	const int N = 64;
+	float jitter[2 * N];
+	srand(1);
+	for (float& r : jitter)
+		r = static_cast<float>(rand()) / RAND_MAX;
+	vec3 sum(0.0f);
+	t0 = std::chrono::high_resolution_clock::now();
+	for (int j = 0; j < height; ++j)
+		for (int i = 0; i < width; ++i)
+			for (int s = 0; s < N; ++s) {
+				float u_coord = cam.l + (cam.r - cam.l) * (i + jitter[2 * s]) / width;
+				float v_coord = cam.b + (cam.t - cam.b) * (j + jitter[2 * s + 1]) / height;
+				vec3 pixel_pos = eye - cam.distance * w + u_coord * u + v_coord * v;
+				sum += normalize(pixel_pos - eye);
+			}
+	double perPixelMs = elapsed_ms(t0);
+	t0 = std::chrono::high_resolution_clock::now();
+	for (int j = 0; j < height; ++j)
+		for (int i = 0; i < width; ++i)
+			for (int s = 0; s < N; ++s) {
+				vec3 d;
+				camera_ray_dir(camera, i + jitter[2 * s], j + jitter[2 * s + 1], &d[0]);
+				sum += d;
+			}
+	double cameraMs = elapsed_ms(t0);
+	repeats = 1;
+	report("per-pixel x64", perPixelMs, nullptr);
+	report("camera x64", cameraMs, nullptr);
+	printf("(checksum %.3f)\n", sum.x + sum.y + sum.z);
+}
 
 int main(int argc, char* argv[])
 {
+	// -------------------------------------------------
+	// : [-format float|half|rgba8]   տ ָ OutputImage   (⺻ float)
+	//         [-display pixels|pbo]  ȭ   (⺻ PBO ؽó)
+	//       [ ]                      Whitted (⺻)
+	//       -path [ ]                  (â )
+	//       -path-ref  spp out.pfm         
+	//       -path-conv  spp ref.pfm          
+	//       -bench N                            
+	//       -bvh-bench [ﰢ ]           BVH2 / BVH4 ȸ 
+	//       -bvh-build [ﰢ ] []   BVH  ó, refit
+	//       -lbvh-bench [] [ ]     SAH / LBVH  +  ð
+	//       -stream [ ]              Whitted    Ʈ
+	//       -stream-bench []              켱 / Ʈ /  Ʈ ð 
+	//       -wavefront [ ]           Whitted  ܰ躰 ĸ 
+	//       -wavefront-bench []          megakernel / ĸ (1 ,  ) ð 
+	//       -camera-bench [] []      1     (ްȼ)
+	// -------------------------------------------------
+	if (argc > 2 && strcmp(argv[1], "-format") == 0) {
+		FramebufferFormat format = FB_RGB32F;
+		if (strcmp(argv[2], "half") == 0)
+			format = FB_RGB16F;
+		else if (strcmp(argv[2], "rgba8") == 0)
+			format = FB_RGBA8;
+		else if (strcmp(argv[2], "float") != 0)
+			printf("WARNING: unknown -format %s, using float\n", argv[2]);
+		OutputImage.resize(0, 0, format);
+		printf("[Output] %s framebuffer\n", framebuffer_format_name(format));
+		argv[2] = argv[0];
+		argv += 2;
+		argc -= 2;
+	}
+	DisplayMode displayMode = display_mode_from_args(argc, argv);
+	if (argc > 2 && strcmp(argv[1], "-bench") == 0) {
+		benchmark_scene_io(atoi(argv[2]));
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "-bvh-bench") == 0) {
+		benchmark_bvh(argc > 2 ? atoi(argv[2]) : 70000);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "-bvh-build") == 0) {
+		int maxThreads = argc > 3 ? atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+		benchmark_bvh_build(argc > 2 ? atoi(argv[2]) : 1000000, max(maxThreads, 1));
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "-lbvh-bench") == 0) {
+		benchmark_lbvh(argc > 2 ? argv[2] : "../scenes/bunny.json", argc > 3 ? atoi(argv[3]) : 100000);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "-stream-bench") == 0) {
+		benchmark_stream(argc > 2 ? argv[2] : "../scenes/hw2.json");
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "-camera-bench") == 0) {
+		load_scene_or_default("../scenes/hw2.json", gScene);
+		benchmark_camera(argc > 2 ? atoi(argv[2]) : 1024, argc > 3 ? atoi(argv[3]) : 1024);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "-wavefront-bench") == 0) {
+		benchmark_wavefront(argc > 2 ? argv[2] : "../scenes/hw2.json");
+		return 0;
+	}
+	if (argc > 4 && (strcmp(argv[1], "-path-ref") == 0 || strcmp(argv[1], "-path-conv") == 0)) {
+		load_scene_or_default(argv[2], gScene);
+		int spp = max(atoi(argv[3]), 1);
+		return strcmp(argv[1], "-path-ref") == 0 ? path_reference(spp, argv[4]) : path_convergence(spp, argv[4]);
+	}
+	gPathMode = argc > 1 && strcmp(argv[1], "-path") == 0;
+	gStreamMode = argc > 1 && strcmp(argv[1], "-stream") == 0;
+	gWavefrontMode = argc > 1 && strcmp(argv[1], "-wavefront") == 0;
+	int sceneArg = gPathMode || gStreamMode || gWavefrontMode ? 2 : 1;
+	const char* sceneFile = argc > sceneArg ? argv[sceneArg] : "../scenes/hw2.json";
+	load_scene_or_default(sceneFile, gScene);
+	build_material_table();
+	load_meshes();
+	build_sphere_bvh(BVH_BUILD_SAH);
+	if (gPathMode)
+		path_tracer_init(gPath, gScene, Width, Height);
+
 	// -------------------------------------------------
 	// Initialize Window
 	// -------------------------------------------------
@@ -217,6 +1961,10 @@ int main(int argc, char* argv[])
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
+	//Upload the image into a texture through a pixel buffer object only when
+	//it changes (or use glDrawPixels every frame with "-display pixels")
+	display_init(Display, displayMode);
+
 	//We call our resize function once to set everything up initially
 	//after registering it as a callback with glfw
 	glfwSetFramebufferSizeCallback(window, resize_callback);
@@ -228,9 +1976,21 @@ int main(int argc, char* argv[])
 		//Clear the screen
 		glClear(GL_COLOR_BUFFER_BIT);
 
+		//  : Ӹ ȼ 1     ش
+		if (gPathMode) {
+			path_tracer_pass(gPath);
+			path_tracer_resolve(gPath, OutputImage);
+			display_mark_dirty(Display);
+			if ((gPath.passes & (gPath.passes - 1)) == 0)
+				print_path_progress(gPath, -1.0);
+		}
+		else {
+			render_if_resize_settled();
+		}
+
 		// -------------------------------------------------------------
-		//Rendering begins!
-		glDrawPixels(Width, Height, GL_RGB, GL_FLOAT, &OutputImage[0]);
+		//Rendering begins! (stretched to the window while a resize settles)
+		display_draw(Display, OutputImage, Width, Height);
 		//and ends.
 		// -------------------------------------------------------------
 
@@ -248,6 +2008,7 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	display_release(Display);
 	glfwDestroyWindow(window);
 	glfwTerminate();
 	return 0;
@@ -0,0 +1,420 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include "path_tracer.h"
+#include "camera.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+using namespace glm;
+
+static const float kPi = glm::pi<float>();
+static const float kEpsilon = 0.001f;
+static const float kInfinity = std::numeric_limits<float>::infinity();
+
+// ----------------------------------------------------------------------------
+// 난수: PCG32. 픽셀 번호를 stream, 패스 번호를 seed 로 쓴다
+// ----------------------------------------------------------------------------
+struct Rng {
+    uint64_t state, inc;
+
+    Rng(uint64_t stream, uint64_t seed) : state(0), inc((stream << 1) | 1) {
+        next();
+        state += seed;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((~rot + 1) & 31));
+    }
+
+    // [0, 1)
+    float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }
+};
+
+// ----------------------------------------------------------------------------
+// 장면 교차
+// ----------------------------------------------------------------------------
+struct PathHit {
+    vec3     p, n;          // n 은 바깥쪽 노멀
+    uint32_t material;
+    int      sphere;        // 평면이면 -1
+};
+
+static vec3 to_vec3(const float* v) { return vec3(v[0], v[1], v[2]); }
+
+static vec3 sphere_center(const SceneSpheres& s, size_t k) { return vec3(s.cx[k], s.cy[k], s.cz[k]); }
+
+// tMax 보다 가까운 교차. 구 안에서 출발한 광선은 먼 쪽 근을 쓴다
+static bool intersect_scene(const SceneData& scene, const vec3& o, const vec3& dir, float tMax, PathHit& hit) {
+    const SceneSpheres& spheres = scene.spheres;
+    float closest = tMax;
+    bool found = false;
+    for (size_t k = 0; k < spheres.size(); ++k) {
+        vec3 oc = o - sphere_center(spheres, k);
+        float b = dot(oc, dir);
+        float c = dot(oc, oc) - spheres.radius[k] * spheres.radius[k];
+        float disc = b * b - c;     // dir 은 단위 벡터
+        if (disc <= 0.0f) continue;
+        float root = std::sqrt(disc);
+        float t = -b - root;
+        if (t <= kEpsilon) t = -b + root;
+        if (t > kEpsilon && t < closest) {
+            closest = t;
+            hit.sphere = (int)k;
+            hit.material = spheres.material[k];
+            found = true;
+        }
+    }
+    for (const ScenePlane& plane : scene.planes) {
+        vec3 n = to_vec3(plane.normal);
+        float denom = dot(n, dir);
+        if (denom == 0.0f) continue;
+        float t = (plane.offset - dot(n, o)) / denom;
+        if (t > kEpsilon && t < closest) {
+            closest = t;
+            hit.sphere = -1;
+            hit.material = plane.material;
+            hit.n = n;
+            found = true;
+        }
+    }
+    if (found) {
+        hit.p = o + closest * dir;
+        if (hit.sphere >= 0)
+            hit.n = normalize(hit.p - sphere_center(spheres, hit.sphere));
+    }
+    return found;
+}
+
+// ----------------------------------------------------------------------------
+// 샘플링
+// ----------------------------------------------------------------------------
+
+// n 을 z 축으로 하는 정규직교 기저 (Duff et al. 2017)
+static void make_basis(const vec3& n, vec3& t, vec3& b) {
+    float sign = n.z >= 0.0f ? 1.0f : -1.0f;
+    float a = -1.0f / (sign + n.z);
+    float c = n.x * n.y * a;
+    t = vec3(1.0f + sign * n.x * n.x * a, sign * c, -sign * n.x);
+    b = vec3(c, sign + n.y * n.y * a, -n.y);
+}
+
+// pdf = cos / pi
+static vec3 sample_cosine_hemisphere(const vec3& n, float u1, float u2) {
+    float r = std::sqrt(u1);
+    float phi = 2.0f * kPi * u2;
+    vec3 t, b;
+    make_basis(n, t, b);
+    return normalize(r * std::cos(phi) * t + r * std::sin(phi) * b + std::sqrt(max(0.0f, 1.0f - u1)) * n);
+}
+
+// x 에서 본 구가 차지하는 원뿔의 1 - cos(theta_max). x 가 구 안이면 0
+static float sphere_cone(const vec3& x, const vec3& center, float radius) {
+    vec3 d = center - x;
+    float dist2 = dot(d, d);
+    if (dist2 <= radius * radius) return 0.0f;
+    float sin2 = radius * radius / dist2;
+    return sin2 / (1.0f + std::sqrt(1.0f - sin2));   // 1 - sqrt(1 - sin2), 작은 구에서도 정확
+}
+
+// 입체각 균등 샘플링. pdf = 1 / (2 pi (1 - cos(theta_max)))
+static bool sample_sphere_light(const vec3& x, const vec3& center, float radius, float u1, float u2,
+                                vec3& wi, float& pdf) {
+    float cone = sphere_cone(x, center, radius);
+    if (cone <= 0.0f) return false;
+    float cosTheta = 1.0f - u1 * cone;
+    float sinTheta = std::sqrt(max(0.0f, 1.0f - cosTheta * cosTheta));
+    float phi = 2.0f * kPi * u2;
+    vec3 axis = normalize(center - x), t, b;
+    make_basis(axis, t, b);
+    wi = normalize(sinTheta * std::cos(phi) * t + sinTheta * std::sin(phi) * b + cosTheta * axis);
+    pdf = 1.0f / (2.0f * kPi * cone);
+    return true;
+}
+
+static float power_heuristic(float a, float b) {
+    a *= a;
+    b *= b;
+    return a / (a + b);
+}
+
+static float max_component(const vec3& v) { return max(v.x, max(v.y, v.z)); }
+
+// 확산 로브: kd/pi + ks (n+2)/(2pi) cos^n (wo 의 반사 방향과 wi 사이)
+static vec3 eval_phong(const SceneMaterial& m, const vec3& n, const vec3& wo, const vec3& wi) {
+    vec3 f = to_vec3(m.kd) * (1.0f / kPi);
+    vec3 ks = to_vec3(m.ks);
+    if (max_component(ks) > 0.0f) {
+        float c = max(dot(reflect(-wo, n), wi), 0.0f);
+        f += ks * ((m.specPow + 2.0f) / (2.0f * kPi) * std::pow(c, m.specPow));
+    }
+    return f;
+}
+
+// ----------------------------------------------------------------------------
+// 경로 하나
+// ----------------------------------------------------------------------------
+static vec3 trace_path(const PathTracer& pt, vec3 o, vec3 dir, Rng& rng) {
+    const SceneData& scene = *pt.scene;
+    const SceneSpheres& spheres = scene.spheres;
+    int pointCount = (int)scene.lights.size();
+    int lightCount = pointCount + (int)pt.areaLights.size();
+
+    vec3 radiance(0.0f), beta(1.0f);
+    bool specular = true;       // 카메라 광선 / 거울 / 유리 다음에는 발광을 MIS 없이 더한다
+    vec3 prevPos;               // 직전 확산 정점 (MIS 의 광원 pdf 계산용)
+    float prevPdf = 0.0f;
+
+    for (int depth = 0;; ++depth) {
+        PathHit hit;
+        if (!intersect_scene(scene, o, dir, kInfinity, hit)) break;
+        const SceneMaterial& m = scene.materials[hit.material];
+        vec3 n = hit.n;
+        bool inside = dot(n, dir) > 0.0f;
+        if (inside) n = -n;
+
+        vec3 emission = to_vec3(m.emission);
+        if (!inside && max_component(emission) > 0.0f) {
+            float weight = 1.0f;
+            if (!specular && hit.sphere >= 0) {
+                float cone = sphere_cone(prevPos, sphere_center(spheres, hit.sphere), spheres.radius[hit.sphere]);
+                float lightPdf = cone > 0.0f ? 1.0f / (2.0f * kPi * cone * lightCount) : 0.0f;
+                weight = power_heuristic(prevPdf, lightPdf);
+            }
+            radiance += beta * emission * weight;
+        }
+        if (depth == kPathMaxDepth) break;
+
+        // 로브 선택 (재질 비율 = 선택 확률이므로 beta 는 그대로)
+        float lobe = rng.uniform();
+        vec3 wo = -dir;
+        if (lobe < m.kr) {
+            o = hit.p + kEpsilon * n;
+            dir = reflect(dir, n);
+            specular = true;
+        }
+        else if (lobe < m.kr + m.kt) {
+            // 유리: Schlick Fresnel 확률로 반사 또는 굴절 (전반사면 반사)
+            float r0 = (1.0f - m.ior) / (1.0f + m.ior);
+            r0 *= r0;
+            vec3 refracted = refract(dir, n, inside ? m.ior : 1.0f / m.ior);
+            float fresnel = 1.0f;
+            if (dot(refracted, refracted) > 0.0f) {
+                float c = inside ? -dot(refracted, n) : dot(wo, n);
+                fresnel = r0 + (1.0f - r0) * std::pow(1.0f - c, 5.0f);
+            }
+            if (rng.uniform() < fresnel) {
+                o = hit.p + kEpsilon * n;
+                dir = reflect(dir, n);
+            }
+            else {
+                o = hit.p - kEpsilon * n;
+                dir = normalize(refracted);
+            }
+            specular = true;
+        }
+        else {
+            vec3 x = hit.p + kEpsilon * n;
+
+            // --- NEE: 광원 하나를 균등하게 골라 그림자 광선 하나 ---
+            if (lightCount > 0) {
+                int li = min((int)(rng.uniform() * lightCount), lightCount - 1);
+                float u1 = rng.uniform(), u2 = rng.uniform();
+                if (li < pointCount) {
+                    const SceneLight& light = scene.lights[li];
+                    vec3 toLight = to_vec3(light.position) - x;
+                    float dist2 = dot(toLight, toLight);
+                    float dist = std::sqrt(dist2);
+                    vec3 wi = toLight / dist;
+                    float cosTheta = dot(n, wi);
+                    PathHit blocker;
+                    if (cosTheta > 0.0f && !intersect_scene(scene, x, wi, dist, blocker))
+                        radiance += beta * eval_phong(m, n, wo, wi) * to_vec3(light.color)
+                            * (cosTheta / dist2 * lightCount);
+                }
+                else {
+                    uint32_t k = pt.areaLights[li - pointCount];
+                    vec3 wi;
+                    float lightPdf;
+                    PathHit lightHit;
+                    if (sample_sphere_light(x, sphere_center(spheres, k), spheres.radius[k], u1, u2, wi, lightPdf)
+                        && dot(n, wi) > 0.0f
+                        && intersect_scene(scene, x, wi, kInfinity, lightHit) && lightHit.sphere == (int)k) {
+                        float cosTheta = dot(n, wi);
+                        lightPdf /= lightCount;
+                        float weight = power_heuristic(lightPdf, cosTheta / kPi);
+                        radiance += beta * eval_phong(m, n, wo, wi) * to_vec3(scene.materials[lightHit.material].emission)
+                            * (cosTheta * weight / lightPdf);
+                    }
+                }
+            }
+
+            // --- BSDF 샘플링 (cos 가중) ---
+            vec3 wi = sample_cosine_hemisphere(n, rng.uniform(), rng.uniform());
+            float cosTheta = dot(n, wi);
+            if (cosTheta <= 0.0f) break;
+            float pdf = cosTheta / kPi;
+            beta *= eval_phong(m, n, wo, wi) * (cosTheta / pdf);
+            prevPos = x;
+            prevPdf = pdf;
+            specular = false;
+            o = x;
+            dir = wi;
+        }
+
+        if (depth >= kPathRouletteDepth) {
+            float survive = min(max_component(beta), 0.95f);
+            if (rng.uniform() >= survive) break;
+            beta /= survive;
+        }
+    }
+    return radiance;
+}
+
+// ----------------------------------------------------------------------------
+// 누적 버퍼
+// ----------------------------------------------------------------------------
+void path_tracer_init(PathTracer& pt, const SceneData& scene, int width, int height) {
+    pt.scene = &scene;
+    pt.areaLights.clear();
+    for (size_t k = 0; k < scene.spheres.size(); ++k)
+        if (max_component(to_vec3(scene.materials[scene.spheres.material[k]].emission)) > 0.0f)
+            pt.areaLights.push_back((uint32_t)k);
+    path_tracer_reset(pt, width, height);
+}
+
+void path_tracer_reset(PathTracer& pt, int width, int height) {
+    pt.width = width;
+    pt.height = height;
+    pt.passes = 0;
+    pt.renderMs = 0.0;
+    pt.accum.assign((size_t)width * height * 3, 0.0f);
+}
+
+void path_tracer_pass(PathTracer& pt) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    Camera camera;
+    camera_setup(camera, pt.scene->camera, pt.width, pt.height);
+    vec3 eye = to_vec3(camera.eye);
+    uint64_t seed = (uint64_t)pt.passes * 0x9E3779B97F4A7C15ULL;
+
+    std::atomic<int> nextRow(0);
+    auto worker = [&]() {
+        for (int j; (j = nextRow++) < pt.height;) {
+            for (int i = 0; i < pt.width; ++i) {
+                size_t pixel = (size_t)j * pt.width + i;
+                Rng rng(pixel, seed);
+                float ru = rng.uniform();
+                vec3 dir;
+                camera_ray_dir(camera, i + ru, j + rng.uniform(), &dir[0]);
+                vec3 radiance = trace_path(pt, eye, dir, rng);
+                float* dst = &pt.accum[pixel * 3];
+                dst[0] += radiance.r;
+                dst[1] += radiance.g;
+                dst[2] += radiance.b;
+            }
+        }
+    };
+
+    int count = pt.threads > 0 ? pt.threads : (int)std::thread::hardware_concurrency();
+    std::vector<std::thread> pool;
+    for (int k = 1; k < count; ++k)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool)
+        t.join();
+
+    ++pt.passes;
+    pt.renderMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+void path_tracer_mean(const PathTracer& pt, Framebuffer& fb) {
+    float scale = pt.passes > 0 ? 1.0f / pt.passes : 0.0f;
+    fb.resize(pt.width, pt.height);
+    for (int y = 0; y < pt.height; ++y)
+        for (int x = 0; x < pt.width; ++x) {
+            const float* a = &pt.accum[((size_t)y * pt.width + x) * 3];
+            fb.set(x, y, a[0] * scale, a[1] * scale, a[2] * scale);
+        }
+}
+
+void path_tracer_resolve(const PathTracer& pt, Framebuffer& fb) {
+    float scale = pt.passes > 0 ? 1.0f / pt.passes : 0.0f;
+    fb.resize(pt.width, pt.height);
+    for (int y = 0; y < pt.height; ++y)
+        for (int x = 0; x < pt.width; ++x) {
+            const float* a = &pt.accum[((size_t)y * pt.width + x) * 3];
+            float rgb[3];
+            for (int c = 0; c < 3; ++c)
+                rgb[c] = std::pow(clamp(a[c] * scale, 0.0f, 1.0f), 1.0f / 2.2f);
+            fb.set(x, y, rgb);
+        }
+}
+
+double path_tracer_rmse(const PathTracer& pt, const std::vector<float>& reference) {
+    if (reference.size() != pt.accum.size() || pt.passes == 0) return -1.0;
+    double scale = 1.0 / pt.passes, sum = 0.0;
+    for (size_t k = 0; k < pt.accum.size(); ++k) {
+        double d = pt.accum[k] * scale - reference[k];
+        sum += d * d;
+    }
+    return std::sqrt(sum / pt.accum.size());
+}
+
+double path_tracer_samples_per_sec(const PathTracer& pt) {
+    return pt.renderMs > 0.0 ? (double)pt.width * pt.height * pt.passes / (pt.renderMs / 1000.0) : 0.0;
+}
+
+// ----------------------------------------------------------------------------
+// PFM: "PF\n<w> <h>\n-1.0\n" + little endian float RGB, 아래 줄부터
+// ----------------------------------------------------------------------------
+bool write_pfm(const char* filename, const Framebuffer& fb) {
+    FILE* f = fopen(filename, "wb");
+    if (!f) {
+        printf("ERROR: cannot write %s\n", filename);
+        return false;
+    }
+    fprintf(f, "PF\n%d %d\n-1.0\n", fb.width, fb.height);
+    if (fb.format == FB_RGB32F) {
+        fwrite(fb.data(), 1, fb.bytes(), f);
+    }
+    else {
+        std::vector<float> rgb;
+        fb.to_rgb(rgb);
+        fwrite(rgb.data(), sizeof(float), rgb.size(), f);
+    }
+    fclose(f);
+    return true;
+}
+
+bool read_pfm(const char* filename, int& width, int& height, std::vector<float>& rgb) {
+    FILE* f = fopen(filename, "rb");
+    if (!f) {
+        printf("ERROR: cannot open %s\n", filename);
+        return false;
+    }
+    char magic[3] = {};
+    float scale = 0.0f;
+    bool ok = fscanf(f, "%2s %d %d %f", magic, &width, &height, &scale) == 4 && !strcmp(magic, "PF")
+        && scale < 0.0f && width > 0 && height > 0 && fgetc(f) != EOF;
+    if (ok) {
+        rgb.resize((size_t)width * height * 3);
+        ok = fread(rgb.data(), sizeof(float), rgb.size(), f) == rgb.size();
+    }
+    fclose(f);
+    if (!ok) printf("ERROR: %s: not a little endian RGB PFM\n", filename);
+    return ok;
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+#include <stdint.h>
+#include <vector>
+#include "framebuffer.h"
+#include "scene_file.h"
+
+// ----------------------------------------------------------------------------
+// 경로 추적 (HW2 장면 위의 두 번째 적분기, HW2_Q3 -path)
+//   - 단방향 경로 추적. 확산 로브는 cos 가중 반구 샘플링
+//   - 다음 사건 추정 (NEE): 광원 하나를 균등하게 골라 점광원 또는 발광 구를 샘플링
+//   - 발광 구는 입체각 균등 샘플링, BSDF 샘플링과 power heuristic 으로 MIS
+//   - 픽셀 (x, y) 의 n 번째 샘플은 항상 같은 난수열을 쓰므로 스레드 수와 무관하게 결과가 같다
+//   - 패스마다 픽셀당 1 샘플을 float 누적 버퍼에 더한다 (창에서는 점진적으로 보인다)
+//
+//   재질: (1-kr-kt) * [kd/pi + 정규화 Phong 정반사] + kr * 거울 + kt * 유리
+//         로브는 이 비율대로 확률적으로 고른다. ka (ambient) 는 쓰지 않는다.
+//   점광원 color 는 radiant intensity (거리 제곱으로 감쇠, radius 는 무시)
+// ----------------------------------------------------------------------------
+const int kPathMaxDepth = 8;
+const int kPathRouletteDepth = 3;       // 이 깊이부터 Russian roulette
+
+struct PathTracer {
+    const SceneData*      scene = nullptr;
+    int                   width = 0, height = 0;
+    int                   threads = 0;  // 0 이면 hardware_concurrency
+    int                   passes = 0;   // 누적된 픽셀당 샘플 수
+    double                renderMs = 0.0;
+    std::vector<float>    accum;        // width*height*3 radiance 합 (OutputImage 와 같은 순서)
+    std::vector<uint32_t> areaLights;   // 발광 재질을 가진 구 번호
+};
+
+void path_tracer_init(PathTracer& pt, const SceneData& scene, int width, int height);
+
+// 크기를 바꾸고 누적을 비운다
+void path_tracer_reset(PathTracer& pt, int width, int height);
+
+// 모든 픽셀에 샘플 하나씩 더한다 (행 단위로 스레드에 나눔)
+void path_tracer_pass(PathTracer& pt);
+
+// 누적 평균 (linear radiance). fb 는 pt 와 같은 크기로 맞춘다 (형식은 그대로)
+void path_tracer_mean(const PathTracer& pt, Framebuffer& fb);
+
+// 누적 평균을 감마 보정해서 fb 에 쓴다 (HW2 출력과 같은 형식)
+void path_tracer_resolve(const PathTracer& pt, Framebuffer& fb);
+
+// 누적 평균과 reference (같은 크기의 linear radiance) 의 RMSE
+double path_tracer_rmse(const PathTracer& pt, const std::vector<float>& reference);
+
+// 초당 샘플 (경로) 수
+double path_tracer_samples_per_sec(const PathTracer& pt);
+
+// PFM (linear float RGB, 아래 줄부터). 기준 영상 저장용 (float 가 아닌 형식은 변환해서 쓴다)
+bool write_pfm(const char* filename, const Framebuffer& fb);
+bool read_pfm(const char* filename, int& width, int& height, std::vector<float>& rgb);
@@ -3,7 +3,14 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
 #include <GL/glut.h>
+#include "light_tiles.h"
+#include "shadow_map.h"
+#include "scene_file.h"
 
 #define WIDTH 512
 #define HEIGHT 512
@@ -23,6 +30,13 @@ vector<Vec3> gNormals;
 float zBuffer[HEIGHT][WIDTH];
 unsigned char framebuffer[HEIGHT][WIDTH][3];
 
+// Lights in view space (the camera sits at the origin). gLights[0] is the original key light.
+vector<TileLight> gLights;
+vector<uint32_t> gAllLights;      // 0..N-1, used when tiling is off
+LightTileGrid gTiles;
+float gViewDepth[HEIGHT][WIDTH];
+double gBinMs = 0.0;
+
 Vec3 normalize(const Vec3& v) {
     float len = sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
     return { v.x / len, v.y / len, v.z / len };
@@ -62,28 +76,67 @@ float edgeFunction(const Vec3& a, const Vec3& b, const Vec3& c) {
     return (c.x - a.x) * (b.y - a.y) - (c.y - a.y) * (b.x - a.x);
 }
 
-Vec3 computeShading(const Vec3& pos, const Vec3& normal) {
+// Sums the lights in lightList (a tile's list, or every light when tiling is off)
+Vec3 computeShading(const Vec3& pos, const Vec3& normal, const uint32_t* lightList, int lightCount) {
     Vec3 ka = { 0.0f, 1.0f, 0.0f }, kd = { 0.0f, 0.5f, 0.0f }, ks = { 0.5f, 0.5f, 0.5f };
     float p = 32.0f;
-    Vec3 lightPos = { -4.0f, 4.0f, -3.0f }, Ia = { 0.2f, 0.2f, 0.2f }, Il = { 1.0f, 1.0f, 1.0f };
-
-    Vec3 l = normalize(lightPos - pos);
+    Vec3 Ia = { 0.2f, 0.2f, 0.2f };
     Vec3 v = normalize({ -pos.x, -pos.y, -pos.z });
-    Vec3 r = normalize(2 * dot(normal, l) * normal - l);
 
-    float diff = max(dot(normal, l), 0.0f);
-    float spec = pow(max(dot(r, v), 0.0f), p);
+    Vec3 sum = { Ia.x * ka.x, Ia.y * ka.y, Ia.z * ka.z };
+    for (int i = 0; i < lightCount; ++i) {
+        const TileLight& L = gLights[lightList[i]];
+        Vec3 toLight = Vec3{ L.x, L.y, L.z } - pos;
+        float dist = sqrt(dot(toLight, toLight));
+        float att = light_attenuation(dist, L.radius);
+        if (att <= 0.0f) continue;
+
+        Vec3 l = (1.0f / dist) * toLight;
+        Vec3 r = normalize(2 * dot(normal, l) * normal - l);
+        float diff = max(dot(normal, l), 0.0f);
+        float spec = pow(max(dot(r, v), 0.0f), p);
+
+        sum.x += att * L.r * (kd.x * diff + ks.x * spec);
+        sum.y += att * L.g * (kd.y * diff + ks.y * spec);
+        sum.z += att * L.b * (kd.z * diff + ks.z * spec);
+    }
 
     Vec3 color;
-    color.x = pow(Ia.x * ka.x + Il.x * (kd.x * diff + ks.x * spec), 1.0f / 2.2f);
-    color.y = pow(Ia.y * ka.y + Il.y * (kd.y * diff + ks.y * spec), 1.0f / 2.2f);
-    color.z = pow(Ia.z * ka.z + Il.z * (kd.z * diff + ks.z * spec), 1.0f / 2.2f);
+    color.x = pow(sum.x, 1.0f / 2.2f);
+    color.y = pow(sum.y, 1.0f / 2.2f);
+    color.z = pow(sum.z, 1.0f / 2.2f);
     return color;
 }
 
+// Depth pre-pass: same coverage and depth as rasterizePhong, no shading
+void rasterizeDepth(Vec3 scr0, Vec3 scr1, Vec3 scr2) {
+    int minX = max(0, (int)floor(min({ scr0.x, scr1.x, scr2.x })));
+    int maxX = min(WIDTH - 1, (int)ceil(max({ scr0.x, scr1.x, scr2.x })));
+    int minY = max(0, (int)floor(min({ scr0.y, scr1.y, scr2.y })));
+    int maxY = min(HEIGHT - 1, (int)ceil(max({ scr0.y, scr1.y, scr2.y })));
+
+    float area = edgeFunction(scr0, scr1, scr2);
+
+    for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+            Vec3 p = { (float)x + 0.5f, (float)y + 0.5f, 0 };
+            float w0 = edgeFunction(scr1, scr2, p);
+            float w1 = edgeFunction(scr2, scr0, p);
+            float w2 = edgeFunction(scr0, scr1, p);
+            if (w0 >= 0 && w1 >= 0 && w2 >= 0) {
+                w0 /= area; w1 /= area; w2 /= area;
+                float depth = w0 * scr0.z + w1 * scr1.z + w2 * scr2.z;
+                if (depth < zBuffer[y][x]) zBuffer[y][x] = depth;
+            }
+        }
+    }
+}
+
+// With tiled = true the depth buffer is already final, so only the visible
+// fragment (depth equal) is shaded, using its tile's light list
 void rasterizePhong(Vec3 scr0, Vec3 world0, Vec3 n0,
     Vec3 scr1, Vec3 world1, Vec3 n1,
-    Vec3 scr2, Vec3 world2, Vec3 n2) {
+    Vec3 scr2, Vec3 world2, Vec3 n2, bool tiled) {
     int minX = max(0, (int)floor(min({ scr0.x, scr1.x, scr2.x })));
     int maxX = min(WIDTH - 1, (int)ceil(max({ scr0.x, scr1.x, scr2.x })));
     int minY = max(0, (int)floor(min({ scr0.y, scr1.y, scr2.y })));
@@ -100,11 +153,18 @@ void rasterizePhong(Vec3 scr0, Vec3 world0, Vec3 n0,
             if (w0 >= 0 && w1 >= 0 && w2 >= 0) {
                 w0 /= area; w1 /= area; w2 /= area;
                 float depth = w0 * scr0.z + w1 * scr1.z + w2 * scr2.z;
-                if (depth < zBuffer[y][x]) {
+                if (tiled ? depth <= zBuffer[y][x] : depth < zBuffer[y][x]) {
                     zBuffer[y][x] = depth;
                     Vec3 pos = w0 * world0 + w1 * world1 + w2 * world2;
                     Vec3 normal = normalize(w0 * n0 + w1 * n1 + w2 * n2);
-                    Vec3 color = computeShading(pos, normal);
+                    const uint32_t* lightList = gAllLights.data();
+                    int lightCount = (int)gAllLights.size();
+                    if (tiled) {
+                        int t = (y / gTiles.tileSize) * gTiles.tilesX + x / gTiles.tileSize;
+                        lightList = gTiles.indices.data() + gTiles.offsets[t];
+                        lightCount = (int)(gTiles.offsets[t + 1] - gTiles.offsets[t]);
+                    }
+                    Vec3 color = computeShading(pos, normal, lightList, lightCount);
                     framebuffer[y][x][0] = (unsigned char)(min(1.0f, color.x) * 255);
                     framebuffer[y][x][1] = (unsigned char)(min(1.0f, color.y) * 255);
                     framebuffer[y][x][2] = (unsigned char)(min(1.0f, color.z) * 255);
@@ -114,12 +174,235 @@ void rasterizePhong(Vec3 scr0, Vec3 world0, Vec3 n0,
     }
 }
 
+// ----------------------------------------------------------------------------
+// HW2 scene (-hw2): spheres, planes, lights and materials from a scene file
+// (../scenes/hw2.json by default: the ray tracer's three spheres and y = -2
+// plane). Shadows of light 0 come from a shadow map pass + PCF instead of one
+// shadow ray per pixel. Only the spheres cast, as in HW2_Q1. The camera stays
+// this rasterizer's fixed 90 degree projection, and only planes facing +-y are drawn.
+// ----------------------------------------------------------------------------
+SceneData gScene;
+ShadowMap gShadowMap;
+double gShadowMs = 0.0;
+
+Vec3 toVec3(const float* v) { return { v[0], v[1], v[2] }; }
+
+// Same Phong terms as HW2_Q1 (ambient = ka per light, no gamma), with light 0's
+// diffuse + specular part scaled by the shadow map visibility
+Vec3 shadeHW2(const Vec3& pos, const Vec3& normal, const SceneMaterial& m, float visibility) {
+    Vec3 v = normalize({ -pos.x, -pos.y, -pos.z });
+    Vec3 sum = { 0, 0, 0 };
+    for (size_t i = 0; i < gScene.lights.size(); ++i) {
+        const SceneLight& light = gScene.lights[i];
+        Vec3 l = normalize(toVec3(light.position) - pos);
+        Vec3 r = 2 * dot(normal, l) * normal - l;
+        float diff = max(dot(normal, l), 0.0f);
+        float spec = pow(max(dot(r, v), 0.0f), m.specPow);
+        float lit = i == 0 ? visibility : 1.0f;
+        sum.x += light.color[0] * (m.ka[0] + lit * (m.kd[0] * diff + m.ks[0] * spec));
+        sum.y += light.color[1] * (m.ka[1] + lit * (m.kd[1] * diff + m.ks[1] * spec));
+        sum.z += light.color[2] * (m.ka[2] + lit * (m.kd[2] * diff + m.ks[2] * spec));
+    }
+    return { min(1.0f, sum.x), min(1.0f, sum.y), min(1.0f, sum.z) };
+}
+
+// Like rasterizePhong, but either winding is accepted and position/normal are
+// interpolated perspective-correct (the plane spans hundreds of units in depth)
+void rasterizeHW2(const Vec3 scr[3], const Vec3 world[3], const Vec3 normal[3], const SceneMaterial& m, bool shadows) {
+    int minX = max(0, (int)floor(min({ scr[0].x, scr[1].x, scr[2].x })));
+    int maxX = min(WIDTH - 1, (int)ceil(max({ scr[0].x, scr[1].x, scr[2].x })));
+    int minY = max(0, (int)floor(min({ scr[0].y, scr[1].y, scr[2].y })));
+    int maxY = min(HEIGHT - 1, (int)ceil(max({ scr[0].y, scr[1].y, scr[2].y })));
+
+    float area = edgeFunction(scr[0], scr[1], scr[2]);
+    if (area == 0) return;
+
+    for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+            Vec3 p = { (float)x + 0.5f, (float)y + 0.5f, 0 };
+            float w0 = edgeFunction(scr[1], scr[2], p) / area;
+            float w1 = edgeFunction(scr[2], scr[0], p) / area;
+            float w2 = edgeFunction(scr[0], scr[1], p) / area;
+            if (w0 < 0 || w1 < 0 || w2 < 0) continue;
+
+            // view = world here, so 1/w is 1/-z. It is linear in screen space and,
+            // unlike projectionTransform's z, grows towards the camera: depth = -1/w
+            float p0 = w0 / -world[0].z, p1 = w1 / -world[1].z, p2 = w2 / -world[2].z;
+            float invW = p0 + p1 + p2;
+            if (-invW >= zBuffer[y][x]) continue;
+            zBuffer[y][x] = -invW;
+
+            float inv = 1.0f / invW;
+            p0 *= inv; p1 *= inv; p2 *= inv;
+            Vec3 pos = p0 * world[0] + p1 * world[1] + p2 * world[2];
+            Vec3 n = normalize(p0 * normal[0] + p1 * normal[1] + p2 * normal[2]);
+            float visibility = shadows ? shadow_visibility(gShadowMap, &pos.x, &n.x) : 1.0f;
+            Vec3 color = shadeHW2(pos, n, m, visibility);
+            framebuffer[y][x][0] = (unsigned char)(color.x * 255);
+            framebuffer[y][x][1] = (unsigned char)(color.y * 255);
+            framebuffer[y][x][2] = (unsigned char)(color.z * 255);
+        }
+    }
+}
+
+Vec3 sphereVertex(size_t sphere, int i) {
+    const SceneSpheres& s = gScene.spheres;
+    return Vec3{ s.cx[sphere], s.cy[sphere], s.cz[sphere] } + s.radius[sphere] * gVertexBuffer[i];
+}
+
+// Shadow pass (spheres into the light's depth map) + colour pass. Returns ms.
+double renderHW2Frame(bool shadows) {
+    auto t0 = chrono::high_resolution_clock::now();
+
+    fill(&framebuffer[0][0][0], &framebuffer[0][0][0] + WIDTH * HEIGHT * 3, 0);
+    for (int y = 0; y < HEIGHT; ++y)
+        for (int x = 0; x < WIDTH; ++x)
+            zBuffer[y][x] = 1e9;
+
+    const SceneSpheres& spheres = gScene.spheres;
+    shadows = shadows && !gScene.lights.empty() && spheres.size() > 0;
+    if (shadows) {
+        // casters' bounding sphere (around their bounding box)
+        Vec3 lo = { 1e30f, 1e30f, 1e30f }, hi = { -1e30f, -1e30f, -1e30f };
+        for (size_t k = 0; k < spheres.size(); ++k) {
+            float r = spheres.radius[k];
+            lo = { min(lo.x, spheres.cx[k] - r), min(lo.y, spheres.cy[k] - r), min(lo.z, spheres.cz[k] - r) };
+            hi = { max(hi.x, spheres.cx[k] + r), max(hi.y, spheres.cy[k] + r), max(hi.z, spheres.cz[k] + r) };
+        }
+        Vec3 center = 0.5f * (lo + hi);
+        float radius = 0.0f;
+        for (size_t k = 0; k < spheres.size(); ++k) {
+            Vec3 d = Vec3{ spheres.cx[k], spheres.cy[k], spheres.cz[k] } - center;
+            radius = max(radius, sqrt(dot(d, d)) + spheres.radius[k]);
+        }
+        setup_shadow_map(gShadowMap, kShadowMapSize, gScene.lights[0].position, &center.x, radius);
+        for (size_t k = 0; k < spheres.size(); ++k)
+            for (int i = 0; i < gNumTriangles; ++i) {
+                Vec3 a = sphereVertex(k, gIndexBuffer[i * 3]);
+                Vec3 b = sphereVertex(k, gIndexBuffer[i * 3 + 1]);
+                Vec3 c = sphereVertex(k, gIndexBuffer[i * 3 + 2]);
+                shadow_map_triangle(gShadowMap, &a.x, &b.x, &c.x);
+            }
+    }
+    gShadowMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t0).count();
+
+    for (size_t k = 0; k < spheres.size(); ++k)
+        for (int i = 0; i < gNumTriangles; ++i) {
+            Vec3 world[3], scr[3], normal[3];
+            for (int j = 0; j < 3; ++j) {
+                int idx = gIndexBuffer[i * 3 + j];
+                world[j] = sphereVertex(k, idx);
+                scr[j] = viewportTransform(projectionTransform(world[j]));
+                normal[j] = gNormals[idx];
+            }
+            rasterizeHW2(scr, world, normal, gScene.materials[spheres.material[k]], shadows);
+        }
+
+    // The visible part of a plane y = h: it is outside the 90 degree frustum closer
+    // than z = -|h|, and |x| <= -z there. The far edge sits at the horizon.
+    for (const ScenePlane& plane : gScene.planes) {
+        if (fabs(plane.normal[1]) < 0.999f) continue;
+        float h = plane.offset / plane.normal[1];
+        float zn = -0.95f * max(fabs(h), 0.2f), zf = -1e5f;
+        Vec3 quad[4] = { { -1.1f * -zn, h, zn }, { 1.1f * -zn, h, zn }, { 1.1f * -zf, h, zf }, { -1.1f * -zf, h, zf } };
+        Vec3 n = { 0, plane.normal[1] > 0 ? 1.0f : -1.0f, 0 };
+        Vec3 normals[3] = { n, n, n };
+        const int tris[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+        for (const auto& t : tris) {
+            Vec3 world[3] = { quad[t[0]], quad[t[1]], quad[t[2]] };
+            Vec3 scr[3];
+            for (int j = 0; j < 3; ++j) scr[j] = viewportTransform(projectionTransform(world[j]));
+            rasterizeHW2(scr, world, normals, gScene.materials[plane.material], shadows);
+        }
+    }
+    return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t0).count();
+}
+
+// Binary PPM, top row first (same orientation as the window)
+void writePPM(const char* filename) {
+    FILE* f = fopen(filename, "wb");
+    if (!f) {
+        printf("ERROR: cannot write %s\n", filename);
+        return;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", WIDTH, HEIGHT);
+    fwrite(framebuffer, 1, sizeof(framebuffer), f);
+    fclose(f);
+}
+
 void renderScene() {
     glClear(GL_COLOR_BUFFER_BIT);
     glDrawPixels(WIDTH, HEIGHT, GL_RGB, GL_UNSIGNED_BYTE, framebuffer);
     glFlush();
 }
 
+// Key light (-4,4,-3) without falloff plus count-1 small coloured point lights
+// scattered around the sphere (fixed seed, so runs are comparable)
+void createLights(int count) {
+    gLights.clear();
+    gLights.push_back({ -4.0f, 4.0f, -3.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f });
+    unsigned int seed = 12345u;
+    auto rnd = [&seed]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) * (1.0f / 16777216.0f); };
+    for (int i = 1; i < count; ++i) {
+        float theta = rnd() * (float)M_PI, phi = rnd() * 2.0f * (float)M_PI;
+        float dist = 2.2f + rnd() * 1.0f;
+        TileLight l;
+        l.x = dist * sinf(theta) * cosf(phi);
+        l.y = dist * cosf(theta);
+        l.z = -7.0f + dist * sinf(theta) * sinf(phi);
+        l.radius = 1.5f;
+        l.r = 0.6f * rnd(); l.g = 0.6f * rnd(); l.b = 0.6f * rnd();
+        l.pad = 0.0f;
+        gLights.push_back(l);
+    }
+    gAllLights.resize(gLights.size());
+    for (size_t i = 0; i < gAllLights.size(); ++i) gAllLights[i] = (uint32_t)i;
+}
+
+// Renders the sphere into framebuffer and returns the elapsed time in ms.
+// tiled: depth pre-pass -> bin lights into 16x16 tiles -> shade with per-tile lists
+double renderFrame(bool tiled) {
+    auto t0 = chrono::high_resolution_clock::now();
+
+    fill(&framebuffer[0][0][0], &framebuffer[0][0][0] + WIDTH * HEIGHT * 3, 0);
+    for (int y = 0; y < HEIGHT; ++y)
+        for (int x = 0; x < WIDTH; ++x)
+            zBuffer[y][x] = 1e9;
+
+    if (tiled) {
+        for (int i = 0; i < gNumTriangles; ++i) {
+            int i0 = gIndexBuffer[i * 3], i1 = gIndexBuffer[i * 3 + 1], i2 = gIndexBuffer[i * 3 + 2];
+            rasterizeDepth(viewportTransform(projectionTransform(modelTransform(gVertexBuffer[i0]))),
+                           viewportTransform(projectionTransform(modelTransform(gVertexBuffer[i1]))),
+                           viewportTransform(projectionTransform(modelTransform(gVertexBuffer[i2]))));
+        }
+
+        // NDC depth back to view distance: z = 2fn / (z_ndc (f - n) - f - n)
+        auto b0 = chrono::high_resolution_clock::now();
+        const float n = -0.1f, f = -1000.0f;
+        for (int y = 0; y < HEIGHT; ++y)
+            for (int x = 0; x < WIDTH; ++x) {
+                float d = zBuffer[y][x];
+                gViewDepth[y][x] = d >= 1e9f ? 0.0f : -(2 * f * n / (d * (f - n) - f - n));
+            }
+        LightTileCamera camera = { 1.0f, 1.0f, 0.1f, true };
+        bin_lights(gTiles, WIDTH, HEIGHT, camera, &gViewDepth[0][0], gLights.data(), (int)gLights.size());
+        gBinMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - b0).count();
+    }
+
+    for (int i = 0; i < gNumTriangles; ++i) {
+        int i0 = gIndexBuffer[i * 3], i1 = gIndexBuffer[i * 3 + 1], i2 = gIndexBuffer[i * 3 + 2];
+        Vec3 w0 = modelTransform(gVertexBuffer[i0]);
+        Vec3 w1 = modelTransform(gVertexBuffer[i1]);
+        Vec3 w2 = modelTransform(gVertexBuffer[i2]);
+        Vec3 v0 = viewportTransform(projectionTransform(w0));
+        Vec3 v1 = viewportTransform(projectionTransform(w1));
+        Vec3 v2 = viewportTransform(projectionTransform(w2));
+        rasterizePhong(v0, w0, gNormals[i0], v1, w1, gNormals[i1], v2, w2, gNormals[i2], tiled);
+    }
+    return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - t0).count();
+}
+
 int main(int argc, char** argv) {
     create_scene();
     int width = 32, height = 16;
@@ -150,20 +433,47 @@ int main(int argc, char** argv) {
     }
     for (int i = 0; i < gNumVertices; ++i) gNormals[i] = normalize(gNormals[i]);
 
-    fill(&framebuffer[0][0][0], &framebuffer[0][0][0] + WIDTH * HEIGHT * 3, 0);
-    for (int y = 0; y < HEIGHT; ++y)
-        for (int x = 0; x < WIDTH; ++x)
-            zBuffer[y][x] = 1e9;
+    int lightCount = 1;
+    bool sweep = false, hw2 = false;
+    if (argc > 1) {
+        if (strcmp(argv[1], "-sweep") == 0) sweep = true;
+        else if (strcmp(argv[1], "-hw2") == 0) hw2 = true;
+        else lightCount = max(1, atoi(argv[1]));
+    }
 
-    for (int i = 0; i < gNumTriangles; ++i) {
-        int i0 = gIndexBuffer[i * 3], i1 = gIndexBuffer[i * 3 + 1], i2 = gIndexBuffer[i * 3 + 2];
-        Vec3 w0 = modelTransform(gVertexBuffer[i0]);
-        Vec3 w1 = modelTransform(gVertexBuffer[i1]);
-        Vec3 w2 = modelTransform(gVertexBuffer[i2]);
-        Vec3 v0 = viewportTransform(projectionTransform(w0));
-        Vec3 v1 = viewportTransform(projectionTransform(w1));
-        Vec3 v2 = viewportTransform(projectionTransform(w2));
-        rasterizePhong(v0, w0, gNormals[i0], v1, w1, gNormals[i1], v2, w2, gNormals[i2]);
+    // -hw2 [scene file] [out.ppm]: HW2 scene with shadow mapping, timed against the
+    // unshadowed pass. The PPM can be diffed against the HW2_Q1 ray traced image.
+    if (hw2) {
+        load_scene_or_default(argc > 2 ? argv[2] : "../scenes/hw2.json", gScene);
+        const int frames = 10;
+        double plain = 0.0, shadowed = 0.0, shadowPass = 0.0;
+        for (int i = 0; i < frames; ++i) plain += renderHW2Frame(false);
+        for (int i = 0; i < frames; ++i) {
+            shadowed += renderHW2Frame(true);
+            shadowPass += gShadowMs;
+        }
+        printf("HW2 scene: %.1f ms with shadows (shadow pass %.2f ms, %dx%d map, %dx%d PCF), %.1f ms without\n",
+            shadowed / frames, shadowPass / frames, kShadowMapSize, kShadowMapSize,
+            2 * kShadowPcfRadius + 1, 2 * kShadowPcfRadius + 1, plain / frames);
+        if (argc > 3) writePPM(argv[3]);
+    }
+
+    if (sweep) {
+        printf("lights | tiled (binning, lights/tile) | all lights\n");
+        const int counts[] = { 1, 16, 64, 256, 1024 };
+        for (int n : counts) {
+            createLights(n);
+            double tiled = renderFrame(true);
+            double tileAvg = (double)gTiles.indices.size() / (gTiles.tilesX * gTiles.tilesY);
+            double binMs = gBinMs;
+            double brute = renderFrame(false);
+            printf("%6d | %8.1f ms (%.2f ms, %.1f) | %8.1f ms\n", n, tiled, binMs, tileAvg, brute);
+        }
+    }
+    if (!hw2) {
+        createLights(lightCount);
+        double ms = renderFrame(true);
+        printf("%d lights: %.1f ms (binning %.2f ms)\n", lightCount, ms, gBinMs);
     }
 
     glutInit(&argc, argv);
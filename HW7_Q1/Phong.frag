@@ -4,25 +4,89 @@ in vec3 Normal;
 
 out vec4 FragColor;
 
-uniform vec3 viewPos;
-uniform vec3 lightPos;
-uniform vec3 ka, kd, ks;
-uniform vec3 Ia, Il;
-uniform float shininess;
+layout(std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec4  viewPos;
+    vec4  Ia;
+    ivec4 lightInfo;     // x: light count, y: tiled, z: tiles per row, w: tile size
+    mat4  lightViewProj; // world -> shadow map clip space of light 0
+    vec4  shadowInfo;    // x: enabled, y: texel size (uv), z: normal offset per unit of light distance
+};
 
-void main() {
-    vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
+layout(std140) uniform ObjectData {
+    mat4 model;
+    mat4 mvp;
+    mat4 normalMatrix;
+    vec4 ka, kd, ks;     // ks.w = shininess
+};
+
+// Point lights: texel 2i = (position, radius), texel 2i+1 = (Il, 0). radius <= 0: no falloff
+uniform samplerBuffer  uLights;
+// Tiled forward+: lights of tile t are uTileIndices[uTileOffsets[t] .. uTileOffsets[t+1])
+uniform usamplerBuffer uTileOffsets;
+uniform usamplerBuffer uTileIndices;
+// Depth of the casters seen from light 0, compared in hardware (GL_LEQUAL, linear filtering)
+uniform sampler2DShadow uShadowMap;
+
+// Fraction of light 0 reaching this fragment: 3x3 taps, each a bilinear 2x2 compare.
+// The lookup position is pushed along the normal by about a texel to avoid acne.
+float shadowVisibility(vec3 norm) {
+    vec3 lightPos = texelFetch(uLights, 0).xyz;
+    vec3 offsetPos = FragPos + norm * shadowInfo.z * length(lightPos - FragPos);
+    vec4 clip = lightViewProj * vec4(offsetPos, 1.0);
+    vec3 coord = clip.xyz / clip.w * 0.5 + 0.5;
+    // beyond the far plane is behind every caster; empty texels hold 1.0 and stay lit
+    coord.z = min(coord.z, 1.0);
+
+    float lit = 0.0;
+    for (int y = -1; y <= 1; ++y)
+        for (int x = -1; x <= 1; ++x)
+            lit += texture(uShadowMap, vec3(coord.xy + vec2(x, y) * shadowInfo.y, coord.z));
+    return lit / 9.0;
+}
+
+vec3 shadeLight(int index, vec3 norm, vec3 viewDir, float shadow) {
+    vec4 posRadius = texelFetch(uLights, 2 * index);
+    vec3 Il = texelFetch(uLights, 2 * index + 1).rgb;
 
+    vec3 toLight = posRadius.xyz - FragPos;
+    float dist = length(toLight);
+    float att = 1.0;
+    if (posRadius.w > 0.0) {
+        float t = min(dist / posRadius.w, 1.0);
+        att = (1.0 - t * t) * (1.0 - t * t);
+    }
+
+    vec3 lightDir = toLight / dist;
+    vec3 reflectDir = reflect(-lightDir, norm);
     float diff = max(dot(norm, lightDir), 0.0);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), ks.w);
+
+    vec3 diffuse = kd.rgb * Il * diff;
+    vec3 specular = ks.rgb * Il * spec;
+    if (index == 0) att *= shadow;
+    return att * (diffuse + specular);
+}
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
 
-    vec3 ambient = ka * Ia;
-    vec3 diffuse = kd * Il * diff;
-    vec3 specular = ks * Il * spec;
+    float shadow = shadowInfo.x != 0.0 ? shadowVisibility(norm) : 1.0;
 
-    vec3 color = ambient + diffuse + specular;
+    vec3 color = ka.rgb * Ia.rgb;
+    if (lightInfo.y != 0) {
+        ivec2 tile = ivec2(gl_FragCoord.xy) / lightInfo.w;
+        int t = tile.y * lightInfo.z + tile.x;
+        int begin = int(texelFetch(uTileOffsets, t).r);
+        int end = int(texelFetch(uTileOffsets, t + 1).r);
+        for (int i = begin; i < end; ++i)
+            color += shadeLight(int(texelFetch(uTileIndices, i).r), norm, viewDir, shadow);
+    }
+    else {
+        for (int i = 0; i < lightInfo.x; ++i)
+            color += shadeLight(i, norm, viewDir, shadow);
+    }
     FragColor = vec4(color, 1.0);
 }
@@ -2,15 +2,18 @@
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout(std140) uniform ObjectData {
+    mat4 model;
+    mat4 mvp;
+    mat4 normalMatrix;   // transpose(inverse(model)), computed once per draw on the CPU
+    vec4 ka, kd, ks;     // ks.w = shininess
+};
 
 out vec3 FragPos;
 out vec3 Normal;
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+    Normal = mat3(normalMatrix) * aNormal;
+    gl_Position = mvp * vec4(aPos, 1.0);
 }
@@ -0,0 +1,30 @@
+#version 330 core
+// Reference path for benchmarking: normal matrix and MVP rebuilt per vertex
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+
+layout(std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec4  viewPos;
+    vec4  Ia;
+    ivec4 lightInfo;     // x: light count, y: tiled, z: tiles per row, w: tile size
+    mat4  lightViewProj; // world -> shadow map clip space of light 0
+    vec4  shadowInfo;    // x: enabled, y: texel size (uv), z: normal offset per unit of light distance
+};
+
+layout(std140) uniform ObjectData {
+    mat4 model;
+    mat4 mvp;
+    mat4 normalMatrix;
+    vec4 ka, kd, ks;
+};
+
+out vec3 FragPos;
+out vec3 Normal;
+
+void main() {
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * aNormal;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
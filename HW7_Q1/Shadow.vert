@@ -0,0 +1,24 @@
+#version 330 core
+// Shadow map pass: casters only, depth from light 0
+layout(location = 0) in vec3 aPos;
+
+layout(std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec4  viewPos;
+    vec4  Ia;
+    ivec4 lightInfo;
+    mat4  lightViewProj;
+    vec4  shadowInfo;
+};
+
+layout(std140) uniform ObjectData {
+    mat4 model;
+    mat4 mvp;
+    mat4 normalMatrix;
+    vec4 ka, kd, ks;
+};
+
+void main() {
+    gl_Position = lightViewProj * model * vec4(aPos, 1.0);
+}
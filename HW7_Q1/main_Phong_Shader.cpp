@@ -1,11 +1,22 @@
 ﻿#pragma comment(lib, "legacy_stdio_definitions.lib")
 #include <iostream>
+#include <stdio.h>
+#include <string.h>
 #include <vector>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <sstream>
+#include <chrono>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include "shader_manager.h"
+#include "light_tiles.h"
+#include "scene_file.h"
 #define WIDTH 512
 #define HEIGHT 512
 
@@ -31,8 +42,7 @@ int* gIndexBuffer;
 std::vector<Vec3> gVertexBuffer;
 std::vector<Vec3> gNormals;
 
-void create_scene() {
-    int width = 32, height = 16;
+void create_scene(int width, int height) {
     gNumVertices = (height - 2) * width + 2;
     gNumTriangles = ((height - 3) * (width - 1) * 2) + 2 * (width - 1);
 
@@ -91,34 +101,94 @@ void create_scene() {
     }
 }
 
-std::string readFile(const char* filename) {
-    std::ifstream file(filename);
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
-}
-
-unsigned int compileShader(unsigned int type, const std::string& source) {
-    unsigned int id = glCreateShader(type);
-    const char* src = source.c_str();
-    glShaderSource(id, 1, &src, nullptr);
-    glCompileShader(id);
-    return id;
-}
-
-unsigned int createShader(const std::string& vertexShader, const std::string& fragmentShader) {
-    unsigned int program = glCreateProgram();
-    unsigned int vs = compileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-    return program;
-}
-
-unsigned int VAO, VBO, NBO, EBO, shaderProgram;
+unsigned int VAO, VBO, NBO, EBO;
+unsigned int gPlaneVAO, gPlaneVBO, gPlaneNBO, gPlaneEBO;
+
+// ----------------------------------------------------------------------------
+// Uniform block (std140, Phong.vert/.frag 와 같은 배치)
+//   FrameData  (binding 0): 카메라, 광원 목록 정보, 그림자 맵 행렬. 프레임마다 한 번
+//   ObjectData (binding 1): 객체마다 model / mvp / 노멀 행렬 / 재질.
+//                           한 버퍼에 정렬 단위로 이어 붙이고 glBindBufferRange 로 고른다
+// 광원 자체는 texture buffer (광원당 texel 2개: 위치+반경, 색) 에 둔다
+// ----------------------------------------------------------------------------
+const GLuint kFrameBinding = 0;
+const GLuint kObjectBinding = 1;
+
+struct FrameUniforms {
+    glm::mat4  view;
+    glm::mat4  projection;
+    glm::vec4  viewPos;
+    glm::vec4  Ia;
+    glm::ivec4 lightInfo;     // x: 광원 수, y: 타일 사용 여부, z: 가로 타일 수, w: 타일 크기
+    glm::mat4  lightViewProj; // 월드 -> 0 번 광원의 그림자 맵 clip 공간
+    glm::vec4  shadowInfo;    // x: 사용 여부, y: texel 크기 (uv), z: 노멀 오프셋 (빛까지 거리 1 당)
+};
+
+struct ObjectUniforms {
+    glm::mat4 model;
+    glm::mat4 mvp;
+    glm::mat4 normalMatrix;   // mat3 은 std140 에서 열마다 vec4 라서 mat4 로 보낸다
+    glm::vec4 ka, kd, ks;     // ks.w = shininess
+};
+
+enum ObjectMesh { MESH_SPHERE, MESH_PLANE };
+
+struct SceneObject {
+    glm::vec3 position;
+    glm::vec3 up;             // 메시의 +y 가 향할 방향 (평면의 법선)
+    float     scale;
+    glm::vec3 ka, kd;
+    glm::vec4 ks;             // w = shininess
+    float     spin;           // 초당 회전 (라디안)
+    ObjectMesh mesh;
+    bool      castsShadow;
+};
+
+std::vector<SceneObject> gObjects;
+unsigned int gFrameUBO, gObjectUBO;
+GLint gObjectStride;          // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 에 맞춘 크기
+std::vector<char> gObjectData;
+
+// 'n' 키로 전환: 노멀 행렬을 CPU 에서 한 번 (Phong.vert) / 정점마다 inverse() (PhongInverse.vert)
+ShaderProgram gPhong, gPhongInverse;
+bool gUseInverse = false;
+
+// 기본 장면은 원래 과제의 구 하나 (0,0,-3) + 광원 (-4,4,-3) 하나, vsync 켬.
+// "-bench": 3x3 회전 구 + 광원 3개, vsync 끔 (GPU 시간 비교용)
+bool gBenchScene = false;
+
+// "-hw2 [장면 파일]": HW2 레이 트레이서와 같은 장면 파일 (기본 ../scenes/hw2.json:
+// 구 3개 + y = -2 평면, 광원 (-4,4,-3) 하나). Ia 는 광원 색의 합 (HW2 의 ka * light_color)
+bool gHW2Scene = false;
+SceneData gScene;
+// 원근 투영의 near/far (HW2 장면은 평면이 지평선까지 보이도록 far 를 늘린다)
+float gNear = 0.1f, gFar = 100.0f;
+
+// ----------------------------------------------------------------------------
+// 그림자 맵 ('s' 로 켜고 끔): 0 번 광원 (-4,4,-3) 위치에서 그림자를 드리우는 물체의
+// 경계 구를 바라보는 원근 투영으로 깊이만 그리고, Phong.frag 에서 sampler2DShadow 로
+// 3x3 PCF (하드웨어 비교 + 선형 필터). 소프트웨어 경로는 common/shadow_map
+// ----------------------------------------------------------------------------
+const int kShadowMapSize = 2048;
+const int kShadowMapUnit = 3;
+ShaderProgram gShadow;
+unsigned int gShadowFBO, gShadowTex;
+bool gShadows = true;
+
+// ----------------------------------------------------------------------------
+// Tiled forward+ ('t' 로 켜고 끔, '+'/'-' 로 추가 광원 수 조절)
+//   depth pre-pass -> 깊이 읽기 -> CPU 에서 16x16 타일별 광원 목록 (common/light_tiles)
+//   -> texture buffer 로 올리고 fragment shader 는 자기 타일의 목록만 돈다
+// ----------------------------------------------------------------------------
+std::vector<TileLight> gLights;
+LightTileGrid gTiles;
+std::vector<float> gDepthPixels, gViewDepth;
+int gExtraLights = 0;
+bool gTiled = true;
+unsigned int gLightBuffer, gTileOffsetBuffer, gTileIndexBuffer;
+unsigned int gLightTex, gTileOffsetTex, gTileIndexTex;
+double gBinMsTotal = 0.0;
+double gLightsPerTileTotal = 0.0;
 
 void setupBuffers() {
     glGenVertexArrays(1, &VAO);
@@ -140,16 +210,444 @@ void setupBuffers() {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(int) * gNumTriangles * 3, gIndexBuffer, GL_STATIC_DRAW);
     glBindVertexArray(0);
+
+    // 평면: y = 0 의 큰 사각형 (HW2 장면에서만 사용)
+    const float e = 1e4f;
+    const Vec3 planePos[4] = { { -e, 0, e }, { e, 0, e }, { e, 0, -e }, { -e, 0, -e } };
+    const Vec3 planeNormal[4] = { { 0, 1, 0 }, { 0, 1, 0 }, { 0, 1, 0 }, { 0, 1, 0 } };
+    const int planeIndex[6] = { 0, 1, 2, 0, 2, 3 };
+    glGenVertexArrays(1, &gPlaneVAO);
+    glGenBuffers(1, &gPlaneVBO);
+    glGenBuffers(1, &gPlaneNBO);
+    glGenBuffers(1, &gPlaneEBO);
+    glBindVertexArray(gPlaneVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, gPlaneVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(planePos), planePos, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, gPlaneNBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(planeNormal), planeNormal, GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vec3), (void*)0);
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gPlaneEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(planeIndex), planeIndex, GL_STATIC_DRAW);
+    glBindVertexArray(0);
+
+    if (gHW2Scene) {
+        // 장면 파일의 구 -> MESH_SPHERE, 평면 -> MESH_PLANE (원점에서 가장 가까운 점으로 이동).
+        // spec_pow = 0 인 재질은 GLSL 의 pow(x, 0) 을 피하려고 shininess 1 (ks = 0 이어야 같은 결과)
+        auto material = [](SceneObject& o, uint32_t id) {
+            const SceneMaterial& m = gScene.materials[id];
+            o.ka = glm::vec3(m.ka[0], m.ka[1], m.ka[2]);
+            o.kd = glm::vec3(m.kd[0], m.kd[1], m.kd[2]);
+            o.ks = glm::vec4(m.ks[0], m.ks[1], m.ks[2], m.specPow > 0.0f ? m.specPow : 1.0f);
+        };
+        const SceneSpheres& spheres = gScene.spheres;
+        for (size_t i = 0; i < spheres.size(); ++i) {
+            SceneObject o;
+            o.position = glm::vec3(spheres.cx[i], spheres.cy[i], spheres.cz[i]);
+            o.up = glm::vec3(0, 1, 0);
+            o.scale = spheres.radius[i];
+            material(o, spheres.material[i]);
+            o.spin = 0.0f;
+            o.mesh = MESH_SPHERE;
+            o.castsShadow = true;
+            gObjects.push_back(o);
+        }
+        for (const ScenePlane& plane : gScene.planes) {
+            SceneObject o;
+            o.up = glm::vec3(plane.normal[0], plane.normal[1], plane.normal[2]);
+            o.position = plane.offset * o.up;
+            o.scale = 1.0f;
+            material(o, plane.material);
+            o.spin = 0.0f;
+            o.mesh = MESH_PLANE;
+            o.castsShadow = false;
+            gObjects.push_back(o);
+        }
+    }
+    else if (gBenchScene) {
+        // 3x3 구 배치, 재질은 kd 만 다르게
+        for (int y = -1; y <= 1; ++y)
+            for (int x = -1; x <= 1; ++x) {
+                SceneObject o;
+                o.position = glm::vec3(x * 2.5f, y * 2.5f, -7.0f);
+                o.up = glm::vec3(0, 1, 0);
+                o.scale = 1.0f;
+                o.ka = glm::vec3(0.1f);
+                o.kd = glm::vec3(0.2f + 0.3f * (x + 1), 0.6f, 0.3f + 0.3f * (y + 1));
+                o.ks = glm::vec4(0.6f, 0.6f, 0.6f, 32.0f);
+                o.spin = 0.3f * (x + 2 * y);
+                o.mesh = MESH_SPHERE;
+                o.castsShadow = true;
+                gObjects.push_back(o);
+            }
+    }
+    else {
+        // 원래 과제의 구 하나
+        SceneObject o;
+        o.position = glm::vec3(0.0f, 0.0f, -3.0f);
+        o.up = glm::vec3(0, 1, 0);
+        o.scale = 1.0f;
+        o.ka = glm::vec3(0.1f);
+        o.kd = glm::vec3(0.2f, 0.6f, 0.3f);
+        o.ks = glm::vec4(0.6f, 0.6f, 0.6f, 32.0f);
+        o.spin = 0.0f;
+        o.mesh = MESH_SPHERE;
+        o.castsShadow = true;
+        gObjects.push_back(o);
+    }
+
+    GLint align = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    gObjectStride = ((GLint)sizeof(ObjectUniforms) + align - 1) / align * align;
+    gObjectData.resize((size_t)gObjectStride * gObjects.size());
+
+    glGenBuffers(1, &gFrameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, gFrameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &gObjectUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, gObjectUBO);
+    glBufferData(GL_UNIFORM_BUFFER, gObjectData.size(), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameBinding, gFrameUBO);
+
+    unsigned int* buffers[] = { &gLightBuffer, &gTileOffsetBuffer, &gTileIndexBuffer };
+    unsigned int* textures[] = { &gLightTex, &gTileOffsetTex, &gTileIndexTex };
+    GLenum formats[] = { GL_RGBA32F, GL_R32UI, GL_R32UI };
+    for (int i = 0; i < 3; ++i) {
+        glGenBuffers(1, buffers[i]);
+        glBindBuffer(GL_TEXTURE_BUFFER, *buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+        glGenTextures(1, textures[i]);
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_BUFFER, *textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, formats[i], *buffers[i]);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    // 그림자 맵: 깊이 텍스처 하나만 붙인 FBO. 맵 밖은 border 1.0 (항상 빛을 받음)
+    const float border[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glGenTextures(1, &gShadowTex);
+    glActiveTexture(GL_TEXTURE0 + kShadowMapUnit);
+    glBindTexture(GL_TEXTURE_2D, gShadowTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, kShadowMapSize, kShadowMapSize, 0,
+        GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glActiveTexture(GL_TEXTURE0);
+
+    glGenFramebuffers(1, &gShadowFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, gShadowFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, gShadowTex, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        printf("ERROR: shadow map framebuffer incomplete, shadows disabled\n");
+        gShadows = false;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// 장면의 광원 (감쇠 없음, 기본 1개 / -bench 3개) + 구 주위를 도는 작은 점광원 gExtraLights 개
+// 0 번 광원 (기본 (-4,4,-3)) 만 그림자 맵을 가진다. HW2 장면은 장면 파일의 광원
+void updateLights(float time) {
+    gLights.clear();
+    if (gHW2Scene) {
+        for (const SceneLight& l : gScene.lights)
+            gLights.push_back({ l.position[0], l.position[1], l.position[2], l.radius,
+                l.color[0], l.color[1], l.color[2], 0.0f });
+    }
+    else {
+        gLights.push_back({ -4.0f, 4.0f, -3.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f });
+        if (gBenchScene) {
+            gLights.push_back({ 6.0f, -2.0f, -4.0f, 0.0f, 0.3f, 0.3f, 0.5f, 0.0f });
+            gLights.push_back({ 0.0f, -6.0f, -8.0f, 0.0f, 0.4f, 0.2f, 0.1f, 0.0f });
+        }
+    }
+    for (int i = 0; i < gExtraLights; ++i) {
+        // 고정된 해시로 궤도/색을 정해서 실행마다 같은 배치
+        unsigned int h = (unsigned int)i * 2654435761u;
+        float a = (h & 0xffff) / 65536.0f * 6.2831853f + time * (0.2f + (h >> 28) * 0.05f);
+        float ring = 1.3f + ((h >> 16) & 0xff) / 255.0f * 3.5f;
+        float height = (((h >> 8) & 0xff) / 255.0f - 0.5f) * 6.0f;
+        TileLight l;
+        l.x = ring * cosf(a);
+        l.y = height;
+        l.z = -7.0f + ring * sinf(a);
+        l.radius = 1.5f;
+        l.r = 0.3f + 0.7f * ((h >> 4) & 1);
+        l.g = 0.3f + 0.7f * ((h >> 5) & 1);
+        l.b = 0.3f + 0.7f * ((h >> 6) & 1);
+        l.pad = 0.0f;
+        gLights.push_back(l);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, gLightBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, gLights.size() * sizeof(TileLight), gLights.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+// 프로그램 객체가 바뀔 때마다 (시작, hot reload) 블록 binding 과 샘플러 유닛을 다시 지정
+void setBlockBindings(ShaderProgram& p) {
+    GLuint frame = glGetUniformBlockIndex(p.id, "FrameData");
+    GLuint object = glGetUniformBlockIndex(p.id, "ObjectData");
+    if (frame != GL_INVALID_INDEX) glUniformBlockBinding(p.id, frame, kFrameBinding);
+    if (object != GL_INVALID_INDEX) glUniformBlockBinding(p.id, object, kObjectBinding);
+}
+
+void setUniforms(ShaderProgram& p) {
+    setBlockBindings(p);
+    glUseProgram(p.id);
+    glUniform1i(uniform_location(p, "uLights"), 0);
+    glUniform1i(uniform_location(p, "uTileOffsets"), 1);
+    glUniform1i(uniform_location(p, "uTileIndices"), 2);
+    glUniform1i(uniform_location(p, "uShadowMap"), kShadowMapUnit);
+}
+
+// 메시의 +y 축을 up 으로 돌리는 회전 (up 이 +y 면 단위 행렬)
+glm::mat4 alignY(const glm::vec3& up) {
+    glm::vec3 y = glm::normalize(up);
+    glm::vec3 x = fabsf(y.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 0, 1);
+    glm::vec3 z = glm::normalize(glm::cross(x, y));
+    x = glm::cross(y, z);
+    return glm::mat4(glm::vec4(x, 0), glm::vec4(y, 0), glm::vec4(z, 0), glm::vec4(0, 0, 0, 1));
+}
+
+// ----------------------------------------------------------------------------
+// 프레임/객체 uniform 갱신: 행렬 곱과 역행렬은 여기서 객체마다 한 번
+// ----------------------------------------------------------------------------
+void updateUniforms(float time, int tilesX) {
+    FrameUniforms frame = {};
+    frame.view = glm::mat4(1.0f);
+    frame.projection = glm::mat4(
+        1.0f, 0, 0, 0,
+        0, 1.0f, 0, 0,
+        0, 0, -(gFar + gNear) / (gFar - gNear), -1,
+        0, 0, -2.0f * gFar * gNear / (gFar - gNear), 0);
+    frame.viewPos = glm::vec4(0, 0, 0, 1);
+    frame.Ia = glm::vec4(0.2f, 0.2f, 0.2f, 1);
+    if (gHW2Scene) {
+        frame.Ia = glm::vec4(0, 0, 0, 1);
+        for (const SceneLight& l : gScene.lights)
+            frame.Ia += glm::vec4(l.color[0], l.color[1], l.color[2], 0);
+    }
+    frame.lightInfo = glm::ivec4((int)gLights.size(), gTiled ? 1 : 0, tilesX, kLightTileSize);
+
+    // 그림자 맵 투영: caster 경계 구에 접하는 원뿔 (sin(fov/2) = r / d)
+    glm::vec3 lo(1e30f), hi(-1e30f);
+    glm::vec3 lightPos = gLights.empty() ? glm::vec3(-4, 4, -3) : glm::vec3(gLights[0].x, gLights[0].y, gLights[0].z);
+    for (const SceneObject& o : gObjects)
+        if (o.castsShadow) {
+            lo = glm::min(lo, o.position - glm::vec3(o.scale));
+            hi = glm::max(hi, o.position + glm::vec3(o.scale));
+        }
+    glm::vec3 center = 0.5f * (lo + hi);
+    float radius = 0.0f;
+    for (const SceneObject& o : gObjects)
+        if (o.castsShadow) radius = std::max(radius, glm::length(o.position - center) + o.scale);
+    float dist = glm::length(center - lightPos);
+    float sinHalf = std::min(radius / dist, 0.7071f);
+    float tanHalf = sinHalf / sqrtf(1.0f - sinHalf * sinHalf);
+    float nearPlane = std::max(dist - radius, 0.01f * dist);
+    frame.lightViewProj = glm::perspective(2.0f * asinf(sinHalf), 1.0f, nearPlane, dist + radius)
+        * glm::lookAt(lightPos, center, glm::vec3(0, 1, 0));
+    frame.shadowInfo = glm::vec4(gShadows ? 1.0f : 0.0f, 1.0f / kShadowMapSize,
+        1.5f * 2.0f * tanHalf / kShadowMapSize, 0);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, gFrameUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frame);
+
+    glm::mat4 viewProj = frame.projection * frame.view;
+    for (size_t i = 0; i < gObjects.size(); ++i) {
+        const SceneObject& o = gObjects[i];
+        ObjectUniforms* u = (ObjectUniforms*)&gObjectData[i * gObjectStride];
+        u->model = glm::translate(glm::mat4(1.0f), o.position) * alignY(o.up);
+        u->model = glm::rotate(u->model, o.spin * time, glm::vec3(0.0f, 1.0f, 0.0f));
+        u->model = glm::scale(u->model, glm::vec3(o.scale));
+        u->mvp = viewProj * u->model;
+        u->normalMatrix = glm::mat4(glm::inverseTranspose(glm::mat3(u->model)));
+        u->ka = glm::vec4(o.ka, 0);
+        u->kd = glm::vec4(o.kd, 0);
+        u->ks = o.ks;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, gObjectUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, gObjectData.size(), gObjectData.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void drawObjects(bool castersOnly = false) {
+    for (size_t i = 0; i < gObjects.size(); ++i) {
+        const SceneObject& o = gObjects[i];
+        if (castersOnly && !o.castsShadow) continue;
+        glBindBufferRange(GL_UNIFORM_BUFFER, kObjectBinding, gObjectUBO,
+            (GLintptr)(i * gObjectStride), sizeof(ObjectUniforms));
+        if (o.mesh == MESH_PLANE) {
+            glBindVertexArray(gPlaneVAO);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        }
+        else {
+            glBindVertexArray(VAO);
+            glDrawElements(GL_TRIANGLES, gNumTriangles * 3, GL_UNSIGNED_INT, 0);
+        }
+    }
+}
+
+// 그림자 패스: caster 만 빛 시점 깊이로 그린다 (기울기 비례 polygon offset 으로 acne 방지)
+void shadowPass(int width, int height) {
+    glBindFramebuffer(GL_FRAMEBUFFER, gShadowFBO);
+    glViewport(0, 0, kShadowMapSize, kShadowMapSize);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+    glUseProgram(gShadow.id);
+    drawObjects(true);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+}
+
+// depth pre-pass 후 깊이를 읽어 타일별 광원 목록을 만든다.
+// 순서: updateUniforms (pre-pass 가 쓰는 행렬) -> depth pre-pass -> 타일 컬링 -> 조명 패스 (render)
+void depthPrepassAndBin(int width, int height) {
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glUseProgram(gUseInverse ? gPhongInverse.id : gPhong.id);
+    drawObjects();
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    gDepthPixels.resize((size_t)width * height);
+    gViewDepth.resize((size_t)width * height);
+    glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, gDepthPixels.data());
+
+    // 깊이 [0,1] -> 시점 거리: z_view = -B / (z_ndc + A), A = proj[2][2], B = proj[3][2]
+    const float A = -(gFar + gNear) / (gFar - gNear), B = -2.0f * gFar * gNear / (gFar - gNear);
+    for (size_t i = 0; i < gDepthPixels.size(); ++i) {
+        float d = gDepthPixels[i];
+        gViewDepth[i] = d >= 1.0f ? 0.0f : B / (2.0f * d - 1.0f + A);
+    }
+    LightTileCamera camera = { 1.0f, 1.0f, gNear, false };   // glReadPixels 는 아래 줄부터
+    bin_lights(gTiles, width, height, camera, gViewDepth.data(), gLights.data(), (int)gLights.size());
+
+    glBindBuffer(GL_TEXTURE_BUFFER, gTileOffsetBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, gTiles.offsets.size() * sizeof(uint32_t), gTiles.offsets.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, gTileIndexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(1, gTiles.indices.size()) * sizeof(uint32_t),
+        gTiles.indices.empty() ? nullptr : gTiles.indices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    gBinMsTotal += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+    gLightsPerTileTotal += (double)gTiles.indices.size() / (gTiles.tilesX * gTiles.tilesY);
 }
 
+// 색 패스: tiled 이면 pre-pass 깊이를 그대로 쓰고 (GL_LEQUAL, 쓰기 없음) 보이는 조각만 셰이딩
 void render() {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glUseProgram(shaderProgram);
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, gNumTriangles * 3, GL_UNSIGNED_INT, 0);
+    glClear(gTiled ? GL_COLOR_BUFFER_BIT : GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDepthFunc(gTiled ? GL_LEQUAL : GL_LESS);
+    glDepthMask(gTiled ? GL_FALSE : GL_TRUE);
+    glUseProgram(gUseInverse ? gPhongInverse.id : gPhong.id);
+    drawObjects();
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
 }
 
-int main() {
+// ----------------------------------------------------------------------------
+// GPU 시간 측정 (GL_TIME_ELAPSED, 몇 프레임 뒤에 읽어서 멈추지 않게)
+// ----------------------------------------------------------------------------
+const int kQueryLatency = 4;
+unsigned int gQueries[kQueryLatency];
+bool gQueryPending[kQueryLatency];
+int gQueryIndex = 0;
+double gGpuMsTotal = 0.0;
+int gGpuSamples = 0;
+double gFrameMsTotal = 0.0;
+int gFrames = 0;
+
+void collectQueries(bool wait) {
+    for (int i = 0; i < kQueryLatency; ++i) {
+        if (!gQueryPending[i]) continue;
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(gQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available && !wait) continue;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(gQueries[i], GL_QUERY_RESULT, &ns);
+        gGpuMsTotal += ns * 1e-6;
+        gGpuSamples++;
+        gQueryPending[i] = false;
+    }
+}
+
+// 현재 경로의 평균 GPU 시간을 출력하고 초기화
+void reportTiming() {
+    collectQueries(true);
+    if (gGpuSamples == 0 || gFrames == 0) return;
+    double ms = gGpuMsTotal / gGpuSamples;
+    printf("[%s, %s, %s] %d objects x %d verts, %d lights: frame %.3f ms, shadow+shading GPU %.3f ms",
+        gUseInverse ? "per-vertex inverse()" : "per-draw normal matrix",
+        gTiled ? "tiled" : "all lights", gShadows ? "shadow map" : "no shadows",
+        (int)gObjects.size(), gNumVertices, (int)gLights.size(), gFrameMsTotal / gFrames, ms);
+    if (gTiled)
+        printf(", readback+binning %.3f ms, %.1f lights/tile", gBinMsTotal / gFrames, gLightsPerTileTotal / gFrames);
+    printf(" (%d frames)\n", gFrames);
+    gGpuMsTotal = 0.0;
+    gGpuSamples = 0;
+    gFrameMsTotal = gBinMsTotal = gLightsPerTileTotal = 0.0;
+    gFrames = 0;
+}
+
+void keyCallback(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_PRESS) return;
+    switch (key) {
+    case GLFW_KEY_N:
+        reportTiming();
+        gUseInverse = !gUseInverse;
+        break;
+    case GLFW_KEY_T:
+        reportTiming();
+        gTiled = !gTiled;
+        break;
+    case GLFW_KEY_S:
+        reportTiming();
+        gShadows = !gShadows;
+        break;
+    case GLFW_KEY_EQUAL: case GLFW_KEY_KP_ADD:
+        reportTiming();
+        gExtraLights = gExtraLights == 0 ? 16 : std::min(gExtraLights * 2, 4096);
+        break;
+    case GLFW_KEY_MINUS: case GLFW_KEY_KP_SUBTRACT:
+        reportTiming();
+        gExtraLights = gExtraLights <= 16 ? 0 : gExtraLights / 2;
+        break;
+    }
+}
+
+int main(int argc, char** argv) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    // "-bench" : 3x3 구 + 광원 3개, vsync 끔 (GPU 시간 비교용)
+    // "-dense" : 벤치마크용 고밀도 구 (1024 x 512 분할, 약 100만 삼각형). -bench 와 같이 쓸 수 있다
+    // "-hw2 [장면 파일]" : HW2_Q1 과 같은 장면 (결과 이미지와 그림자 비교용)
+    bool dense = false;
+    const char* sceneFile = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-bench") == 0)
+            gBenchScene = true;
+        else if (strcmp(argv[i], "-dense") == 0)
+            dense = true;
+        else if (strcmp(argv[i], "-hw2") == 0) {
+            gHW2Scene = true;
+            sceneFile = i + 1 < argc && argv[i + 1][0] != '-' ? argv[++i] : "../scenes/hw2.json";
+        }
+    }
+    if (gHW2Scene) {
+        load_scene_or_default(sceneFile, gScene);
+        gFar = 10000.0f;
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -157,103 +655,81 @@ int main() {
     GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Phong Shading", nullptr, nullptr);
     glfwMakeContextCurrent(window);
     gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+    glfwSwapInterval(gBenchScene ? 0 : 1);
+    glfwSetKeyCallback(window, keyCallback);
     glEnable(GL_DEPTH_TEST);
 
-    create_scene();
-    std::string vertexCode = readFile("Phong.vert");
-    std::string fragmentCode = readFile("Phong.frag");
-    shaderProgram = createShader(vertexCode, fragmentCode);
+    if (dense) create_scene(1024, 512);
+    else create_scene(32, 16);
+    if (!load_program(gPhong, "Phong.vert", "Phong.frag")
+        || !load_program(gPhongInverse, "PhongInverse.vert", "Phong.frag")
+        || !load_program(gShadow, "Shadow.vert", "Shadow.frag")) {
+        glfwTerminate();
+        return -1;
+    }
     setupBuffers();
-
-    glUseProgram(shaderProgram);
-    float model[16] = {
-        1,0,0,0,
-        0,1,0,0,
-        0,0,1,0,
-        0,0,-3,1
-    };
-    float view[16] = {
-        1,0,0,0,
-        0,1,0,0,
-        0,0,1,0,
-        0,0,0,1
-    };
-    float proj[16] = {
-        1.0f,0,0,0,
-        0,1.0f,0,0,
-        0,0,-1.002,-1,
-        0,0,-0.2002,0
-    };
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, model);
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, view);
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, proj);
-
-    glUniform3f(glGetUniformLocation(shaderProgram, "lightPos"), -4.0f, 4.0f, -3.0f);
-    glUniform3f(glGetUniformLocation(shaderProgram, "viewPos"), 0.0f, 0.0f, 0.0f);
-    glUniform3f(glGetUniformLocation(shaderProgram, "ka"), 0.1f, 0.1f, 0.1f);
-    glUniform3f(glGetUniformLocation(shaderProgram, "kd"), 0.2f, 0.6f, 0.3f);
-    glUniform3f(glGetUniformLocation(shaderProgram, "ks"), 0.6f, 0.6f, 0.6f);
-    glUniform3f(glGetUniformLocation(shaderProgram, "Ia"), 0.2f, 0.2f, 0.2f);
-    glUniform3f(glGetUniformLocation(shaderProgram, "Il"), 1.0f, 1.0f, 1.0f);
-    glUniform1f(glGetUniformLocation(shaderProgram, "shininess"), 32.0f);
-
+    setUniforms(gPhong);
+    setUniforms(gPhongInverse);
+    setBlockBindings(gShadow);
+    glGenQueries(kQueryLatency, gQueries);
+
+    bool firstFrame = true;
+    double lastReloadCheck = glfwGetTime();
+    double lastReport = glfwGetTime();
+    auto lastFrame = std::chrono::high_resolution_clock::now();
     while (!glfwWindowShouldClose(window)) {
+        float time = (float)glfwGetTime();
+        int fbWidth, fbHeight;
+        glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+
+        updateLights(time);
+        updateUniforms(time, (fbWidth + kLightTileSize - 1) / kLightTileSize);
+        if (gTiled)
+            depthPrepassAndBin(fbWidth, fbHeight);
+
+        glBeginQuery(GL_TIME_ELAPSED, gQueries[gQueryIndex]);
+        if (gShadows)
+            shadowPass(fbWidth, fbHeight);
         render();
+        glEndQuery(GL_TIME_ELAPSED);
+        gQueryPending[gQueryIndex] = true;
+        gQueryIndex = (gQueryIndex + 1) % kQueryLatency;
+        if (gQueryPending[gQueryIndex]) collectQueries(false);
+
         glfwSwapBuffers(window);
         glfwPollEvents();
-    }
-    glfwTerminate();
-    return 0;
-}
-
-// Phong.vert
-/*
-#version 330 core
-layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-out vec3 FragPos;
-out vec3 Normal;
-
-void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    gl_Position = projection * view * vec4(FragPos, 1.0);
-}
-*/
 
-// Phong.frag
-/*
-#version 330 core
-in vec3 FragPos;
-in vec3 Normal;
-
-out vec4 FragColor;
-
-uniform vec3 viewPos;
-uniform vec3 lightPos;
-uniform vec3 ka, kd, ks;
-uniform vec3 Ia, Il;
-uniform float shininess;
-
-void main() {
-    vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
-
-    float diff = max(dot(norm, lightDir), 0.0);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+        auto now = std::chrono::high_resolution_clock::now();
+        gFrameMsTotal += std::chrono::duration<double, std::milli>(now - lastFrame).count();
+        gFrames++;
+        lastFrame = now;
+
+        // 시작 시간: 셰이더가 바이너리 캐시에서 왔는지(warm) 컴파일했는지(cold) 함께 출력
+        if (firstFrame) {
+            double ms = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - startTime).count();
+            printf("Startup to first frame: %.1f ms (%s start, shaders %.3f ms)\n",
+                ms, gPhong.fromBinaryCache ? "warm" : "cold", gPhong.loadMs + gPhongInverse.loadMs + gShadow.loadMs);
+            firstFrame = false;
+        }
 
-    vec3 ambient = ka * Ia;
-    vec3 diffuse = kd * Il * diff;
-    vec3 specular = ks * Il * spec;
+        // 2초마다 GPU 시간 출력 ('n' 으로 경로 전환)
+        if (glfwGetTime() - lastReport > 2.0) {
+            lastReport = glfwGetTime();
+            reportTiming();
+        }
 
-    vec3 color = ambient + diffuse + specular;
-    FragColor = vec4(color, 1.0);
+        // 셰이더 파일 변경 감시 (0.25초마다)
+        if (glfwGetTime() - lastReloadCheck > 0.25) {
+            lastReloadCheck = glfwGetTime();
+            if (reload_if_changed(gPhong))
+                setUniforms(gPhong);
+            if (reload_if_changed(gPhongInverse))
+                setUniforms(gPhongInverse);
+            if (reload_if_changed(gShadow))
+                setBlockBindings(gShadow);
+        }
+    }
+    glfwTerminate();
+    return 0;
 }
-*/
@@ -0,0 +1,250 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include "shader_manager.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+// 캐시 파일 헤더
+struct ProgramBinaryHeader {
+    uint32_t magic;
+    uint32_t format;
+    uint64_t hash;
+    uint32_t length;
+    uint32_t reserved;
+};
+static const uint32_t kBinaryMagic = 0x4e494250;   // "PBIN"
+
+// ----------------------------------------------------------------------------
+// 파일 / 해시 유틸
+// ----------------------------------------------------------------------------
+static bool readFile(const char* filename, std::string& out) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        printf("ERROR: cannot open %s\n", filename);
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    out = buffer.str();
+    return true;
+}
+
+static time_t file_mtime(const std::string& filename) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) return 0;
+    return st.st_mtime;
+}
+
+static void fnv1a(uint64_t& h, const char* s, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        h ^= (unsigned char)s[i];
+        h *= 0x100000001b3ull;
+    }
+    h ^= 0xff; h *= 0x100000001b3ull;   // 구분자
+}
+
+// 소스가 같아도 드라이버가 바뀌면 바이너리는 쓸 수 없으므로 드라이버 문자열도 넣는다
+static uint64_t source_hash(const std::string& vs, const std::string& fs) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    fnv1a(h, vs.data(), vs.size());
+    fnv1a(h, fs.data(), fs.size());
+    const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for (GLenum n : names) {
+        const char* s = (const char*)glGetString(n);
+        if (s) fnv1a(h, s, strlen(s));
+    }
+    return h;
+}
+
+static bool binary_supported() {
+    if (!GLAD_GL_VERSION_4_1 || !glGetProgramBinary || !glProgramBinary) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+static std::string cache_file(const ShaderProgram& p) {
+    return p.vertexFile + ".bin";
+}
+
+// ----------------------------------------------------------------------------
+// 컴파일 / 링크 (오류 로그 출력)
+// ----------------------------------------------------------------------------
+static GLuint compileShader(GLenum type, const std::string& source, const char* name) {
+    GLuint id = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(id, 1, &src, nullptr);
+    glCompileShader(id);
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        GLint len = 0;
+        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &len);
+        std::vector<char> log(len + 1, 0);
+        glGetShaderInfoLog(id, len, nullptr, log.data());
+        printf("ERROR: %s compile failed\n%s\n", name, log.data());
+        glDeleteShader(id);
+        return 0;
+    }
+    return id;
+}
+
+static bool check_link(GLuint program, const char* name) {
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (ok) return true;
+    GLint len = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &len);
+    std::vector<char> log(len + 1, 0);
+    glGetProgramInfoLog(program, len, nullptr, log.data());
+    printf("ERROR: %s link failed\n%s\n", name, log.data());
+    return false;
+}
+
+static GLuint createShader(const std::string& vertexShader, const std::string& fragmentShader,
+                           const ShaderProgram& p, bool retrievable) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShader, p.vertexFile.c_str());
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader, p.fragmentFile.c_str());
+    if (!vs || !fs) {
+        if (vs) glDeleteShader(vs);
+        if (fs) glDeleteShader(fs);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    if (retrievable)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    if (!check_link(program, p.vertexFile.c_str())) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// ----------------------------------------------------------------------------
+// 바이너리 캐시
+// ----------------------------------------------------------------------------
+static GLuint load_binary(const ShaderProgram& p, uint64_t hash) {
+    FILE* f = fopen(cache_file(p).c_str(), "rb");
+    if (!f) return 0;
+    ProgramBinaryHeader h;
+    std::vector<char> data;
+    bool ok = fread(&h, sizeof(h), 1, f) == 1 && h.magic == kBinaryMagic && h.hash == hash;
+    if (ok) {
+        data.resize(h.length);
+        ok = fread(data.data(), 1, h.length, f) == h.length;
+    }
+    fclose(f);
+    if (!ok) return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, h.format, data.data(), (GLsizei)h.length);
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // 드라이버가 거부하면 (업데이트 등) 조용히 소스에서 다시 빌드
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+static void save_binary(const ShaderProgram& p, GLuint program, uint64_t hash) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> data(length);
+    ProgramBinaryHeader h = { kBinaryMagic, 0, hash, 0, 0 };
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, data.data());
+    h.format = format;
+    h.length = (uint32_t)length;
+
+    FILE* f = fopen(cache_file(p).c_str(), "wb");
+    if (!f) return;
+    fwrite(&h, sizeof(h), 1, f);
+    fwrite(data.data(), 1, data.size(), f);
+    fclose(f);
+}
+
+// ----------------------------------------------------------------------------
+// 빌드: 캐시 -> 소스 순서로 시도. 실패하면 p 는 그대로 둔다
+// ----------------------------------------------------------------------------
+static bool build(ShaderProgram& p) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+
+    std::string vs, fs;
+    p.vertexMtime = file_mtime(p.vertexFile);
+    p.fragmentMtime = file_mtime(p.fragmentFile);
+    if (!readFile(p.vertexFile.c_str(), vs) || !readFile(p.fragmentFile.c_str(), fs))
+        return false;
+
+    bool useBinary = binary_supported();
+    uint64_t hash = source_hash(vs, fs);
+    bool fromCache = false;
+    GLuint program = useBinary ? load_binary(p, hash) : 0;
+    if (program) {
+        fromCache = true;
+    }
+    else {
+        program = createShader(vs, fs, p, useBinary);
+        if (!program) return false;
+        if (useBinary) save_binary(p, program, hash);
+    }
+
+    if (p.id) glDeleteProgram(p.id);
+    p.id = program;
+    p.sourceHash = hash;
+    p.fromBinaryCache = fromCache;
+    p.uniforms.clear();
+    p.loadMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - t0).count();
+
+    printf("[Shader] %s + %s: %.3f ms (%s)\n", p.vertexFile.c_str(), p.fragmentFile.c_str(), p.loadMs,
+        fromCache ? "binary cache" : useBinary ? "compiled, cache written" : "compiled, no binary support");
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// 공개 함수
+// ----------------------------------------------------------------------------
+bool load_program(ShaderProgram& p, const char* vertexFile, const char* fragmentFile) {
+    p.vertexFile = vertexFile;
+    p.fragmentFile = fragmentFile;
+    return build(p);
+}
+
+GLint uniform_location(ShaderProgram& p, const char* name) {
+    auto it = p.uniforms.find(name);
+    if (it != p.uniforms.end()) return it->second;
+    GLint loc = glGetUniformLocation(p.id, name);
+    if (loc < 0) printf("WARNING: uniform %s not found in %s\n", name, p.vertexFile.c_str());
+    p.uniforms.emplace(name, loc);
+    return loc;
+}
+
+bool reload_if_changed(ShaderProgram& p) {
+    time_t vm = file_mtime(p.vertexFile);
+    time_t fm = file_mtime(p.fragmentFile);
+    if (vm == p.vertexMtime && fm == p.fragmentMtime) return false;
+
+    printf("[Shader] %s changed, reloading\n", vm != p.vertexMtime ? p.vertexFile.c_str() : p.fragmentFile.c_str());
+    if (build(p)) return true;
+
+    // 실패: 이전 프로그램을 계속 쓰고, 다음 저장 때 다시 시도
+    p.vertexMtime = vm;
+    p.fragmentMtime = fm;
+    return false;
+}
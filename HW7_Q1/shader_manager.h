@@ -0,0 +1,30 @@
+﻿#pragma once
+#include <string>
+#include <unordered_map>
+#include <time.h>
+#include <glad/glad.h>
+
+// ----------------------------------------------------------------------------
+// 셰이더 프로그램 관리
+//   - 컴파일/링크 오류를 로그와 함께 출력
+//   - uniform 위치를 프로그램마다 캐시 (문자열 조회는 처음 한 번만)
+//   - 링크된 프로그램을 glGetProgramBinary 로 "<vertex 파일>.bin" 에 저장하고,
+//     소스 + 드라이버 문자열 해시가 같으면 다음 실행에서 컴파일 없이 읽는다
+//   - 소스 파일 수정 시각이 바뀌면 다시 빌드 (실패하면 이전 프로그램 유지)
+// ----------------------------------------------------------------------------
+struct ShaderProgram {
+    GLuint             id = 0;
+    std::string        vertexFile, fragmentFile;
+    time_t             vertexMtime = 0, fragmentMtime = 0;
+    unsigned long long sourceHash = 0;
+    bool               fromBinaryCache = false;
+    double             loadMs = 0.0;   // 마지막 load/reload 에 걸린 시간
+    std::unordered_map<std::string, GLint> uniforms;
+};
+
+bool  load_program(ShaderProgram& p, const char* vertexFile, const char* fragmentFile);
+GLint uniform_location(ShaderProgram& p, const char* name);
+
+// 파일이 바뀌었으면 다시 빌드한다. 새 프로그램으로 교체했으면 true
+// (uniform 값은 프로그램 객체에 속하므로 호출한 쪽에서 다시 설정해야 한다)
+bool  reload_if_changed(ShaderProgram& p);
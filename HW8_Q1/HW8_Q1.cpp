@@ -5,6 +5,7 @@
 #include <vector>
 #include <fstream>
 #include <algorithm> // For std::min/max
+#include <chrono>
 
 #include <GL/glew.h>
 #include <GL/glut.h>
@@ -31,9 +32,34 @@ std::vector<Vector3>    gNormals;
 std::vector<Triangle>   gTriangles;
 
 // frame_timer.cpp   
-float  gTotalTimeElapsed = 0;
-int    gTotalFrames = 0;
-GLuint gTimer;
+//   ٸ ʵ kTimerLatency ¥  ְ   ڿ д´
+const int kTimerLatency = 4;
+const int kTimerWindow = 256;
+
+struct FrameQueries
+{
+    GLuint elapsed;     // GL_TIME_ELAPSED (׸ н)
+    GLuint frameBegin;  // GL_TIMESTAMP
+    GLuint frameEnd;    // GL_TIMESTAMP
+    bool   pending;
+};
+
+struct TimerStats
+{
+    double mean, p50, p95, p99; // ms
+    int    count;
+};
+
+FrameQueries gFrames[kTimerLatency];
+int          gCurrentFrame = 0;
+int          gDroppedFrames = 0;
+
+// ֱ kTimerWindow   (ms)
+std::vector<double> gCpuFrameSamples;
+std::vector<double> gGpuFrameSamples;
+std::vector<double> gGpuDrawSamples;
+bool gHasFrameStart = false;
+std::chrono::high_resolution_clock::time_point gLastFrameStart;
 
 // ----------------------------------------------------------------------------
 // load_mesh.cpp Լ
@@ -150,29 +176,101 @@ void load_mesh(std::string fileName)
 // ----------------------------------------------------------------------------
 // frame_timer.cpp Լ
 // ----------------------------------------------------------------------------
+void add_sample(std::vector<double>& samples, double value)
+{
+    if (samples.size() == kTimerWindow)
+        samples.erase(samples.begin());
+    samples.push_back(value);
+}
+
+TimerStats compute_stats(const std::vector<double>& samples)
+{
+    TimerStats stats = { 0, 0, 0, 0, (int)samples.size() };
+    if (samples.empty())
+        return stats;
+
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); ++i)
+        stats.mean += sorted[i];
+    stats.mean /= sorted.size();
+    stats.p50 = sorted[std::min(sorted.size() - 1, (size_t)(0.50 * sorted.size()))];
+    stats.p95 = sorted[std::min(sorted.size() - 1, (size_t)(0.95 * sorted.size()))];
+    stats.p99 = sorted[std::min(sorted.size() - 1, (size_t)(0.99 * sorted.size()))];
+    return stats;
+}
+
 void init_timer()
 {
-    glGenQueries(1, &gTimer);
+    for (int i = 0; i < kTimerLatency; ++i)
+    {
+        glGenQueries(1, &gFrames[i].elapsed);
+        glGenQueries(1, &gFrames[i].frameBegin);
+        glGenQueries(1, &gFrames[i].frameEnd);
+        gFrames[i].pending = false;
+    }
+}
+
+//  غ Ӹ 64bit  д´. غ ʾ false
+bool collect_frame(FrameQueries& frame)
+{
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.frameEnd, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE)
+        return false;
+
+    GLuint64 begin = 0, end = 0, elapsed = 0;
+    glGetQueryObjectui64v(frame.frameBegin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(frame.frameEnd, GL_QUERY_RESULT, &end);
+    glGetQueryObjectui64v(frame.elapsed, GL_QUERY_RESULT, &elapsed);
+    add_sample(gGpuFrameSamples, (end - begin) / 1000000.0); // ʸ ms  ȯ
+    add_sample(gGpuDrawSamples, elapsed / 1000000.0);
+    frame.pending = false;
+    return true;
+}
+
+void begin_frame()
+{
+    std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+    if (gHasFrameStart)
+        add_sample(gCpuFrameSamples, std::chrono::duration<double, std::milli>(now - gLastFrameStart).count());
+    gLastFrameStart = now;
+    gHasFrameStart = true;
+
+    //    Ҵµ   ٸ ʰ 
+    FrameQueries& frame = gFrames[gCurrentFrame];
+    if (frame.pending && !collect_frame(frame))
+    {
+        gDroppedFrames++;
+        frame.pending = false;
+    }
+    glQueryCounter(frame.frameBegin, GL_TIMESTAMP);
 }
 
 void start_timing()
 {
-    glBeginQuery(GL_TIME_ELAPSED, gTimer);
+    glBeginQuery(GL_TIME_ELAPSED, gFrames[gCurrentFrame].elapsed);
 }
 
-float stop_timing()
+void stop_timing()
 {
     glEndQuery(GL_TIME_ELAPSED);
+}
 
-    GLint available = GL_FALSE;
-    while (available == GL_FALSE)
-        glGetQueryObjectiv(gTimer, GL_QUERY_RESULT_AVAILABLE, &available);
-
-    GLint result;
-    glGetQueryObjectiv(gTimer, GL_QUERY_RESULT, &result);
+void end_frame()
+{
+    FrameQueries& frame = gFrames[gCurrentFrame];
+    glQueryCounter(frame.frameEnd, GL_TIMESTAMP);
+    frame.pending = true;
+    gCurrentFrame = (gCurrentFrame + 1) % kTimerLatency;
 
-    float timeElapsed = result / 1000000000.0f; // ʸ ʷ ȯ
-    return timeElapsed;
+    // ̹   ӵ   
+    for (int i = 0; i < kTimerLatency; ++i)
+    {
+        FrameQueries& old = gFrames[(gCurrentFrame + i) % kTimerLatency];
+        if (old.pending && !collect_frame(old))
+            break;
+    }
 }
 
 // ----------------------------------------------------------------------------
@@ -218,6 +316,8 @@ void init_gl()
 // ----------------------------------------------------------------------------
 void display()
 {
+    begin_frame();
+
     // ȭ   ʱȭ
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -258,15 +358,19 @@ void display()
     }
     glEnd();
 
-    // ---  ð    FPS  ---
-    float timeElapsed = stop_timing();
-    gTotalFrames++;
-    gTotalTimeElapsed += timeElapsed;
-    if (gTotalTimeElapsed > 0) // 0   
+    // ---  ð      ---
+    stop_timing();
+    end_frame();
+
+    //    ʰ ϹǷ   p50/p95/p99  ǥ
+    TimerStats cpu = compute_stats(gCpuFrameSamples);
+    TimerStats draw = compute_stats(gGpuDrawSamples);
+    if (cpu.count > 0)
     {
-        float fps = gTotalFrames / gTotalTimeElapsed;
+        float fps = (float)(1000.0 / cpu.p50);
         char string[1024] = { 0 };
-        sprintf(string, "Q1: Immediate Mode | OpenGL Bunny: %.2f FPS", fps);
+        sprintf(string, "Q1: Immediate Mode | OpenGL Bunny: %.2f FPS | CPU p50/p95/p99 %.2f/%.2f/%.2f ms | GPU draw p50 %.3f ms",
+            fps, cpu.p50, cpu.p95, cpu.p99, draw.p50);
         glutSetWindowTitle(string);
     }
 
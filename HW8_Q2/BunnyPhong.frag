@@ -0,0 +1,33 @@
+#version 330 core
+in vec3 FragPos;
+in vec3 Normal;
+
+out vec4 FragColor;
+
+layout(std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec4  viewPos;
+    vec4  ambient;
+    vec4  lightDir[4];     // directional lights, direction towards the light
+    vec4  lightColor[4];
+    ivec4 lightCount;
+};
+
+uniform vec3 ka, kd, ks;
+uniform float shininess;
+
+void main() {
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
+
+    vec3 color = ka * ambient.rgb;
+    for (int i = 0; i < lightCount.x; ++i) {
+        vec3 lightDirection = normalize(lightDir[i].xyz);
+        float diff = max(dot(norm, lightDirection), 0.0);
+        vec3 reflectDir = reflect(-lightDirection, norm);
+        float spec = shininess > 0.0 ? pow(max(dot(viewDir, reflectDir), 0.0), shininess) : 0.0;
+        color += kd * lightColor[i].rgb * diff + ks * lightColor[i].rgb * spec;
+    }
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+
+layout(std140) uniform FrameData {
+    mat4  view;
+    mat4  projection;
+    vec4  viewPos;
+    vec4  ambient;
+    vec4  lightDir[4];
+    vec4  lightColor[4];
+    ivec4 lightCount;
+};
+
+uniform mat4 model;
+uniform mat3 normalMatrix;   // transpose(inverse(mat3(model))), computed on the CPU
+
+out vec3 FragPos;
+out vec3 Normal;
+
+void main() {
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = normalMatrix * aNormal;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -5,29 +5,95 @@
 #include <vector>
 #include <fstream>
 #include <float.h>
+#include <math.h>
 #include <algorithm> 
+#include <sstream>
+#include <chrono>
 
 #include <GL/glew.h>
 #include <GL/glut.h>
+#include <GL/freeglut_ext.h>
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "mesh.h"
+#include "mesh_quantize.h"
+#include "meshlet.h"
+#include "mesh_simplify.h"
+#include "stream_buffer.h"
+#include "frame_timer.h"
+#include "instancing.h"
+#include "core_renderer.h"
 
 // ----------------------------------------------------------------------------
 // 구조체 및 전역 변수
 // ----------------------------------------------------------------------------
-struct Vector3 { float x, y, z; };
-struct Triangle { unsigned int indices[3]; };
-
 std::vector<Vector3>  gPositions;
 std::vector<Vector3>  gNormals;
 std::vector<Triangle> gTriangles;
 
-float  gTotalTimeElapsed = 0.0f;
 int    gTotalFrames = 0;
-GLuint gTimer;
 
 GLuint gVBO_positions;
 GLuint gVBO_normals;
 GLuint gEBO;
 
+// 그리기 모드 ('m' 키로 전환)
+enum DrawMode { MODE_VERTEX_ARRAYS, MODE_CORE_VAO, MODE_QUANTIZED, MODE_MESHLETS, MODE_LOD,
+                MODE_IMMEDIATE, MODE_STREAMING, MODE_INSTANCED_INDIRECT, MODE_PER_OBJECT, MODE_COUNT };
+const char* gModeNames[MODE_COUNT] = { "Vertex Arrays", "Core VAO", "Quantized", "Meshlet Culling", "LOD",
+                                       "Immediate", "Streaming", "Instanced Indirect", "Per-Object Draws" };
+int gDrawMode = MODE_VERTEX_ARRAYS;
+
+// "-core" 로 실행하면 3.3 core profile 컨텍스트를 만들고 Core VAO 모드만 사용
+bool gCoreProfile = false;
+
+// Core profile 경로 (VAO + BunnyPhong 셰이더 + 카메라/조명 UBO)
+CoreRenderer gCore;
+glm::mat4 gProjection, gView, gModel;
+
+// 압축 정점 포맷 (16bit 위치 + 옥타헤드럴 노멀)
+QuantizedMesh gQuantized;
+GLuint gVBO_packed;
+GLuint gEBO_packed;
+GLuint gQuantizedProgram;
+GLint  gLocCenter, gLocHalfExtent;
+
+// 메쉬릿 (클러스터 단위 절두체/뒷면 컬링)
+std::vector<Meshlet>  gMeshlets;
+std::vector<Triangle> gMeshletTriangles;
+GLuint gEBO_meshlets;
+MeshletCullStats gCullStats;
+unsigned long long gCulledMeshletsTotal = 0;
+unsigned long long gMeshletsTotal = 0;
+
+// LOD 체인 (화면 공간 오차 기반 선택, '+'/'-' 거리, '['/']' 오차 허용치)
+struct LodBuffers { GLuint vboPositions, vboNormals, ebo; GLsizei indexCount; };
+std::vector<LodLevel>   gLods;
+std::vector<LodBuffers> gLodBuffers;
+Vector3 gMeshCenter;
+float gBunnyDistance = 1.5f;
+float gPixelBudget = 1.0f;
+int   gCurrentLod = 0;
+float gCurrentLodError = 0.0f;
+unsigned long long gSubmittedTrianglesTotal = 0;
+
+// 동적 정점 스트리밍 (persistent mapped, 3중 버퍼 + fence)
+StreamRing gStream;
+const float kWaveAmplitude = 0.002f;
+const float kWaveFrequency = 60.0f;
+
+// 인스턴싱 (64x64 마리, LOD 1~4 를 서로 다른 메쉬로 사용)
+InstancedScene gInstances;
+const int   kInstanceGrid = 64;
+const float kInstanceSpacing = 0.2f;
+int    gDrawCalls = 0;
+double gSubmitMs = 0.0;
+double gSubmitSecondsTotal = 0.0;
+unsigned long long gDrawCallsTotal = 0;
+
 // ----------------------------------------------------------------------------
 // OBJ 로딩 (샘플 코드 그대로 사용)
 // ----------------------------------------------------------------------------
@@ -96,19 +162,6 @@ void load_mesh(const std::string& fn) {
         xmin, ymin, zmin, xmax, ymax, zmax);
 }
 
-// ----------------------------------------------------------------------------
-// 타이머
-// ----------------------------------------------------------------------------
-void init_timer() { glGenQueries(1, &gTimer); }
-void start_timing() { glBeginQuery(GL_TIME_ELAPSED, gTimer); }
-float stop_timing() {
-    glEndQuery(GL_TIME_ELAPSED);
-    GLint avail = 0, result = 0;
-    while (!avail) glGetQueryObjectiv(gTimer, GL_QUERY_RESULT_AVAILABLE, &avail);
-    glGetQueryObjectiv(gTimer, GL_QUERY_RESULT, &result);
-    return result * 1e-9f;
-}
-
 // ----------------------------------------------------------------------------
 // 버퍼 생성 (VBO/EBO)
 // ----------------------------------------------------------------------------
@@ -139,12 +192,122 @@ void init_buffers() {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+// ----------------------------------------------------------------------------
+// 셰이더 (HW7_Q1 과 같은 방식으로 파일에서 읽어 컴파일)
+// ----------------------------------------------------------------------------
+std::string readFile(const char* filename) {
+    std::ifstream file(filename);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+GLuint compileShader(GLenum type, const std::string& source, const char* name) {
+    GLuint id = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(id, 1, &src, nullptr);
+    glCompileShader(id);
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[2048] = { 0 };
+        glGetShaderInfoLog(id, sizeof(log), nullptr, log);
+        printf("ERROR: %s compile failed\n%s\n", name, log);
+    }
+    return id;
+}
+
+// fragment 가 비어 있으면 고정 파이프라인 fragment 단계를 그대로 사용
+GLuint createShader(const char* vertexFile, const char* fragmentFile,
+                    const std::vector<std::pair<GLuint, const char*>>& attribs) {
+    GLuint program = glCreateProgram();
+    GLuint vs = compileShader(GL_VERTEX_SHADER, readFile(vertexFile), vertexFile);
+    glAttachShader(program, vs);
+    GLuint fs = 0;
+    if (fragmentFile) {
+        fs = compileShader(GL_FRAGMENT_SHADER, readFile(fragmentFile), fragmentFile);
+        glAttachShader(program, fs);
+    }
+    for (const auto& a : attribs)
+        glBindAttribLocation(program, a.first, a.second);
+    glLinkProgram(program);
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[2048] = { 0 };
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        printf("ERROR: %s link failed\n%s\n", vertexFile, log);
+    }
+    glDeleteShader(vs);
+    if (fs) glDeleteShader(fs);
+    return program;
+}
+
+// ----------------------------------------------------------------------------
+// 압축 정점 버퍼 생성
+// ----------------------------------------------------------------------------
+void init_quantized_buffers() {
+    quantize_mesh(gPositions, gNormals, gTriangles, gQuantized);
+    report_quantization(gQuantized, gPositions, gNormals);
+
+    glGenBuffers(1, &gVBO_packed);
+    glBindBuffer(GL_ARRAY_BUFFER, gVBO_packed);
+    glBufferData(GL_ARRAY_BUFFER,
+        gQuantized.vertexBytes(),
+        gQuantized.vertices.data(),
+        GL_STATIC_DRAW);
+
+    glGenBuffers(1, &gEBO_packed);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gEBO_packed);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+        gQuantized.indexBytes(),
+        gQuantized.use16BitIndices()
+            ? (const void*)gQuantized.indices16.data()
+            : (const void*)gQuantized.indices32.data(),
+        GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    gQuantizedProgram = createShader("Quantized.vert", nullptr,
+        { { 0, "aPosition" }, { 1, "aOctNormal" } });
+    gLocCenter = glGetUniformLocation(gQuantizedProgram, "uCenter");
+    gLocHalfExtent = glGetUniformLocation(gQuantizedProgram, "uHalfExtent");
+}
+
+// ----------------------------------------------------------------------------
+// 메쉬릿 생성 및 재정렬된 인덱스 버퍼
+// ----------------------------------------------------------------------------
+void init_meshlets() {
+    build_meshlets(gPositions, gTriangles, gMeshlets, gMeshletTriangles);
+
+    unsigned int maxVerts = 0, maxTris = 0, cullable = 0;
+    for (const Meshlet& m : gMeshlets) {
+        maxVerts = std::max(maxVerts, m.vertexCount);
+        maxTris = std::max(maxTris, m.triangleCount);
+        if (m.coneCutoff < 1.0f) cullable++;
+    }
+    printf("[Meshlet] %lu meshlets (max %u verts, %u tris), %u with cullable cones\n",
+        (unsigned long)gMeshlets.size(), maxVerts, maxTris, cullable);
+
+    glGenBuffers(1, &gEBO_meshlets);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gEBO_meshlets);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+        gMeshletTriangles.size() * sizeof(Triangle),
+        gMeshletTriangles.data(),
+        GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
 // ----------------------------------------------------------------------------
 // OpenGL 초기화 (과제 지정 파라미터에 맞춤)
 // ----------------------------------------------------------------------------
 void init_gl() {
     glEnable(GL_DEPTH_TEST);
     glDisable(GL_CULL_FACE);
+    if (gCoreProfile) return;   // 아래는 고정 파이프라인 상태
 
     // 기본 Gouraud shading
     glShadeModel(GL_SMOOTH);
@@ -186,25 +349,123 @@ void reshape(int w, int h) {
 }
 
 // ----------------------------------------------------------------------------
-// 렌더링 루프
+// LOD 체인 생성 (원본 옆에 bunny.lodN.obj 로 저장) 및 단계별 버퍼
 // ----------------------------------------------------------------------------
-void display() {
-    glClearColor(0, 0, 0, 1);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+void init_lods(const std::string& sourceFile) {
+    build_lod_chain(gPositions, gNormals, gTriangles, 6, 1000, gLods);
+    save_lod_chain(sourceFile, gLods);
+
+    Vector3 bmin = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Vector3 bmax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vector3& p : gPositions) {
+        bmin.x = std::min(bmin.x, p.x); bmax.x = std::max(bmax.x, p.x);
+        bmin.y = std::min(bmin.y, p.y); bmax.y = std::max(bmax.y, p.y);
+        bmin.z = std::min(bmin.z, p.z); bmax.z = std::max(bmax.z, p.z);
+    }
+    gMeshCenter = { (bmin.x + bmax.x) * 0.5f, (bmin.y + bmax.y) * 0.5f, (bmin.z + bmax.z) * 0.5f };
+
+    gLodBuffers.resize(gLods.size());
+    for (size_t i = 0; i < gLods.size(); ++i) {
+        const LodLevel& l = gLods[i];
+        LodBuffers& b = gLodBuffers[i];
+        glGenBuffers(1, &b.vboPositions);
+        glBindBuffer(GL_ARRAY_BUFFER, b.vboPositions);
+        glBufferData(GL_ARRAY_BUFFER, l.positions.size() * sizeof(Vector3), l.positions.data(), GL_STATIC_DRAW);
+
+        glGenBuffers(1, &b.vboNormals);
+        glBindBuffer(GL_ARRAY_BUFFER, b.vboNormals);
+        glBufferData(GL_ARRAY_BUFFER, l.normals.size() * sizeof(Vector3), l.normals.data(), GL_STATIC_DRAW);
+
+        glGenBuffers(1, &b.ebo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, b.ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, l.triangles.size() * sizeof(Triangle), l.triangles.data(), GL_STATIC_DRAW);
+        b.indexCount = (GLsizei)l.triangles.size() * 3;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// ----------------------------------------------------------------------------
+// Core profile 경로: HW7_Q1 과 같은 Phong 셰이더 + VAO
+// ----------------------------------------------------------------------------
+void init_core() {
+    GLuint program = createShader("BunnyPhong.vert", "BunnyPhong.frag", {});
+    init_core_renderer(gCore, program, gPositions, gNormals, gTriangles);
+}
 
-    // 투영
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glFrustum(-0.1, 0.1, -0.1, 0.1, 0.1, 1000.0);
+// ----------------------------------------------------------------------------
+// 인스턴싱 장면 (LOD 단계를 메쉬로 재사용)
+// ----------------------------------------------------------------------------
+void init_instancing() {
+    GLuint program = createShader("Instanced.vert", nullptr,
+        { { ATTRIB_POSITION, "aPosition" }, { ATTRIB_NORMAL, "aNormal" },
+          { ATTRIB_MODEL_ROW0, "aModelRow0" }, { ATTRIB_MODEL_ROW1, "aModelRow1" },
+          { ATTRIB_MODEL_ROW2, "aModelRow2" }, { ATTRIB_MATERIAL, "aMaterial" } });
+    init_instanced_scene(gInstances, program, gLods, 1, 4, kInstanceGrid, kInstanceSpacing);
+}
 
-    // 모델뷰
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glTranslatef(0.1f, -1.0f, -1.5f);
-    glScalef(10.0f, 10.0f, 10.0f);
+// ----------------------------------------------------------------------------
+// 키보드: 그리기 모드 전환
+// ----------------------------------------------------------------------------
+// 현재 모드의 누적 통계를 출력하고 초기화
+void flush_stats() {
+    print_timer_stats(gModeNames[gDrawMode]);
+    if (gDrawMode == MODE_MESHLETS && gMeshletsTotal > 0)
+        printf("  culled meshlets: %.1f%%\n", 100.0 * gCulledMeshletsTotal / gMeshletsTotal);
+    if (gDrawMode == MODE_STREAMING && gTotalFrames > 0)
+        printf("  fence wait: %.3f ms/frame\n", gStream.waitSeconds * 1000.0 / gTotalFrames);
+    if (gDrawMode == MODE_LOD && gTotalFrames > 0)
+        printf("  distance %.2f, budget %.2f px: %.0f tris/frame\n", gBunnyDistance, gPixelBudget,
+            (double)gSubmittedTrianglesTotal / gTotalFrames);
+    if ((gDrawMode == MODE_INSTANCED_INDIRECT || gDrawMode == MODE_PER_OBJECT) && gTotalFrames > 0)
+        printf("  %lu instances: %.0f draw calls/frame, CPU submit %.3f ms/frame\n",
+            (unsigned long)gInstances.instances.size(), (double)gDrawCallsTotal / gTotalFrames,
+            gSubmitSecondsTotal * 1000.0 / gTotalFrames);
+    gTotalFrames = 0;
+    reset_timer_stats();
+    gMeshletsTotal = gCulledMeshletsTotal = 0;
+    gSubmittedTrianglesTotal = 0;
+    gStream.waitSeconds = 0.0;
+    gSubmitSecondsTotal = 0.0;
+    gDrawCallsTotal = 0;
+}
 
-    start_timing();
+// core profile 에서는 고정 파이프라인/GLSL 1.20 을 쓰는 모드를 건너뛴다
+bool mode_available(int mode) {
+    return !gCoreProfile || mode == MODE_CORE_VAO;
+}
 
+void keyboard(unsigned char key, int, int) {
+    switch (key) {
+    case 'm': case 'M':
+        flush_stats();
+        do {
+            gDrawMode = (gDrawMode + 1) % MODE_COUNT;
+        } while (!mode_available(gDrawMode));
+        break;
+    case '+': case '=':
+        flush_stats();
+        gBunnyDistance = std::max(0.5f, gBunnyDistance / 1.25f);
+        break;
+    case '-':
+        flush_stats();
+        gBunnyDistance *= 1.25f;
+        break;
+    case '[':
+        flush_stats();
+        gPixelBudget = std::max(0.125f, gPixelBudget * 0.5f);
+        break;
+    case ']':
+        flush_stats();
+        gPixelBudget *= 2.0f;
+        break;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// 그리기: 정점 배열 (float 위치/노멀 VBO)
+// ----------------------------------------------------------------------------
+void draw_vertex_arrays() {
     // VBO/EBO 바인딩
     glBindBuffer(GL_ARRAY_BUFFER, gVBO_positions);
     glEnableClientState(GL_VERTEX_ARRAY);
@@ -225,16 +486,257 @@ void display() {
     glDisableClientState(GL_NORMAL_ARRAY);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// ----------------------------------------------------------------------------
+// 그리기: core profile (행렬과 조명은 display() 에서 채운 UBO 로)
+// ----------------------------------------------------------------------------
+void draw_core_vao() {
+    // init_gl() 의 고정 파이프라인 조명/재질과 같은 값
+    FrameUniforms frame = {};
+    frame.view = gView;
+    frame.projection = gProjection;
+    frame.viewPos = glm::inverse(gView) * glm::vec4(0, 0, 0, 1);
+    frame.ambient = glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);
+    frame.lightDir[0] = glm::vec4(-1, -1, -1, 0);
+    frame.lightColor[0] = glm::vec4(1, 1, 1, 1);
+    frame.lightCount = glm::ivec4(1, 0, 0, 0);
+    update_frame_uniforms(gCore, frame);
+
+    CoreMaterial white = { glm::vec3(1), glm::vec3(1), glm::vec3(0), 0.0f };
+    draw_core(gCore, gModel, white);
+}
+
+// ----------------------------------------------------------------------------
+// 그리기: 압축 정점 (디코딩은 Quantized.vert 에서)
+// ----------------------------------------------------------------------------
+void draw_quantized() {
+    glUseProgram(gQuantizedProgram);
+    glUniform3f(gLocCenter, gQuantized.center.x, gQuantized.center.y, gQuantized.center.z);
+    glUniform3f(gLocHalfExtent, gQuantized.halfExtent.x, gQuantized.halfExtent.y, gQuantized.halfExtent.z);
+
+    glBindBuffer(GL_ARRAY_BUFFER, gVBO_packed);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)8);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gEBO_packed);
+    glDrawElements(GL_TRIANGLES,
+        (GLsizei)gQuantized.indexCount(),
+        gQuantized.use16BitIndices() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+        (void*)0);
+
+    glDisableVertexAttribArray(0);
+    glDisableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
+
+// ----------------------------------------------------------------------------
+// 그리기: 메쉬릿 컬링 후 살아남은 구간만 glMultiDrawElements
+// ----------------------------------------------------------------------------
+void draw_meshlets() {
+    GLfloat mv[16], proj[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+    glGetFloatv(GL_PROJECTION_MATRIX, proj);
+
+    static std::vector<int> counts;
+    static std::vector<const void*> offsets;
+    gCullStats = cull_meshlets(gMeshlets, mv, proj, counts, offsets);
+    gMeshletsTotal += gCullStats.total;
+    gCulledMeshletsTotal += gCullStats.frustumCulled + gCullStats.backfaceCulled;
+
+    glBindBuffer(GL_ARRAY_BUFFER, gVBO_positions);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, (void*)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, gVBO_normals);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glNormalPointer(GL_FLOAT, 0, (void*)0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gEBO_meshlets);
+    if (!counts.empty())
+        glMultiDrawElements(GL_TRIANGLES, counts.data(), GL_UNSIGNED_INT,
+            (const GLvoid**)offsets.data(), (GLsizei)counts.size());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// ----------------------------------------------------------------------------
+// 그리기: 화면 공간 오차로 고른 LOD 단계
+// ----------------------------------------------------------------------------
+void draw_lod() {
+    GLfloat mv[16], proj[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+    glGetFloatv(GL_PROJECTION_MATRIX, proj);
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // 메쉬 중심까지의 시점 공간 거리와 (균일) 모델 스케일
+    const Vector3& c = gMeshCenter;
+    float ex = mv[0] * c.x + mv[4] * c.y + mv[8] * c.z + mv[12];
+    float ey = mv[1] * c.x + mv[5] * c.y + mv[9] * c.z + mv[13];
+    float ez = mv[2] * c.x + mv[6] * c.y + mv[10] * c.z + mv[14];
+    float distance = sqrtf(ex * ex + ey * ey + ez * ez);
+    float scale = sqrtf(mv[0] * mv[0] + mv[1] * mv[1] + mv[2] * mv[2]);
+    float pixelsPerUnit = 0.5f * viewport[3] * proj[5] * scale;
+
+    gCurrentLod = select_lod(gLods, distance, pixelsPerUnit, gPixelBudget, &gCurrentLodError);
+    const LodBuffers& b = gLodBuffers[gCurrentLod];
+    gSubmittedTrianglesTotal += b.indexCount / 3;
+
+    glBindBuffer(GL_ARRAY_BUFFER, b.vboPositions);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, (void*)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, b.vboNormals);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glNormalPointer(GL_FLOAT, 0, (void*)0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, b.ebo);
+    glDrawElements(GL_TRIANGLES, b.indexCount, GL_UNSIGNED_INT, (void*)0);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// ----------------------------------------------------------------------------
+// 그리기: Immediate Mode (HW8_Q1 과 동일, 비교용)
+// ----------------------------------------------------------------------------
+void draw_immediate() {
+    glBegin(GL_TRIANGLES);
+    for (size_t i = 0; i < gTriangles.size(); ++i) {
+        for (int j = 0; j < 3; ++j) {
+            unsigned int k = gTriangles[i].indices[j];
+            glNormal3f(gNormals[k].x, gNormals[k].y, gNormals[k].z);
+            glVertex3f(gPositions[k].x, gPositions[k].y, gPositions[k].z);
+        }
+    }
+    glEnd();
+}
 
-    float t = stop_timing();
+// ----------------------------------------------------------------------------
+// 그리기: 매 프레임 변형한 정점을 링 버퍼로 스트리밍
+//   노멀 방향으로 사인파 변위를 준다 (노멀은 원본 그대로 사용)
+// ----------------------------------------------------------------------------
+void draw_streaming() {
+    float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
+    Vector3* dst = (Vector3*)stream_ring_begin(gStream);
+    size_t count = std::min(gPositions.size(), gNormals.size());
+    for (size_t i = 0; i < count; ++i) {
+        const Vector3& p = gPositions[i];
+        const Vector3& n = gNormals[i];
+        float d = kWaveAmplitude * sinf(kWaveFrequency * p.y + 4.0f * time);
+        dst[2 * i + 0] = { p.x + n.x * d, p.y + n.y * d, p.z + n.z * d };
+        dst[2 * i + 1] = n;
+    }
+    size_t offset = stream_ring_end(gStream);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 2 * sizeof(Vector3), (void*)offset);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glNormalPointer(GL_FLOAT, 2 * sizeof(Vector3), (void*)(offset + sizeof(Vector3)));
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gEBO);
+    glDrawElements(GL_TRIANGLES,
+        (GLsizei)gTriangles.size() * 3,
+        GL_UNSIGNED_INT,
+        (void*)0);
+    stream_ring_fence(gStream);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+// ----------------------------------------------------------------------------
+// 그리기: 인스턴싱 장면 (indirect 한 번 또는 객체마다 한 번)
+//   GL 호출을 내는 데 걸린 CPU 시간만 잰다 (GPU 시간은 "draw" 패스 쿼리)
+// ----------------------------------------------------------------------------
+void draw_instances(bool indirect) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    gDrawCalls = indirect ? draw_instanced_indirect(gInstances) : draw_instanced_per_object(gInstances);
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+
+    gSubmitMs = seconds * 1000.0;
+    gSubmitSecondsTotal += seconds;
+    gDrawCallsTotal += gDrawCalls;
+}
+
+// ----------------------------------------------------------------------------
+// 렌더링 루프
+// ----------------------------------------------------------------------------
+void display() {
+    begin_frame();
+
+    start_timing("clear");
+    glClearColor(0, 0, 0, 1);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    stop_timing();
+
+    // 투영/뷰/모델 (CPU 에서 계산, 호환 모드에서는 행렬 스택에 그대로 올린다)
+    gProjection = glm::frustum(-0.1f, 0.1f, -0.1f, 0.1f, 0.1f, 1000.0f);
+    if (gDrawMode == MODE_INSTANCED_INDIRECT || gDrawMode == MODE_PER_OBJECT) {
+        // 격자를 위에서 비스듬히 내려다본다
+        gView = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, -gBunnyDistance));
+        gView = glm::rotate(gView, glm::radians(25.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    }
+    else {
+        gView = glm::translate(glm::mat4(1.0f), glm::vec3(0.1f, -1.0f, -gBunnyDistance));
+    }
+    gModel = glm::scale(glm::mat4(1.0f), glm::vec3(10.0f));
+
+    if (!gCoreProfile) {
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(glm::value_ptr(gProjection));
+        glMatrixMode(GL_MODELVIEW);
+        glLoadMatrixf(glm::value_ptr(gView * gModel));
+    }
+
+    start_timing("draw");
+
+    switch (gDrawMode) {
+    case MODE_VERTEX_ARRAYS: draw_vertex_arrays(); break;
+    case MODE_CORE_VAO:      draw_core_vao();      break;
+    case MODE_QUANTIZED:     draw_quantized();     break;
+    case MODE_MESHLETS:      draw_meshlets();      break;
+    case MODE_LOD:           draw_lod();           break;
+    case MODE_IMMEDIATE:     draw_immediate();     break;
+    case MODE_STREAMING:     draw_streaming();     break;
+    case MODE_INSTANCED_INDIRECT: draw_instances(true);  break;
+    case MODE_PER_OBJECT:         draw_instances(false); break;
+    }
+
+    stop_timing();
+    end_frame();
     gTotalFrames++;
-    gTotalTimeElapsed += t;
-    float fps = gTotalTimeElapsed > 0
-        ? (float)gTotalFrames / gTotalTimeElapsed
-        : 0.0f;
 
-    char buf[128];
-    sprintf(buf, "Q2: Vertex Arrays | OpenGL Bunny: %0.2f FPS", fps);
+    // 결과는 몇 프레임 늦게 도착하므로 통계(p50/p95/p99)로 표시
+    TimerStats cpu = cpu_frame_stats();
+    TimerStats draw = gpu_pass_stats("draw");
+    float fps = cpu.p50 > 0 ? (float)(1000.0 / cpu.p50) : 0.0f;
+
+    char buf[384];
+    int len = sprintf(buf, "Q2: %s | OpenGL Bunny: %0.2f FPS | CPU p50/p95/p99 %.2f/%.2f/%.2f ms | GPU draw p50 %.3f ms",
+        gModeNames[gDrawMode], fps, cpu.p50, cpu.p95, cpu.p99, draw.p50);
+    if (gDrawMode == MODE_LOD)
+        sprintf(buf + len, " | LOD %d (%d tris, %.2f px error, budget %.2f px)",
+            gCurrentLod, (int)gLods[gCurrentLod].triangles.size(), gCurrentLodError, gPixelBudget);
+    if (gDrawMode == MODE_MESHLETS)
+        sprintf(buf + len, " | culled %u/%u (frustum %u, backface %u)",
+            gCullStats.frustumCulled + gCullStats.backfaceCulled, gCullStats.total,
+            gCullStats.frustumCulled, gCullStats.backfaceCulled);
+    if (gDrawMode == MODE_INSTANCED_INDIRECT || gDrawMode == MODE_PER_OBJECT)
+        sprintf(buf + len, " | %lu instances, %d draw calls, CPU submit %.3f ms",
+            (unsigned long)gInstances.instances.size(), gDrawCalls, gSubmitMs);
     glutSetWindowTitle(buf);
 
     glutSwapBuffers();
@@ -246,21 +748,39 @@ void display() {
 // ----------------------------------------------------------------------------
 int main(int argc, char** argv) {
     glutInit(&argc, argv);
+    for (int i = 1; i < argc; ++i)
+        if (strcmp(argv[i], "-core") == 0) gCoreProfile = true;
+    if (gCoreProfile) {
+        glutInitContextVersion(3, 3);
+        glutInitContextProfile(GLUT_CORE_PROFILE);
+        gDrawMode = MODE_CORE_VAO;
+    }
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH | GLUT_MULTISAMPLE);
     glutInitWindowSize(1280, 1280);
     glutCreateWindow("OpenGL Bunny");
 
+    glewExperimental = GL_TRUE;   // core profile 에서 확장 문자열 없이도 함수 포인터를 읽도록
     if (glewInit() != GLEW_OK) {
         fprintf(stderr, "GLEW init failed\n");
         return -1;
     }
+    glGetError();   // core profile 에서 glewInit 이 남기는 GL_INVALID_ENUM 제거
 
     load_mesh("bunny.obj");
     init_gl();
     init_buffers();
+    init_core();
+    if (!gCoreProfile) {
+        init_quantized_buffers();
+        init_meshlets();
+        init_lods("bunny.obj");
+        stream_ring_init(gStream, gPositions.size() * 2 * sizeof(Vector3), 3);
+        init_instancing();
+    }
     init_timer();
 
     glutReshapeFunc(reshape);
+    glutKeyboardFunc(keyboard);
     glutDisplayFunc(display);
     glutMainLoop();
     return 0;
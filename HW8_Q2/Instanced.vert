@@ -0,0 +1,26 @@
+#version 120
+// Per-instance transform/material from instanced attributes + GL_LIGHT0 lighting
+attribute vec3  aPosition;
+attribute vec3  aNormal;
+attribute vec4  aModelRow0;  // object -> world, row-major 3x4
+attribute vec4  aModelRow1;
+attribute vec4  aModelRow2;
+attribute float aMaterial;
+
+uniform vec4 uMaterials[8];  // diffuse color per material id
+
+void main() {
+    vec4 p = vec4(aPosition, 1.0);
+    vec3 world = vec3(dot(aModelRow0, p), dot(aModelRow1, p), dot(aModelRow2, p));
+    vec3 n = vec3(dot(aModelRow0.xyz, aNormal), dot(aModelRow1.xyz, aNormal), dot(aModelRow2.xyz, aNormal));
+
+    vec3 N = normalize(gl_NormalMatrix * n);
+    vec3 L = normalize(gl_LightSource[0].position.xyz);
+    float diff = max(dot(N, L), 0.0);
+    vec4 kd = uMaterials[int(aMaterial + 0.5)];
+
+    gl_FrontColor = (gl_LightModel.ambient + gl_LightSource[0].ambient) * kd
+                  + gl_LightSource[0].diffuse * kd * diff;
+    gl_FrontColor.a = 1.0;
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(world, 1.0);
+}
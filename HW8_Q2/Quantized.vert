@@ -0,0 +1,29 @@
+#version 120
+// Quantized vertex decode + GL_LIGHT0 lighting matching the fixed-function path
+attribute vec3 aPosition;   // snorm16 x3 relative to mesh bbox
+attribute vec2 aOctNormal;  // snorm16 x2 octahedral
+
+uniform vec3 uCenter;
+uniform vec3 uHalfExtent;
+
+vec3 oct_decode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        vec2 s = vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(e.yx)) * s;
+    }
+    return normalize(n);
+}
+
+void main() {
+    vec3 pos = uCenter + aPosition * uHalfExtent;
+    vec3 N = normalize(gl_NormalMatrix * oct_decode(aOctNormal));
+    vec3 L = normalize(gl_LightSource[0].position.xyz);
+    float diff = max(dot(N, L), 0.0);
+
+    gl_FrontColor = gl_FrontLightModelProduct.sceneColor
+                  + gl_FrontLightProduct[0].ambient
+                  + gl_FrontLightProduct[0].diffuse * diff;
+    gl_FrontColor.a = 1.0;
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(pos, 1.0);
+}
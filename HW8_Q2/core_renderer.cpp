@@ -0,0 +1,89 @@
+﻿#include "core_renderer.h"
+#include <stdio.h>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// ----------------------------------------------------------------------------
+// VAO / UBO 생성
+// ----------------------------------------------------------------------------
+void init_core_renderer(CoreRenderer& r, GLuint program,
+                        const std::vector<Vector3>& positions,
+                        const std::vector<Vector3>& normals,
+                        const std::vector<Triangle>& triangles) {
+    r = CoreRenderer();
+    r.program = program;
+    r.indexCount = (GLsizei)triangles.size() * 3;
+
+    glGenVertexArrays(1, &r.vao);
+    glBindVertexArray(r.vao);
+
+    glGenBuffers(1, &r.vboPositions);
+    glBindBuffer(GL_ARRAY_BUFFER, r.vboPositions);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(Vector3), positions.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vector3), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glGenBuffers(1, &r.vboNormals);
+    glBindBuffer(GL_ARRAY_BUFFER, r.vboNormals);
+    glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(Vector3), normals.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vector3), (void*)0);
+    glEnableVertexAttribArray(1);
+
+    glGenBuffers(1, &r.ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, r.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, triangles.size() * sizeof(Triangle), triangles.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenBuffers(1, &r.ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, r.ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameUniformBinding, r.ubo);
+
+    GLuint block = glGetUniformBlockIndex(program, "FrameData");
+    if (block == GL_INVALID_INDEX) {
+        printf("ERROR: FrameData uniform block not found\n");
+    }
+    else {
+        GLint size = 0;
+        glGetActiveUniformBlockiv(program, block, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+        if (size != (GLint)sizeof(FrameUniforms))
+            printf("WARNING: FrameData is %d bytes in GLSL, %d bytes in C++\n", size, (int)sizeof(FrameUniforms));
+        glUniformBlockBinding(program, block, kFrameUniformBinding);
+    }
+
+    r.locModel = glGetUniformLocation(program, "model");
+    r.locNormalMatrix = glGetUniformLocation(program, "normalMatrix");
+    r.locKa = glGetUniformLocation(program, "ka");
+    r.locKd = glGetUniformLocation(program, "kd");
+    r.locKs = glGetUniformLocation(program, "ks");
+    r.locShininess = glGetUniformLocation(program, "shininess");
+}
+
+void update_frame_uniforms(const CoreRenderer& r, const FrameUniforms& frame) {
+    glBindBuffer(GL_UNIFORM_BUFFER, r.ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frame);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// ----------------------------------------------------------------------------
+// 그리기: 노멀 행렬은 CPU 에서 한 번만 계산
+// ----------------------------------------------------------------------------
+void draw_core(const CoreRenderer& r, const glm::mat4& model, const CoreMaterial& material) {
+    glm::mat3 normalMatrix = glm::inverseTranspose(glm::mat3(model));
+
+    glUseProgram(r.program);
+    glUniformMatrix4fv(r.locModel, 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix3fv(r.locNormalMatrix, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+    glUniform3fv(r.locKa, 1, glm::value_ptr(material.ka));
+    glUniform3fv(r.locKd, 1, glm::value_ptr(material.kd));
+    glUniform3fv(r.locKs, 1, glm::value_ptr(material.ks));
+    glUniform1f(r.locShininess, material.shininess);
+
+    glBindVertexArray(r.vao);
+    glDrawElements(GL_TRIANGLES, r.indexCount, GL_UNSIGNED_INT, (void*)0);
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
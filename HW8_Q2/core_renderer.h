@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <vector>
+#include <GL/glew.h>
+#ifndef GLM_FORCE_RADIANS
+#define GLM_FORCE_RADIANS
+#endif
+#include <glm/glm.hpp>
+#include "mesh.h"
+
+// ----------------------------------------------------------------------------
+// Core profile 경로 (HW7_Q1 의 Phong 셰이더 파이프라인과 같은 구성)
+//   VAO + 정점 속성 layout(location), 고정 파이프라인 조명/행렬 스택 대신
+//   카메라와 조명은 uniform buffer (binding 0), 객체 변환은 일반 uniform.
+// ----------------------------------------------------------------------------
+const int    kCoreMaxLights = 4;
+const GLuint kFrameUniformBinding = 0;
+
+// BunnyPhong.vert/.frag 의 "FrameData" 블록과 같은 std140 배치
+struct FrameUniforms {
+    glm::mat4  view;
+    glm::mat4  projection;
+    glm::vec4  viewPos;                      // 월드 공간 카메라 위치
+    glm::vec4  ambient;                      // Ia
+    glm::vec4  lightDir[kCoreMaxLights];     // 월드 공간, 빛을 향하는 방향 (방향광)
+    glm::vec4  lightColor[kCoreMaxLights];   // Il
+    glm::ivec4 lightCount;                   // x 만 사용
+};
+
+struct CoreMaterial {
+    glm::vec3 ka, kd, ks;
+    float     shininess;
+};
+
+struct CoreRenderer {
+    GLuint  program;
+    GLuint  vao;
+    GLuint  vboPositions, vboNormals, ebo;
+    GLuint  ubo;
+    GLsizei indexCount;
+    GLint   locModel, locNormalMatrix;
+    GLint   locKa, locKd, locKs, locShininess;
+};
+
+// program 은 BunnyPhong.vert/.frag 로 만든 것
+void init_core_renderer(CoreRenderer& r, GLuint program,
+                        const std::vector<Vector3>& positions,
+                        const std::vector<Vector3>& normals,
+                        const std::vector<Triangle>& triangles);
+
+// 프레임마다 한 번: 카메라/조명 블록을 갱신
+void update_frame_uniforms(const CoreRenderer& r, const FrameUniforms& frame);
+
+void draw_core(const CoreRenderer& r, const glm::mat4& model, const CoreMaterial& material);
@@ -0,0 +1,177 @@
+﻿#include "frame_timer.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <GL/glew.h>
+
+// ----------------------------------------------------------------------------
+// 최근 kTimerWindow 개 샘플 (ms)
+// ----------------------------------------------------------------------------
+struct SampleWindow {
+    std::vector<double> samples;
+    size_t next = 0;
+
+    void add(double v) {
+        if (samples.size() < (size_t)kTimerWindow) samples.push_back(v);
+        else samples[next] = v;
+        next = (next + 1) % kTimerWindow;
+    }
+    void clear() { samples.clear(); next = 0; }
+
+    TimerStats stats() const {
+        TimerStats s = { 0, 0, 0, 0, (int)samples.size() };
+        if (samples.empty()) return s;
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        for (double v : sorted) s.mean += v;
+        s.mean /= sorted.size();
+        auto pct = [&](double p) { return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))]; };
+        s.p50 = pct(0.50);
+        s.p95 = pct(0.95);
+        s.p99 = pct(0.99);
+        return s;
+    }
+};
+
+// ----------------------------------------------------------------------------
+// 프레임 하나 분량의 쿼리
+// ----------------------------------------------------------------------------
+struct FrameQueries {
+    GLuint      elapsed[kTimerMaxPasses];
+    int         passIndex[kTimerMaxPasses];
+    int         passCount;
+    GLuint      frameBegin, frameEnd;
+    bool        pending;
+};
+
+static FrameQueries  gFrames[kTimerLatency];
+static int           gCurrent = 0;
+static const char*   gPassNames[kTimerMaxPasses];
+static int           gPassNameCount = 0;
+static SampleWindow  gPassSamples[kTimerMaxPasses];
+static SampleWindow  gGpuFrameSamples;
+static SampleWindow  gCpuFrameSamples;
+static int           gDropped = 0;
+static bool          gHasFrameStart = false;
+static std::chrono::high_resolution_clock::time_point gLastFrameStart;
+
+static int pass_index(const char* name) {
+    for (int i = 0; i < gPassNameCount; ++i)
+        if (strcmp(gPassNames[i], name) == 0) return i;
+    if (gPassNameCount == kTimerMaxPasses) return kTimerMaxPasses - 1;
+    gPassNames[gPassNameCount] = name;
+    return gPassNameCount++;
+}
+
+// 결과가 준비된 경우에만 읽는다. 준비되지 않았으면 false.
+static bool collect(FrameQueries& f) {
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(f.frameEnd, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return false;
+
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(f.frameBegin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(f.frameEnd, GL_QUERY_RESULT, &end);
+    gGpuFrameSamples.add((end - begin) * 1e-6);
+
+    for (int i = 0; i < f.passCount; ++i) {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(f.elapsed[i], GL_QUERY_RESULT, &ns);
+        gPassSamples[f.passIndex[i]].add(ns * 1e-6);
+    }
+    f.pending = false;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// 공개 함수
+// ----------------------------------------------------------------------------
+void init_timer() {
+    for (int i = 0; i < kTimerLatency; ++i) {
+        FrameQueries& f = gFrames[i];
+        glGenQueries(kTimerMaxPasses, f.elapsed);
+        glGenQueries(1, &f.frameBegin);
+        glGenQueries(1, &f.frameEnd);
+        f.passCount = 0;
+        f.pending = false;
+    }
+}
+
+void begin_frame() {
+    auto now = std::chrono::high_resolution_clock::now();
+    if (gHasFrameStart)
+        gCpuFrameSamples.add(std::chrono::duration<double, std::milli>(now - gLastFrameStart).count());
+    gLastFrameStart = now;
+    gHasFrameStart = true;
+
+    FrameQueries& f = gFrames[gCurrent];
+    // 링이 한 바퀴 돌았는데도 결과가 없으면 기다리지 않고 그 프레임을 버린다
+    if (f.pending && !collect(f)) {
+        gDropped++;
+        f.pending = false;
+    }
+    f.passCount = 0;
+    glQueryCounter(f.frameBegin, GL_TIMESTAMP);
+}
+
+void start_timing(const char* pass) {
+    FrameQueries& f = gFrames[gCurrent];
+    if (f.passCount == kTimerMaxPasses) return;
+    f.passIndex[f.passCount] = pass_index(pass);
+    glBeginQuery(GL_TIME_ELAPSED, f.elapsed[f.passCount]);
+}
+
+void stop_timing() {
+    FrameQueries& f = gFrames[gCurrent];
+    if (f.passCount == kTimerMaxPasses) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    f.passCount++;
+}
+
+void end_frame() {
+    FrameQueries& f = gFrames[gCurrent];
+    glQueryCounter(f.frameEnd, GL_TIMESTAMP);
+    f.pending = true;
+    gCurrent = (gCurrent + 1) % kTimerLatency;
+
+    // 이미 끝난 이전 프레임들을 모은다 (가장 오래된 것부터)
+    for (int i = 0; i < kTimerLatency; ++i) {
+        FrameQueries& old = gFrames[(gCurrent + i) % kTimerLatency];
+        if (old.pending && !collect(old)) break;
+    }
+}
+
+TimerStats  cpu_frame_stats() { return gCpuFrameSamples.stats(); }
+TimerStats  gpu_frame_stats() { return gGpuFrameSamples.stats(); }
+int         timer_dropped_frames() { return gDropped; }
+
+TimerStats gpu_pass_stats(const char* pass) {
+    for (int i = 0; i < gPassNameCount; ++i)
+        if (strcmp(gPassNames[i], pass) == 0) return gPassSamples[i].stats();
+    TimerStats empty = { 0, 0, 0, 0, 0 };
+    return empty;
+}
+
+void reset_timer_stats() {
+    for (int i = 0; i < kTimerMaxPasses; ++i) gPassSamples[i].clear();
+    gGpuFrameSamples.clear();
+    gCpuFrameSamples.clear();
+    gDropped = 0;
+    gHasFrameStart = false;
+}
+
+void print_timer_stats(const char* label) {
+    TimerStats c = cpu_frame_stats(), g = gpu_frame_stats();
+    if (c.count == 0) return;
+    printf("%s (%d frames, %d dropped)\n", label, c.count, gDropped);
+    printf("  CPU frame : mean %.3f  p50 %.3f  p95 %.3f  p99 %.3f ms\n", c.mean, c.p50, c.p95, c.p99);
+    printf("  GPU frame : mean %.3f  p50 %.3f  p95 %.3f  p99 %.3f ms\n", g.mean, g.p50, g.p95, g.p99);
+    for (int i = 0; i < gPassNameCount; ++i) {
+        TimerStats p = gPassSamples[i].stats();
+        if (p.count == 0) continue;
+        printf("  GPU %-6s: mean %.3f  p50 %.3f  p95 %.3f  p99 %.3f ms\n",
+            gPassNames[i], p.mean, p.p50, p.p95, p.p99);
+    }
+}
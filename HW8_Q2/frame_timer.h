@@ -0,0 +1,32 @@
+﻿#pragma once
+
+// ----------------------------------------------------------------------------
+// 비동기 프레임 타이머
+//   GPU: 패스별 GL_TIME_ELAPSED + 프레임 시작/끝 GL_TIMESTAMP 쿼리를
+//        kTimerLatency 프레임짜리 링에 넣고, 몇 프레임 뒤에 64bit 로 읽는다.
+//        (결과를 기다리며 CPU 를 멈추지 않는다)
+//   CPU: begin_frame() 사이의 간격
+//   통계: 최근 kTimerWindow 프레임의 p50/p95/p99
+// ----------------------------------------------------------------------------
+const int kTimerLatency = 4;
+const int kTimerMaxPasses = 8;
+const int kTimerWindow = 256;
+
+struct TimerStats {
+    double mean, p50, p95, p99;  // ms
+    int    count;
+};
+
+void init_timer();
+void begin_frame();
+void start_timing(const char* pass);
+void stop_timing();
+void end_frame();
+
+TimerStats  cpu_frame_stats();
+TimerStats  gpu_frame_stats();
+TimerStats  gpu_pass_stats(const char* pass);   // 기록된 적 없는 패스면 count == 0
+int         timer_dropped_frames();
+
+void reset_timer_stats();
+void print_timer_stats(const char* label);
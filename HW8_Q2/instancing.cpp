@@ -0,0 +1,228 @@
+﻿#include "instancing.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+#include <GL/glut.h>
+#include <GL/freeglut_ext.h>
+
+// GL 4.3 / ARB_multi_draw_indirect (동봉된 GLEW 헤더에 없음)
+typedef void (GLAPIENTRY* MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect,
+                                                          GLsizei drawcount, GLsizei stride);
+static MultiDrawElementsIndirectProc gMultiDrawElementsIndirect = nullptr;
+
+// 재질 테이블 (diffuse 색)
+static const float kMaterialColors[kInstanceMaterials][4] = {
+    { 1.00f, 1.00f, 1.00f, 1 }, { 0.90f, 0.30f, 0.25f, 1 }, { 0.30f, 0.75f, 0.35f, 1 }, { 0.30f, 0.45f, 0.95f, 1 },
+    { 0.95f, 0.80f, 0.30f, 1 }, { 0.75f, 0.40f, 0.85f, 1 }, { 0.35f, 0.85f, 0.85f, 1 }, { 0.95f, 0.55f, 0.25f, 1 },
+};
+
+// 배치가 매번 같도록 고정 시드 해시 사용
+static uint32_t hash32(uint32_t x) {
+    x ^= x >> 16; x *= 0x7feb352du;
+    x ^= x >> 15; x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// ----------------------------------------------------------------------------
+// 장면 생성
+// ----------------------------------------------------------------------------
+void init_instanced_scene(InstancedScene& scene, GLuint program,
+                          const std::vector<LodLevel>& chain, int firstLevel, int meshCount,
+                          int gridSide, float spacing) {
+    scene = InstancedScene();
+    scene.program = program;
+
+    firstLevel = std::min(firstLevel, (int)chain.size() - 1);
+    meshCount = std::min(meshCount, (int)chain.size() - firstLevel);
+
+    // 메쉬를 한 버퍼에 이어 붙인다 (인덱스는 단계별 로컬 번호 그대로, baseVertex 로 보정)
+    std::vector<Vector3>  vertices;
+    std::vector<Triangle> triangles;
+    for (int m = 0; m < meshCount; ++m) {
+        const LodLevel& l = chain[firstLevel + m];
+        MeshRange r = { (GLuint)triangles.size() * 3, (GLuint)l.triangles.size() * 3,
+                        (GLint)(vertices.size() / 2) };
+        scene.meshes.push_back(r);
+        for (size_t i = 0; i < l.positions.size(); ++i) {
+            vertices.push_back(l.positions[i]);
+            vertices.push_back(i < l.normals.size() ? l.normals[i] : Vector3{ 0, 0, 1 });
+        }
+        triangles.insert(triangles.end(), l.triangles.begin(), l.triangles.end());
+    }
+
+    // 인스턴스 배치: 격자 + 무작위 회전, 메쉬/재질은 해시로 고른다
+    struct Placed { InstanceData data; int mesh; uint32_t key; };
+    std::vector<Placed> placed;
+    placed.reserve((size_t)gridSide * gridSide);
+    for (int z = 0; z < gridSide; ++z) {
+        for (int x = 0; x < gridSide; ++x) {
+            uint32_t h = hash32((uint32_t)(z * gridSide + x) + 1u);
+            int mesh = (int)(h % (uint32_t)meshCount);
+            int material = (int)((h >> 8) % kInstanceMaterials);
+            float yaw = (h >> 16) * (6.2831853f / 65536.0f);
+            float c = cosf(yaw), s = sinf(yaw);
+            float tx = (x - 0.5f * (gridSide - 1)) * spacing;
+            float tz = -z * spacing;
+
+            Placed p;
+            InstanceData& d = p.data;
+            d.row[0][0] = c;  d.row[0][1] = 0; d.row[0][2] = s;  d.row[0][3] = tx;
+            d.row[1][0] = 0;  d.row[1][1] = 1; d.row[1][2] = 0;  d.row[1][3] = 0;
+            d.row[2][0] = -s; d.row[2][1] = 0; d.row[2][2] = c;  d.row[2][3] = tz;
+            d.material = (float)material;
+            p.mesh = mesh;
+            p.key = (uint32_t)mesh * kInstanceMaterials + material;
+            placed.push_back(p);
+        }
+    }
+
+    // (메쉬, 재질) 로 정렬해서 묶음마다 연속 구간이 되게 하고, 구간마다 명령 하나
+    std::stable_sort(placed.begin(), placed.end(),
+        [](const Placed& a, const Placed& b) { return a.key < b.key; });
+    for (size_t i = 0; i < placed.size(); ++i) {
+        scene.instances.push_back(placed[i].data);
+        scene.instanceMesh.push_back(placed[i].mesh);
+        if (i == 0 || placed[i].key != placed[i - 1].key) {
+            const MeshRange& r = scene.meshes[placed[i].mesh];
+            DrawElementsIndirectCommand cmd = { r.indexCount, 0, r.firstIndex, r.baseVertex, (GLuint)i };
+            scene.commands.push_back(cmd);
+        }
+        scene.commands.back().instanceCount++;
+    }
+
+    glGenBuffers(1, &scene.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, scene.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vector3), vertices.data(), GL_STATIC_DRAW);
+
+    glGenBuffers(1, &scene.ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, triangles.size() * sizeof(Triangle), triangles.data(), GL_STATIC_DRAW);
+
+    glGenBuffers(1, &scene.instanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, scene.instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, scene.instances.size() * sizeof(InstanceData), scene.instances.data(), GL_STATIC_DRAW);
+
+    glGenBuffers(1, &scene.indirectBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, scene.indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, scene.commands.size() * sizeof(DrawElementsIndirectCommand),
+        scene.commands.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    gMultiDrawElementsIndirect = (MultiDrawElementsIndirectProc)glutGetProcAddress("glMultiDrawElementsIndirect");
+    scene.multiDrawIndirect = gMultiDrawElementsIndirect != nullptr;
+    // 대체 경로의 BaseInstance 그리기도 GL 4.2 라 없을 수 있다
+    scene.baseInstance = GLEW_ARB_base_instance && glDrawElementsInstancedBaseVertexBaseInstance != nullptr;
+
+    glUseProgram(program);
+    glUniform4fv(glGetUniformLocation(program, "uMaterials"), kInstanceMaterials, &kMaterialColors[0][0]);
+    glUseProgram(0);
+
+    printf("[Instancing] %lu instances of %d meshes, %lu indirect commands (%s)\n",
+        (unsigned long)scene.instances.size(), meshCount, (unsigned long)scene.commands.size(),
+        scene.multiDrawIndirect ? "glMultiDrawElementsIndirect"
+        : scene.baseInstance ? "fallback: one instanced draw per command"
+        : "fallback: one instanced draw per command, attribute offsets instead of baseInstance");
+}
+
+// ----------------------------------------------------------------------------
+// 그리기 공통: 메쉬 정점 속성
+// ----------------------------------------------------------------------------
+static void bind_mesh(const InstancedScene& scene) {
+    glUseProgram(scene.program);
+    glBindBuffer(GL_ARRAY_BUFFER, scene.vbo);
+    glEnableVertexAttribArray(ATTRIB_POSITION);
+    glVertexAttribPointer(ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vector3), (void*)0);
+    glEnableVertexAttribArray(ATTRIB_NORMAL);
+    glVertexAttribPointer(ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vector3), (void*)sizeof(Vector3));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene.ebo);
+}
+
+static void unbind_mesh() {
+    glDisableVertexAttribArray(ATTRIB_POSITION);
+    glDisableVertexAttribArray(ATTRIB_NORMAL);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
+
+// ----------------------------------------------------------------------------
+// indirect: 인스턴스 속성은 divisor 1, 명령의 baseInstance 가 각 묶음의 시작을 가리킨다
+// ----------------------------------------------------------------------------
+// 인스턴스 속성을 instanceVbo 의 firstInstance 번째부터 읽게 한다 (instanceVbo 가 묶여 있어야 한다)
+static void instance_attribs(size_t firstInstance) {
+    size_t base = firstInstance * sizeof(InstanceData);
+    for (int r = 0; r < 3; ++r)
+        glVertexAttribPointer(ATTRIB_MODEL_ROW0 + r, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+            (void*)(base + r * 4 * sizeof(float)));
+    glVertexAttribPointer(ATTRIB_MATERIAL, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+        (void*)(base + 12 * sizeof(float)));
+}
+
+int draw_instanced_indirect(const InstancedScene& scene) {
+    bind_mesh(scene);
+
+    glBindBuffer(GL_ARRAY_BUFFER, scene.instanceVbo);
+    for (int a = ATTRIB_MODEL_ROW0; a <= ATTRIB_MATERIAL; ++a) {
+        glEnableVertexAttribArray(a);
+        glVertexAttribDivisor(a, 1);
+    }
+    instance_attribs(0);
+
+    int calls = 0;
+    if (scene.multiDrawIndirect) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, scene.indirectBuffer);
+        gMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0,
+            (GLsizei)scene.commands.size(), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        calls = 1;
+    }
+    else if (scene.baseInstance) {
+        for (const DrawElementsIndirectCommand& c : scene.commands) {
+            glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, c.count, GL_UNSIGNED_INT,
+                (void*)(c.firstIndex * sizeof(GLuint)), c.instanceCount, c.baseVertex, c.baseInstance);
+            calls++;
+        }
+    }
+    else {
+        // baseInstance 없이: 속성 포인터를 묶음 시작으로 옮기고 GL 3.2 BaseVertex 그리기
+        for (const DrawElementsIndirectCommand& c : scene.commands) {
+            instance_attribs(c.baseInstance);
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, c.count, GL_UNSIGNED_INT,
+                (void*)(c.firstIndex * sizeof(GLuint)), c.instanceCount, c.baseVertex);
+            calls++;
+        }
+    }
+
+    for (int a = ATTRIB_MODEL_ROW0; a <= ATTRIB_MATERIAL; ++a) {
+        glVertexAttribDivisor(a, 0);
+        glDisableVertexAttribArray(a);
+    }
+    unbind_mesh();
+    return calls;
+}
+
+// ----------------------------------------------------------------------------
+// 비교용: 객체마다 인스턴스 속성을 상수 attribute 로 넣고 그리기 한 번
+// ----------------------------------------------------------------------------
+int draw_instanced_per_object(const InstancedScene& scene) {
+    bind_mesh(scene);
+
+    for (size_t i = 0; i < scene.instances.size(); ++i) {
+        const InstanceData& d = scene.instances[i];
+        const MeshRange& r = scene.meshes[scene.instanceMesh[i]];
+        glVertexAttrib4fv(ATTRIB_MODEL_ROW0, d.row[0]);
+        glVertexAttrib4fv(ATTRIB_MODEL_ROW1, d.row[1]);
+        glVertexAttrib4fv(ATTRIB_MODEL_ROW2, d.row[2]);
+        glVertexAttrib1f(ATTRIB_MATERIAL, d.material);
+        glDrawElementsBaseVertex(GL_TRIANGLES, r.indexCount, GL_UNSIGNED_INT,
+            (void*)(r.firstIndex * sizeof(GLuint)), r.baseVertex);
+    }
+
+    unbind_mesh();
+    return (int)scene.instances.size();
+}
@@ -0,0 +1,63 @@
+﻿#pragma once
+#include <vector>
+#include <GL/glew.h>
+#include "mesh_simplify.h"
+
+// ----------------------------------------------------------------------------
+// 인스턴싱: 몇 개의 메쉬(LOD 단계)를 수천 개 배치한 장면
+//   인스턴스별 변환(3x4 행렬)과 재질 번호는 instanced VBO (divisor 1) 에 두고,
+//   (메쉬, 재질) 묶음마다 indirect 명령 하나를 만들어 glMultiDrawElementsIndirect
+//   한 번으로 제출한다. 비교용으로 객체마다 glDrawElementsBaseVertex 를 부르는 경로도 있다.
+// ----------------------------------------------------------------------------
+const int kInstanceMaterials = 8;
+
+// Instanced.vert 의 attribute 위치
+enum InstanceAttrib {
+    ATTRIB_POSITION = 0, ATTRIB_NORMAL = 1,
+    ATTRIB_MODEL_ROW0 = 2, ATTRIB_MODEL_ROW1 = 3, ATTRIB_MODEL_ROW2 = 4,
+    ATTRIB_MATERIAL = 5
+};
+
+struct InstanceData {
+    float row[3][4];   // 객체 -> 월드 (row-major 3x4)
+    float material;    // 재질 테이블 번호
+};
+
+// GL 4.3 DrawElementsIndirectCommand 와 같은 배치
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint  baseVertex;
+    GLuint baseInstance;
+};
+
+struct MeshRange {
+    GLuint firstIndex;
+    GLuint indexCount;
+    GLint  baseVertex;
+};
+
+struct InstancedScene {
+    GLuint program;
+    GLuint vbo, ebo;            // 모든 메쉬를 이어 붙인 정점(위치, 노멀 교차)/인덱스
+    GLuint instanceVbo;
+    GLuint indirectBuffer;
+
+    std::vector<MeshRange>    meshes;
+    std::vector<InstanceData> instances;      // (메쉬, 재질) 순으로 정렬됨
+    std::vector<int>          instanceMesh;
+    std::vector<DrawElementsIndirectCommand> commands;
+    bool multiDrawIndirect;                   // false 면 명령마다 인스턴스 그리기
+    bool baseInstance;                        // ARB_base_instance. 없으면 인스턴스 속성 오프셋으로 흉내
+};
+
+// chain[firstLevel .. firstLevel+meshCount) 을 메쉬로 쓰고, gridSide x gridSide 격자에
+// 객체 공간 간격 spacing 으로 배치한다. program 은 Instanced.vert 로 만든 것.
+void init_instanced_scene(InstancedScene& scene, GLuint program,
+                          const std::vector<LodLevel>& chain, int firstLevel, int meshCount,
+                          int gridSide, float spacing);
+
+// 둘 다 실제로 부른 GL 그리기 호출 수를 돌려준다
+int draw_instanced_indirect(const InstancedScene& scene);
+int draw_instanced_per_object(const InstancedScene& scene);
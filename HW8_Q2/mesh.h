@@ -0,0 +1,12 @@
+﻿#pragma once
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// 메쉬 공용 타입 (HW8_Q2.cpp 및 보조 모듈에서 공유)
+// ----------------------------------------------------------------------------
+struct Vector3 { float x, y, z; };
+struct Triangle { unsigned int indices[3]; };
+
+extern std::vector<Vector3>  gPositions;
+extern std::vector<Vector3>  gNormals;
+extern std::vector<Triangle> gTriangles;
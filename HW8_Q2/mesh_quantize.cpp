@@ -0,0 +1,176 @@
+﻿#include "mesh_quantize.h"
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+#include <chrono>
+#include <algorithm>
+
+// ----------------------------------------------------------------------------
+// snorm16 변환
+// ----------------------------------------------------------------------------
+static int16_t to_snorm16(float v) {
+    v = std::max(-1.0f, std::min(1.0f, v));
+    return (int16_t)lroundf(v * 32767.0f);
+}
+
+static float from_snorm16(int16_t v) {
+    return std::max(v / 32767.0f, -1.0f);
+}
+
+static float sign_not_zero(float v) { return v >= 0.0f ? 1.0f : -1.0f; }
+
+// ----------------------------------------------------------------------------
+// 옥타헤드럴 노멀 인코딩/디코딩
+// ----------------------------------------------------------------------------
+void oct_encode(const Vector3& n, int16_t& ox, int16_t& oy) {
+    float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+    if (l1 == 0.0f) {
+        // 길이 0 노멀 (퇴화 면, vn 없는 평균) 은 +Z 로
+        ox = oy = 0;
+        return;
+    }
+    float x = n.x / l1, y = n.y / l1;
+    if (n.z < 0.0f) {
+        float tx = (1.0f - fabsf(y)) * sign_not_zero(x);
+        float ty = (1.0f - fabsf(x)) * sign_not_zero(y);
+        x = tx; y = ty;
+    }
+    ox = to_snorm16(x);
+    oy = to_snorm16(y);
+}
+
+Vector3 oct_decode(int16_t ox, int16_t oy) {
+    float x = from_snorm16(ox), y = from_snorm16(oy);
+    float z = 1.0f - fabsf(x) - fabsf(y);
+    if (z < 0.0f) {
+        float tx = (1.0f - fabsf(y)) * sign_not_zero(x);
+        float ty = (1.0f - fabsf(x)) * sign_not_zero(y);
+        x = tx; y = ty;
+    }
+    float len = sqrtf(x * x + y * y + z * z);
+    return { x / len, y / len, z / len };
+}
+
+// ----------------------------------------------------------------------------
+// 메쉬 양자화
+// ----------------------------------------------------------------------------
+void quantize_mesh(const std::vector<Vector3>& positions,
+                   const std::vector<Vector3>& normals,
+                   const std::vector<Triangle>& triangles,
+                   QuantizedMesh& out) {
+    Vector3 bmin = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Vector3 bmax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vector3& p : positions) {
+        bmin.x = std::min(bmin.x, p.x); bmax.x = std::max(bmax.x, p.x);
+        bmin.y = std::min(bmin.y, p.y); bmax.y = std::max(bmax.y, p.y);
+        bmin.z = std::min(bmin.z, p.z); bmax.z = std::max(bmax.z, p.z);
+    }
+    out.center = { (bmin.x + bmax.x) * 0.5f, (bmin.y + bmax.y) * 0.5f, (bmin.z + bmax.z) * 0.5f };
+    // 축 길이가 0 인 경우 나눗셈 방지
+    out.halfExtent = { std::max((bmax.x - bmin.x) * 0.5f, 1e-20f),
+                       std::max((bmax.y - bmin.y) * 0.5f, 1e-20f),
+                       std::max((bmax.z - bmin.z) * 0.5f, 1e-20f) };
+
+    out.vertices.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const Vector3& p = positions[i];
+        PackedVertex& v = out.vertices[i];
+        v.px = to_snorm16((p.x - out.center.x) / out.halfExtent.x);
+        v.py = to_snorm16((p.y - out.center.y) / out.halfExtent.y);
+        v.pz = to_snorm16((p.z - out.center.z) / out.halfExtent.z);
+        v.pad = 0;
+        Vector3 n = i < normals.size() ? normals[i] : Vector3{ 0, 0, 1 };
+        oct_encode(n, v.nx, v.ny);
+    }
+
+    // 정점 수가 허용하면 32bit -> 16bit 인덱스로 축소
+    out.indices16.clear();
+    out.indices32.clear();
+    if (positions.size() <= 65536) {
+        out.indices16.reserve(triangles.size() * 3);
+        for (const Triangle& t : triangles)
+            for (int k = 0; k < 3; ++k) out.indices16.push_back((uint16_t)t.indices[k]);
+    }
+    else {
+        out.indices32.reserve(triangles.size() * 3);
+        for (const Triangle& t : triangles)
+            for (int k = 0; k < 3; ++k) out.indices32.push_back(t.indices[k]);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// 소프트웨어 디코딩
+// ----------------------------------------------------------------------------
+Vector3 decode_position(const QuantizedMesh& mesh, const PackedVertex& v) {
+    return { mesh.center.x + from_snorm16(v.px) * mesh.halfExtent.x,
+             mesh.center.y + from_snorm16(v.py) * mesh.halfExtent.y,
+             mesh.center.z + from_snorm16(v.pz) * mesh.halfExtent.z };
+}
+
+Vector3 decode_normal(const PackedVertex& v) {
+    return oct_decode(v.nx, v.ny);
+}
+
+void decode_mesh(const QuantizedMesh& mesh,
+                 std::vector<Vector3>& positions,
+                 std::vector<Vector3>& normals) {
+    positions.resize(mesh.vertices.size());
+    normals.resize(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        positions[i] = decode_position(mesh, mesh.vertices[i]);
+        normals[i] = decode_normal(mesh.vertices[i]);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// 품질 오차 / 대역폭 리포트
+// ----------------------------------------------------------------------------
+void report_quantization(const QuantizedMesh& mesh,
+                         const std::vector<Vector3>& positions,
+                         const std::vector<Vector3>& normals) {
+    std::vector<Vector3> dp, dn;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    decode_mesh(mesh, dp, dn);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    double decodeSec = std::chrono::duration<double>(t1 - t0).count();
+
+    double maxPosErr = 0, sumPosErr = 0;
+    double maxAngle = 0, sumAngle = 0;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        double ex = dp[i].x - positions[i].x;
+        double ey = dp[i].y - positions[i].y;
+        double ez = dp[i].z - positions[i].z;
+        double e = sqrt(ex * ex + ey * ey + ez * ez);
+        maxPosErr = std::max(maxPosErr, e);
+        sumPosErr += e;
+
+        if (i < normals.size()) {
+            const Vector3& n = normals[i];
+            double len = sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+            double c = (n.x * dn[i].x + n.y * dn[i].y + n.z * dn[i].z) / len;
+            double a = acos(std::max(-1.0, std::min(1.0, c))) * 180.0 / 3.14159265358979;
+            maxAngle = std::max(maxAngle, a);
+            sumAngle += a;
+        }
+    }
+    size_t n = std::max<size_t>(positions.size(), 1);
+    double diag = 2.0 * sqrt((double)mesh.halfExtent.x * mesh.halfExtent.x
+                           + (double)mesh.halfExtent.y * mesh.halfExtent.y
+                           + (double)mesh.halfExtent.z * mesh.halfExtent.z);
+
+    size_t rawVertexBytes = positions.size() * sizeof(Vector3) + normals.size() * sizeof(Vector3);
+    size_t rawIndexBytes = mesh.indexCount() * sizeof(unsigned int);
+    size_t packedBytes = mesh.vertexBytes() + mesh.indexBytes();
+
+    printf("[Quantize] vertex %lu -> %lu bytes, index %lu -> %lu bytes (%s), total %.1f%%\n",
+        (unsigned long)rawVertexBytes, (unsigned long)mesh.vertexBytes(),
+        (unsigned long)rawIndexBytes, (unsigned long)mesh.indexBytes(),
+        mesh.use16BitIndices() ? "16bit" : "32bit",
+        100.0 * packedBytes / std::max<size_t>(rawVertexBytes + rawIndexBytes, 1));
+    printf("[Quantize] position error: max %.3e, avg %.3e (max %.2e of bbox diagonal)\n",
+        maxPosErr, sumPosErr / n, maxPosErr / diag);
+    printf("[Quantize] normal error: max %.4f deg, avg %.4f deg\n",
+        maxAngle, sumAngle / n);
+    printf("[Quantize] CPU decode: %.2f Mverts/s\n",
+        decodeSec > 0 ? mesh.vertices.size() / decodeSec * 1e-6 : 0.0);
+}
@@ -0,0 +1,49 @@
+﻿#pragma once
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+#include "mesh.h"
+
+// ----------------------------------------------------------------------------
+// 압축 정점 포맷
+//   위치: 메쉬 bbox 기준 snorm16 x3 (+패딩) -> p = center + q/32767 * halfExtent
+//   노멀: 옥타헤드럴 인코딩 snorm16 x2
+//   => 정점당 12 bytes (float 위치+노멀 24 bytes 대비 1/2)
+// ----------------------------------------------------------------------------
+struct PackedVertex {
+    int16_t px, py, pz, pad;
+    int16_t nx, ny;
+};
+
+struct QuantizedMesh {
+    std::vector<PackedVertex> vertices;
+    std::vector<uint16_t>     indices16;   // 정점 수 <= 65536 일 때 사용
+    std::vector<uint32_t>     indices32;   // 그 외
+    Vector3 center;
+    Vector3 halfExtent;
+
+    bool   use16BitIndices() const { return !indices16.empty(); }
+    size_t indexCount() const { return use16BitIndices() ? indices16.size() : indices32.size(); }
+    size_t vertexBytes() const { return vertices.size() * sizeof(PackedVertex); }
+    size_t indexBytes() const { return use16BitIndices() ? indices16.size() * 2 : indices32.size() * 4; }
+};
+
+void    oct_encode(const Vector3& n, int16_t& ox, int16_t& oy);
+Vector3 oct_decode(int16_t ox, int16_t oy);
+
+void    quantize_mesh(const std::vector<Vector3>& positions,
+                      const std::vector<Vector3>& normals,
+                      const std::vector<Triangle>& triangles,
+                      QuantizedMesh& out);
+
+// 소프트웨어 정점 단계 디코딩 (GL 셰이더의 Quantized.vert 와 동일한 식)
+Vector3 decode_position(const QuantizedMesh& mesh, const PackedVertex& v);
+Vector3 decode_normal(const PackedVertex& v);
+void    decode_mesh(const QuantizedMesh& mesh,
+                    std::vector<Vector3>& positions,
+                    std::vector<Vector3>& normals);
+
+// 원본 대비 위치/노멀 오차와 대역폭, CPU 디코딩 속도를 출력
+void    report_quantization(const QuantizedMesh& mesh,
+                            const std::vector<Vector3>& positions,
+                            const std::vector<Vector3>& normals);
@@ -0,0 +1,330 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include "mesh_simplify.h"
+#include <stdio.h>
+#include <math.h>
+#include <map>
+#include <queue>
+#include <algorithm>
+
+// ----------------------------------------------------------------------------
+// 대칭 4x4 quadric (xx xy xz xw yy yz yw zz zw ww)
+// ----------------------------------------------------------------------------
+struct Quadric {
+    double q[10];
+};
+
+static void quadric_add_plane(Quadric& Q, double a, double b, double c, double d, double w) {
+    Q.q[0] += w * a * a; Q.q[1] += w * a * b; Q.q[2] += w * a * c; Q.q[3] += w * a * d;
+    Q.q[4] += w * b * b; Q.q[5] += w * b * c; Q.q[6] += w * b * d;
+    Q.q[7] += w * c * c; Q.q[8] += w * c * d;
+    Q.q[9] += w * d * d;
+}
+
+static Quadric quadric_sum(const Quadric& A, const Quadric& B) {
+    Quadric R;
+    for (int i = 0; i < 10; ++i) R.q[i] = A.q[i] + B.q[i];
+    return R;
+}
+
+static double quadric_eval(const Quadric& Q, const Vector3& p) {
+    double x = p.x, y = p.y, z = p.z;
+    return Q.q[0] * x * x + 2 * Q.q[1] * x * y + 2 * Q.q[2] * x * z + 2 * Q.q[3] * x
+         + Q.q[4] * y * y + 2 * Q.q[5] * y * z + 2 * Q.q[6] * y
+         + Q.q[7] * z * z + 2 * Q.q[8] * z
+         + Q.q[9];
+}
+
+// 오차를 최소로 하는 위치 (3x3 선형계). 특이 행렬이면 false.
+static bool quadric_optimal(const Quadric& Q, Vector3& out) {
+    double a = Q.q[0], b = Q.q[1], c = Q.q[2];
+    double d = Q.q[4], e = Q.q[5], f = Q.q[7];
+    double det = a * (d * f - e * e) - b * (b * f - e * c) + c * (b * e - d * c);
+    if (fabs(det) < 1e-12) return false;
+    double rx = -Q.q[3], ry = -Q.q[6], rz = -Q.q[8];
+    out.x = (float)((rx * (d * f - e * e) - b * (ry * f - e * rz) + c * (ry * e - d * rz)) / det);
+    out.y = (float)((a * (ry * f - e * rz) - rx * (b * f - e * c) + c * (b * rz - ry * c)) / det);
+    out.z = (float)((a * (d * rz - ry * e) - b * (b * rz - ry * c) + rx * (b * e - d * c)) / det);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// 벡터 유틸
+// ----------------------------------------------------------------------------
+static Vector3 sub(const Vector3& a, const Vector3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static Vector3 cross3(const Vector3& a, const Vector3& b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+static float dot3(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static float length3(const Vector3& a) { return sqrtf(dot3(a, a)); }
+
+// ----------------------------------------------------------------------------
+// 엣지 축약 후보
+// ----------------------------------------------------------------------------
+struct Collapse {
+    double cost;
+    unsigned int v0, v1;
+    unsigned int version0, version1;
+    Vector3 target;
+    bool operator<(const Collapse& o) const { return cost > o.cost; } // min-heap
+};
+
+struct Simplifier {
+    std::vector<Vector3>  pos;
+    std::vector<Quadric>  quadrics;
+    std::vector<Triangle> tris;
+    std::vector<char>     triAlive;
+    std::vector<char>     vertAlive;
+    std::vector<unsigned int> version;
+    std::vector<std::vector<unsigned int>> vertTris;
+    std::priority_queue<Collapse> heap;
+    size_t liveTriangles;
+    double maxCost;
+
+    void init(const std::vector<Vector3>& positions, const std::vector<Triangle>& triangles);
+    void push_edge(unsigned int v0, unsigned int v1);
+    bool flips(unsigned int v, unsigned int other, const Vector3& target) const;
+    bool collapse(const Collapse& c);
+    void snapshot(LodLevel& level) const;
+};
+
+void Simplifier::init(const std::vector<Vector3>& positions, const std::vector<Triangle>& triangles) {
+    pos = positions;
+    tris = triangles;
+    triAlive.assign(tris.size(), 1);
+    vertAlive.assign(pos.size(), 1);
+    version.assign(pos.size(), 0);
+    vertTris.assign(pos.size(), std::vector<unsigned int>());
+    quadrics.assign(pos.size(), Quadric{});
+    liveTriangles = tris.size();
+    maxCost = 0.0;
+
+    // 면 평면 quadric
+    std::map<std::pair<unsigned int, unsigned int>, int> edgeUse;
+    for (size_t t = 0; t < tris.size(); ++t) {
+        const unsigned int* idx = tris[t].indices;
+        Vector3 n = cross3(sub(pos[idx[1]], pos[idx[0]]), sub(pos[idx[2]], pos[idx[0]]));
+        float len = length3(n);
+        for (int k = 0; k < 3; ++k) vertTris[idx[k]].push_back((unsigned int)t);
+        for (int k = 0; k < 3; ++k) {
+            unsigned int a = idx[k], b = idx[(k + 1) % 3];
+            edgeUse[{ std::min(a, b), std::max(a, b) }]++;
+        }
+        if (len <= 0.0f) continue;
+        n = { n.x / len, n.y / len, n.z / len };
+        double d = -dot3(n, pos[idx[0]]);
+        for (int k = 0; k < 3; ++k) quadric_add_plane(quadrics[idx[k]], n.x, n.y, n.z, d, 1.0);
+    }
+
+    // 경계 엣지는 수직 평면으로 가중치를 줘서 구멍이 커지지 않게 한다
+    for (size_t t = 0; t < tris.size(); ++t) {
+        const unsigned int* idx = tris[t].indices;
+        Vector3 fn = cross3(sub(pos[idx[1]], pos[idx[0]]), sub(pos[idx[2]], pos[idx[0]]));
+        for (int k = 0; k < 3; ++k) {
+            unsigned int a = idx[k], b = idx[(k + 1) % 3];
+            if (edgeUse[{ std::min(a, b), std::max(a, b) }] != 1) continue;
+            Vector3 n = cross3(sub(pos[b], pos[a]), fn);
+            float len = length3(n);
+            if (len <= 0.0f) continue;
+            n = { n.x / len, n.y / len, n.z / len };
+            double d = -dot3(n, pos[a]);
+            quadric_add_plane(quadrics[a], n.x, n.y, n.z, d, 10.0);
+            quadric_add_plane(quadrics[b], n.x, n.y, n.z, d, 10.0);
+        }
+    }
+
+    for (const auto& e : edgeUse) push_edge(e.first.first, e.first.second);
+}
+
+void Simplifier::push_edge(unsigned int v0, unsigned int v1) {
+    Quadric Q = quadric_sum(quadrics[v0], quadrics[v1]);
+    Collapse c;
+    c.v0 = v0; c.v1 = v1;
+    c.version0 = version[v0]; c.version1 = version[v1];
+
+    Vector3 mid = { (pos[v0].x + pos[v1].x) * 0.5f, (pos[v0].y + pos[v1].y) * 0.5f, (pos[v0].z + pos[v1].z) * 0.5f };
+    Vector3 candidates[4] = { pos[v0], pos[v1], mid, mid };
+    int count = quadric_optimal(Q, candidates[3]) ? 4 : 3;
+
+    c.cost = 1e300;
+    for (int i = 0; i < count; ++i) {
+        double e = quadric_eval(Q, candidates[i]);
+        if (e < c.cost) { c.cost = e; c.target = candidates[i]; }
+    }
+    c.cost = std::max(c.cost, 0.0);
+    heap.push(c);
+}
+
+// v 를 target 으로 옮겼을 때 (other 와 공유하지 않는) 주변 삼각형이 뒤집히는지 검사
+bool Simplifier::flips(unsigned int v, unsigned int other, const Vector3& target) const {
+    for (unsigned int t : vertTris[v]) {
+        if (!triAlive[t]) continue;
+        const unsigned int* idx = tris[t].indices;
+        if (idx[0] == other || idx[1] == other || idx[2] == other) continue;
+
+        Vector3 p[3], q[3];
+        for (int k = 0; k < 3; ++k) {
+            p[k] = pos[idx[k]];
+            q[k] = idx[k] == v ? target : p[k];
+        }
+        Vector3 n0 = cross3(sub(p[1], p[0]), sub(p[2], p[0]));
+        Vector3 n1 = cross3(sub(q[1], q[0]), sub(q[2], q[0]));
+        if (dot3(n0, n1) <= 0.2f * length3(n0) * length3(n1)) return true;
+    }
+    return false;
+}
+
+bool Simplifier::collapse(const Collapse& c) {
+    unsigned int v0 = c.v0, v1 = c.v1;
+    if (!vertAlive[v0] || !vertAlive[v1]) return false;
+    if (version[v0] != c.version0 || version[v1] != c.version1) return false;
+    if (flips(v0, v1, c.target) || flips(v1, v0, c.target)) return false;
+
+    pos[v0] = c.target;
+    quadrics[v0] = quadric_sum(quadrics[v0], quadrics[v1]);
+    for (unsigned int t : vertTris[v1]) {
+        if (!triAlive[t]) continue;
+        unsigned int* idx = tris[t].indices;
+        if (idx[0] == v0 || idx[1] == v0 || idx[2] == v0) {
+            triAlive[t] = 0;
+            liveTriangles--;
+            continue;
+        }
+        for (int k = 0; k < 3; ++k)
+            if (idx[k] == v1) idx[k] = v0;
+        vertTris[v0].push_back(t);
+    }
+    vertAlive[v1] = 0;
+    vertTris[v1].clear();
+    version[v0]++;
+    maxCost = std::max(maxCost, c.cost);
+
+    // 죽은 삼각형 정리 후 이웃 엣지 비용 갱신
+    std::vector<unsigned int>& adj = vertTris[v0];
+    adj.erase(std::remove_if(adj.begin(), adj.end(),
+        [this](unsigned int t) { return !triAlive[t]; }), adj.end());
+
+    std::vector<unsigned int> neighbors;
+    for (unsigned int t : adj)
+        for (int k = 0; k < 3; ++k)
+            if (tris[t].indices[k] != v0) neighbors.push_back(tris[t].indices[k]);
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    for (unsigned int n : neighbors) push_edge(v0, n);
+    return true;
+}
+
+void Simplifier::snapshot(LodLevel& level) const {
+    std::vector<unsigned int> remap(pos.size(), 0xFFFFFFFFu);
+    level.positions.clear();
+    level.triangles.clear();
+    for (size_t t = 0; t < tris.size(); ++t) {
+        if (!triAlive[t]) continue;
+        Triangle nt;
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = tris[t].indices[k];
+            if (remap[v] == 0xFFFFFFFFu) {
+                remap[v] = (unsigned int)level.positions.size();
+                level.positions.push_back(pos[v]);
+            }
+            nt.indices[k] = remap[v];
+        }
+        level.triangles.push_back(nt);
+    }
+
+    // 면적 가중 정점 노멀 재계산
+    level.normals.assign(level.positions.size(), Vector3{ 0, 0, 0 });
+    for (const Triangle& t : level.triangles) {
+        const Vector3& a = level.positions[t.indices[0]];
+        Vector3 n = cross3(sub(level.positions[t.indices[1]], a), sub(level.positions[t.indices[2]], a));
+        for (int k = 0; k < 3; ++k) {
+            Vector3& vn = level.normals[t.indices[k]];
+            vn = { vn.x + n.x, vn.y + n.y, vn.z + n.z };
+        }
+    }
+    for (Vector3& n : level.normals) {
+        float len = length3(n);
+        if (len > 0.0f) n = { n.x / len, n.y / len, n.z / len };
+    }
+    level.error = (float)sqrt(maxCost);
+}
+
+// ----------------------------------------------------------------------------
+// LOD 체인 생성
+// ----------------------------------------------------------------------------
+void build_lod_chain(const std::vector<Vector3>& positions,
+                     const std::vector<Vector3>& normals,
+                     const std::vector<Triangle>& triangles,
+                     int maxLevels, size_t minTriangles,
+                     std::vector<LodLevel>& chain) {
+    chain.clear();
+    LodLevel base;
+    base.positions = positions;
+    base.normals = normals;
+    base.triangles = triangles;
+    base.error = 0.0f;
+    chain.push_back(base);
+
+    Simplifier s;
+    s.init(positions, triangles);
+
+    size_t target = triangles.size() / 2;
+    while ((int)chain.size() < maxLevels && target >= minTriangles) {
+        while (s.liveTriangles > target && !s.heap.empty()) {
+            Collapse c = s.heap.top();
+            s.heap.pop();
+            s.collapse(c);
+        }
+        if (s.liveTriangles >= chain.back().triangles.size()) break; // 더 이상 줄일 수 없음
+        LodLevel level;
+        s.snapshot(level);
+        chain.push_back(level);
+        target /= 2;
+    }
+
+    for (size_t i = 0; i < chain.size(); ++i)
+        printf("[LOD] level %lu: %lu tris, error %.3e\n",
+            (unsigned long)i, (unsigned long)chain[i].triangles.size(), chain[i].error);
+}
+
+void save_lod_chain(const std::string& sourceFile, const std::vector<LodLevel>& chain) {
+    std::string base = sourceFile;
+    size_t dot = base.rfind('.');
+    if (dot != std::string::npos) base = base.substr(0, dot);
+
+    for (size_t i = 1; i < chain.size(); ++i) {
+        char fn[512];
+        sprintf(fn, "%s.lod%lu.obj", base.c_str(), (unsigned long)i);
+        FILE* f = fopen(fn, "w");
+        if (!f) {
+            printf("ERROR: cannot write %s\n", fn);
+            continue;
+        }
+        const LodLevel& l = chain[i];
+        fprintf(f, "# LOD %lu of %s, error %g\n", (unsigned long)i, sourceFile.c_str(), l.error);
+        for (const Vector3& p : l.positions) fprintf(f, "v %f %f %f\n", p.x, p.y, p.z);
+        for (const Vector3& n : l.normals) fprintf(f, "vn %f %f %f\n", n.x, n.y, n.z);
+        for (const Triangle& t : l.triangles)
+            fprintf(f, "f %u//%u %u//%u %u//%u\n",
+                t.indices[0] + 1, t.indices[0] + 1,
+                t.indices[1] + 1, t.indices[1] + 1,
+                t.indices[2] + 1, t.indices[2] + 1);
+        fclose(f);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// 화면 공간 오차 기반 LOD 선택
+// ----------------------------------------------------------------------------
+int select_lod(const std::vector<LodLevel>& chain, float distance,
+               float pixelsPerUnit, float pixelBudget, float* projectedError) {
+    distance = std::max(distance, 1e-6f);
+    for (int i = (int)chain.size() - 1; i > 0; --i) {
+        float err = chain[i].error * pixelsPerUnit / distance;
+        if (err <= pixelBudget) {
+            if (projectedError) *projectedError = err;
+            return i;
+        }
+    }
+    if (projectedError) *projectedError = 0.0f;
+    return 0;
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include "mesh.h"
+
+// ----------------------------------------------------------------------------
+// LOD 단계: 단순화된 메쉬와 객체 공간 기하 오차
+// ----------------------------------------------------------------------------
+struct LodLevel {
+    std::vector<Vector3>  positions;
+    std::vector<Vector3>  normals;
+    std::vector<Triangle> triangles;
+    float error;   // 원본 대비 최대 오차 추정치 (quadric 오차의 제곱근, 객체 공간 단위)
+};
+
+// Quadric error metric 엣지 축약으로 100%, 50%, 25%, ... 의 LOD 체인을 만든다.
+// 삼각형 수가 minTriangles 보다 작아지면 중단한다.
+void build_lod_chain(const std::vector<Vector3>& positions,
+                     const std::vector<Vector3>& normals,
+                     const std::vector<Triangle>& triangles,
+                     int maxLevels, size_t minTriangles,
+                     std::vector<LodLevel>& chain);
+
+// "bunny.obj" -> "bunny.lod1.obj", "bunny.lod2.obj", ... 로 저장 (load_mesh 와 같은 v/vn/f 형식)
+void save_lod_chain(const std::string& sourceFile, const std::vector<LodLevel>& chain);
+
+// 화면 공간 오차(픽셀)가 budget 이하인 가장 거친 단계를 고른다.
+//   pixelsPerUnit: 거리 1 에서 객체 공간 1 단위가 차지하는 픽셀 수
+int select_lod(const std::vector<LodLevel>& chain, float distance,
+               float pixelsPerUnit, float pixelBudget, float* projectedError);
@@ -0,0 +1,221 @@
+﻿#include "meshlet.h"
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+#include <algorithm>
+
+// ----------------------------------------------------------------------------
+// 벡터 유틸
+// ----------------------------------------------------------------------------
+static Vector3 sub(const Vector3& a, const Vector3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+static float   dot3(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static float   length3(const Vector3& a) { return sqrtf(dot3(a, a)); }
+static Vector3 cross3(const Vector3& a, const Vector3& b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+// 10bit x 3 Morton 코드 (삼각형을 공간적으로 가까운 순서로 정렬하기 위함)
+static uint32_t expand_bits(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+static uint32_t morton3(float x, float y, float z) {
+    uint32_t ix = (uint32_t)std::min(std::max(x * 1024.0f, 0.0f), 1023.0f);
+    uint32_t iy = (uint32_t)std::min(std::max(y * 1024.0f, 0.0f), 1023.0f);
+    uint32_t iz = (uint32_t)std::min(std::max(z * 1024.0f, 0.0f), 1023.0f);
+    return (expand_bits(ix) << 2) | (expand_bits(iy) << 1) | expand_bits(iz);
+}
+
+// ----------------------------------------------------------------------------
+// 메쉬릿 바운딩 스피어 / 노멀 콘 계산
+// ----------------------------------------------------------------------------
+static void compute_bounds(const std::vector<Vector3>& positions,
+                           const Triangle* tris, Meshlet& m) {
+    Vector3 bmin = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Vector3 bmax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    Vector3 axis = { 0, 0, 0 };
+    std::vector<Vector3> normals;
+    normals.reserve(m.triangleCount);
+
+    for (unsigned int i = 0; i < m.triangleCount; ++i) {
+        const Vector3& a = positions[tris[i].indices[0]];
+        const Vector3& b = positions[tris[i].indices[1]];
+        const Vector3& c = positions[tris[i].indices[2]];
+        for (const Vector3* p : { &a, &b, &c }) {
+            bmin.x = std::min(bmin.x, p->x); bmax.x = std::max(bmax.x, p->x);
+            bmin.y = std::min(bmin.y, p->y); bmax.y = std::max(bmax.y, p->y);
+            bmin.z = std::min(bmin.z, p->z); bmax.z = std::max(bmax.z, p->z);
+        }
+        Vector3 n = cross3(sub(b, a), sub(c, a));
+        float len = length3(n);
+        if (len <= 0.0f) continue; // 퇴화 삼각형은 콘 계산에서 제외
+        n = { n.x / len, n.y / len, n.z / len };
+        normals.push_back(n);
+        axis = { axis.x + n.x, axis.y + n.y, axis.z + n.z };
+    }
+
+    m.center = { (bmin.x + bmax.x) * 0.5f, (bmin.y + bmax.y) * 0.5f, (bmin.z + bmax.z) * 0.5f };
+    m.radius = 0.0f;
+    for (unsigned int i = 0; i < m.triangleCount; ++i)
+        for (int k = 0; k < 3; ++k)
+            m.radius = std::max(m.radius, length3(sub(positions[tris[i].indices[k]], m.center)));
+
+    float axisLen = length3(axis);
+    m.coneAxis = axisLen > 0.0f ? Vector3{ axis.x / axisLen, axis.y / axisLen, axis.z / axisLen }
+                                : Vector3{ 0, 0, 1 };
+    float minDot = axisLen > 0.0f ? 1.0f : -1.0f;
+    for (const Vector3& n : normals)
+        minDot = std::min(minDot, dot3(n, m.coneAxis));
+
+    // 콘이 반구에 가까우면 뒷면 판정이 의미 없으므로 컬링 불가로 표시
+    m.coneCutoff = minDot <= 0.1f ? 1.0f : sqrtf(1.0f - minDot * minDot);
+}
+
+// ----------------------------------------------------------------------------
+// 메쉬릿 생성
+// ----------------------------------------------------------------------------
+void build_meshlets(const std::vector<Vector3>& positions,
+                    const std::vector<Triangle>& triangles,
+                    std::vector<Meshlet>& meshlets,
+                    std::vector<Triangle>& outTriangles) {
+    meshlets.clear();
+    outTriangles.clear();
+    if (triangles.empty()) return;
+
+    // 1) 삼각형 중심의 Morton 순서로 정렬해 클러스터가 공간적으로 뭉치도록 한다
+    Vector3 bmin = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Vector3 bmax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const Vector3& p : positions) {
+        bmin.x = std::min(bmin.x, p.x); bmax.x = std::max(bmax.x, p.x);
+        bmin.y = std::min(bmin.y, p.y); bmax.y = std::max(bmax.y, p.y);
+        bmin.z = std::min(bmin.z, p.z); bmax.z = std::max(bmax.z, p.z);
+    }
+    Vector3 ext = { std::max(bmax.x - bmin.x, 1e-20f),
+                    std::max(bmax.y - bmin.y, 1e-20f),
+                    std::max(bmax.z - bmin.z, 1e-20f) };
+
+    std::vector<std::pair<uint32_t, unsigned int>> order(triangles.size());
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        const Vector3& a = positions[triangles[i].indices[0]];
+        const Vector3& b = positions[triangles[i].indices[1]];
+        const Vector3& c = positions[triangles[i].indices[2]];
+        float cx = ((a.x + b.x + c.x) / 3.0f - bmin.x) / ext.x;
+        float cy = ((a.y + b.y + c.y) / 3.0f - bmin.y) / ext.y;
+        float cz = ((a.z + b.z + c.z) / 3.0f - bmin.z) / ext.z;
+        order[i] = { morton3(cx, cy, cz), (unsigned int)i };
+    }
+    std::sort(order.begin(), order.end());
+
+    // 2) 정점/삼각형 한도 안에서 탐욕적으로 채운다
+    std::vector<unsigned int> stamp(positions.size(), 0xFFFFFFFFu);
+    outTriangles.reserve(triangles.size());
+
+    Meshlet cur = {};
+    unsigned int curId = 0;
+    for (size_t k = 0; k < order.size(); ++k) {
+        const Triangle& t = triangles[order[k].second];
+        unsigned int newVerts = 0;
+        for (int j = 0; j < 3; ++j)
+            if (stamp[t.indices[j]] != curId) newVerts++;
+
+        if (cur.vertexCount + newVerts > kMeshletMaxVertices
+            || cur.triangleCount + 1 > kMeshletMaxTriangles) {
+            compute_bounds(positions, &outTriangles[cur.triangleOffset], cur);
+            meshlets.push_back(cur);
+            cur = {};
+            cur.triangleOffset = (unsigned int)outTriangles.size();
+            curId++;
+        }
+        for (int j = 0; j < 3; ++j) {
+            if (stamp[t.indices[j]] != curId) {
+                stamp[t.indices[j]] = curId;
+                cur.vertexCount++;
+            }
+        }
+        outTriangles.push_back(t);
+        cur.triangleCount++;
+    }
+    compute_bounds(positions, &outTriangles[cur.triangleOffset], cur);
+    meshlets.push_back(cur);
+}
+
+// ----------------------------------------------------------------------------
+// 메쉬릿 컬링 (절두체 + 노멀 콘 뒷면)
+// ----------------------------------------------------------------------------
+MeshletCullStats cull_meshlets(const std::vector<Meshlet>& meshlets,
+                               const float mv[16],
+                               const float proj[16],
+                               std::vector<int>& drawCounts,
+                               std::vector<const void*>& drawOffsets) {
+    MeshletCullStats stats = { (unsigned int)meshlets.size(), 0, 0 };
+    drawCounts.clear();
+    drawOffsets.clear();
+
+    // MVP = P * MV (column-major)
+    float m[16];
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r) {
+            float s = 0.0f;
+            for (int k = 0; k < 4; ++k) s += proj[k * 4 + r] * mv[c * 4 + k];
+            m[c * 4 + r] = s;
+        }
+
+    // 객체 공간 절두체 평면 (Gribb-Hartmann)
+    float planes[6][4];
+    for (int i = 0; i < 3; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            planes[i * 2 + 0][c] = m[c * 4 + 3] + m[c * 4 + i];
+            planes[i * 2 + 1][c] = m[c * 4 + 3] - m[c * 4 + i];
+        }
+    }
+    for (int i = 0; i < 6; ++i) {
+        float len = sqrtf(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+        for (int c = 0; c < 4; ++c) planes[i][c] /= len;
+    }
+
+    // 객체 공간 카메라 위치: -A^-1 * t (MV = [A | t])
+    float a00 = mv[0], a01 = mv[4], a02 = mv[8];
+    float a10 = mv[1], a11 = mv[5], a12 = mv[9];
+    float a20 = mv[2], a21 = mv[6], a22 = mv[10];
+    float det = a00 * (a11 * a22 - a12 * a21) - a01 * (a10 * a22 - a12 * a20) + a02 * (a10 * a21 - a11 * a20);
+    float inv[9] = {
+        (a11 * a22 - a12 * a21) / det, (a02 * a21 - a01 * a22) / det, (a01 * a12 - a02 * a11) / det,
+        (a12 * a20 - a10 * a22) / det, (a00 * a22 - a02 * a20) / det, (a02 * a10 - a00 * a12) / det,
+        (a10 * a21 - a11 * a20) / det, (a01 * a20 - a00 * a21) / det, (a00 * a11 - a01 * a10) / det
+    };
+    Vector3 cam = {
+        -(inv[0] * mv[12] + inv[1] * mv[13] + inv[2] * mv[14]),
+        -(inv[3] * mv[12] + inv[4] * mv[13] + inv[5] * mv[14]),
+        -(inv[6] * mv[12] + inv[7] * mv[13] + inv[8] * mv[14])
+    };
+
+    unsigned int rangeEnd = 0xFFFFFFFFu;
+    for (const Meshlet& ml : meshlets) {
+        bool outside = false;
+        for (int i = 0; i < 6 && !outside; ++i)
+            outside = planes[i][0] * ml.center.x + planes[i][1] * ml.center.y
+                    + planes[i][2] * ml.center.z + planes[i][3] < -ml.radius;
+        if (outside) { stats.frustumCulled++; continue; }
+
+        Vector3 d = sub(ml.center, cam);
+        if (ml.coneCutoff < 1.0f && dot3(d, ml.coneAxis) >= ml.coneCutoff * length3(d) + ml.radius) {
+            stats.backfaceCulled++;
+            continue;
+        }
+
+        // 직전 구간과 이어지면 합쳐서 draw 수를 줄인다
+        if (rangeEnd == ml.triangleOffset) {
+            drawCounts.back() += (int)ml.triangleCount * 3;
+        }
+        else {
+            drawCounts.push_back((int)ml.triangleCount * 3);
+            drawOffsets.push_back((const void*)(size_t)(ml.triangleOffset * sizeof(Triangle)));
+        }
+        rangeEnd = ml.triangleOffset + ml.triangleCount;
+    }
+    return stats;
+}
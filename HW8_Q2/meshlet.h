@@ -0,0 +1,41 @@
+﻿#pragma once
+#include <vector>
+#include "mesh.h"
+
+// ----------------------------------------------------------------------------
+// 메쉬릿(클러스터): 정점 최대 64개, 삼각형 최대 124개
+// 삼각형은 재정렬된 인덱스 버퍼 안에서 연속 구간을 차지한다.
+// ----------------------------------------------------------------------------
+const unsigned int kMeshletMaxVertices = 64;
+const unsigned int kMeshletMaxTriangles = 124;
+
+struct Meshlet {
+    unsigned int triangleOffset;  // 재정렬된 삼각형 배열에서 시작 위치
+    unsigned int triangleCount;
+    unsigned int vertexCount;
+
+    Vector3 center;               // 바운딩 스피어
+    float   radius;
+    Vector3 coneAxis;             // 노멀 콘 (coneCutoff >= 1 이면 컬링 불가)
+    float   coneCutoff;
+};
+
+struct MeshletCullStats {
+    unsigned int total;
+    unsigned int frustumCulled;
+    unsigned int backfaceCulled;
+};
+
+// triangles 를 메쉬릿 순서로 재정렬한 결과를 outTriangles 에 저장
+void build_meshlets(const std::vector<Vector3>& positions,
+                    const std::vector<Triangle>& triangles,
+                    std::vector<Meshlet>& meshlets,
+                    std::vector<Triangle>& outTriangles);
+
+// modelview/projection 은 glGetFloatv 로 얻은 column-major 4x4 행렬.
+// 살아남은 메쉬릿의 인덱스 구간(바이트 오프셋, 인덱스 수)을 인접 구간끼리 합쳐서 돌려준다.
+MeshletCullStats cull_meshlets(const std::vector<Meshlet>& meshlets,
+                               const float modelview[16],
+                               const float projection[16],
+                               std::vector<int>& drawCounts,
+                               std::vector<const void*>& drawOffsets);
@@ -0,0 +1,80 @@
+﻿#include "stream_buffer.h"
+#include <stdio.h>
+#include <chrono>
+#include <GL/glut.h>
+#include <GL/freeglut_ext.h>
+
+// GL 4.4 / ARB_buffer_storage 상수 (동봉된 GLEW 헤더에 없음)
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void (GLAPIENTRY* BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+bool stream_ring_init(StreamRing& ring, size_t sectionBytes, int sections) {
+    ring = StreamRing();
+    ring.sectionBytes = sectionBytes;
+    ring.sections = sections < kStreamMaxSections ? sections : kStreamMaxSections;
+
+    BufferStorageProc bufferStorage = (BufferStorageProc)glutGetProcAddress("glBufferStorage");
+    if (!bufferStorage)
+        bufferStorage = (BufferStorageProc)glutGetProcAddress("glBufferStorageARB");
+
+    glGenBuffers(1, &ring.buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, ring.buffer);
+    GLsizeiptr total = (GLsizeiptr)(sectionBytes * ring.sections);
+
+    if (bufferStorage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        bufferStorage(GL_ARRAY_BUFFER, total, nullptr, flags);
+        ring.mapped = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, total, flags);
+        ring.persistent = ring.mapped != nullptr;
+    }
+    if (!ring.persistent) {
+        glBufferData(GL_ARRAY_BUFFER, total, nullptr, GL_STREAM_DRAW);
+        printf("[Stream] persistent mapping unavailable, using unsynchronized glMapBufferRange\n");
+    }
+    else {
+        printf("[Stream] persistent mapped ring: %d x %lu bytes\n",
+            ring.sections, (unsigned long)sectionBytes);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return glGetError() == GL_NO_ERROR;
+}
+
+void* stream_ring_begin(StreamRing& ring) {
+    GLsync& fence = ring.fences[ring.current];
+    if (fence) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED)
+            flags = 0;
+        ring.waitSeconds += std::chrono::duration<double>(
+            std::chrono::high_resolution_clock::now() - t0).count();
+        glDeleteSync(fence);
+        fence = 0;
+    }
+
+    size_t offset = ring.sectionBytes * ring.current;
+    if (ring.persistent)
+        return ring.mapped + offset;
+
+    glBindBuffer(GL_ARRAY_BUFFER, ring.buffer);
+    return glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)offset, (GLsizeiptr)ring.sectionBytes,
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+}
+
+size_t stream_ring_end(StreamRing& ring) {
+    glBindBuffer(GL_ARRAY_BUFFER, ring.buffer);
+    if (!ring.persistent)
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    return ring.sectionBytes * ring.current;
+}
+
+void stream_ring_fence(StreamRing& ring) {
+    ring.fences[ring.current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ring.current = (ring.current + 1) % ring.sections;
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+#include <stddef.h>
+#include <GL/glew.h>
+
+// ----------------------------------------------------------------------------
+// 동적 정점 데이터용 링 버퍼 (기본 3 구간)
+//   GL_ARB_buffer_storage 가 있으면 GL_MAP_PERSISTENT_BIT 로 한 번만 매핑하고,
+//   없으면 매 프레임 GL_MAP_UNSYNCHRONIZED_BIT 로 해당 구간만 매핑한다.
+//   각 구간은 GPU 가 다 읽었는지 fence 로 확인한 뒤에 다시 쓴다.
+// ----------------------------------------------------------------------------
+const int kStreamMaxSections = 4;
+
+struct StreamRing {
+    GLuint buffer;
+    size_t sectionBytes;
+    int    sections;
+    int    current;
+    GLsync fences[kStreamMaxSections];
+    char*  mapped;       // persistent 매핑 주소 (fallback 이면 nullptr)
+    bool   persistent;
+    double waitSeconds;  // fence 대기로 CPU 가 멈춘 누적 시간
+};
+
+bool   stream_ring_init(StreamRing& ring, size_t sectionBytes, int sections);
+// 현재 구간의 fence 를 기다린 뒤 쓰기 포인터를 돌려준다
+void*  stream_ring_begin(StreamRing& ring);
+// 쓰기 완료. 그리기에 쓸 현재 구간의 바이트 오프셋을 돌려준다 (GL_ARRAY_BUFFER 에 바인드된 상태)
+size_t stream_ring_end(StreamRing& ring);
+// 그리기 명령 직후 호출: 현재 구간에 fence 를 넣고 다음 구간으로 넘어간다
+void   stream_ring_fence(StreamRing& ring);
@@ -0,0 +1,523 @@
+﻿#include "bvh_build.h"
+#include <float.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const int kBins = 16;
+// 이 개수 이상인 구간은 bin 채우기를 스레드 여러 개로 나눈다 (루트 근처 몇 단계)
+static const uint32_t kParallelBinMin = 1u << 17;
+// LBVH 의 Morton 코드 / 정렬 / 분할 계산을 스레드로 나누는 최소 개수
+static const uint32_t kParallelLbvhMin = 1u << 15;
+
+namespace {
+
+struct Aabb {
+    float lo[3], hi[3];
+
+    void reset() {
+        lo[0] = lo[1] = lo[2] = FLT_MAX;
+        hi[0] = hi[1] = hi[2] = -FLT_MAX;
+    }
+    void grow(const float p[3]) {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], p[a]);
+            hi[a] = std::max(hi[a], p[a]);
+        }
+    }
+    void grow(const Aabb& b) {
+        grow(b.lo);
+        grow(b.hi);
+    }
+    float area() const {
+        float dx = hi[0] - lo[0], dy = hi[1] - lo[1], dz = hi[2] - lo[2];
+        return dx < 0.0f ? 0.0f : 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+};
+
+// 축 3개의 bin 상자와 개수. 구간을 나눠 채운 뒤 merge 로 합친다
+struct Bins {
+    Aabb     box[3][kBins];
+    uint32_t count[3][kBins];
+
+    void reset() {
+        for (int a = 0; a < 3; ++a)
+            for (int b = 0; b < kBins; ++b) {
+                box[a][b].reset();
+                count[a][b] = 0;
+            }
+    }
+    void merge(const Bins& o) {
+        for (int a = 0; a < 3; ++a)
+            for (int b = 0; b < kBins; ++b) {
+                box[a][b].grow(o.box[a][b]);
+                count[a][b] += o.count[a][b];
+            }
+    }
+};
+
+struct Builder {
+    const Aabb*           bounds;
+    std::vector<float>    centroids;    // 프리미티브당 3
+    std::vector<uint32_t> order;
+    std::vector<BvhNode>  arena;        // 2n - 1 개를 미리 잡아 둔다
+    std::atomic<uint32_t> nextNode;
+    std::atomic<int>      freeThreads;  // 새 작업에 더 쓸 수 있는 스레드 수
+    BvhBuildOptions       options;
+    int                   threads;
+};
+
+// [begin, end) 를 workers 개로 나눠 f(begin, end, worker) 를 병렬로 부른다
+template <class F>
+void parallel_ranges(uint32_t begin, uint32_t end, int workers, F f) {
+    std::vector<std::thread> pool;
+    uint32_t step = (end - begin + workers - 1) / workers;
+    for (int w = 1; w < workers; ++w) {
+        uint32_t b = std::min(end, begin + w * step), e = std::min(end, b + step);
+        pool.emplace_back([=]() { f(b, e, w); });
+    }
+    f(begin, std::min(end, begin + step), 0);
+    for (std::thread& t : pool)
+        t.join();
+}
+
+void measure(const Builder& B, uint32_t begin, uint32_t end, Aabb& box, Aabb& centroidBox) {
+    box.reset();
+    centroidBox.reset();
+    for (uint32_t k = begin; k < end; ++k) {
+        uint32_t p = B.order[k];
+        box.grow(B.bounds[p]);
+        centroidBox.grow(&B.centroids[p * 3]);
+    }
+}
+
+void fill_bins(const Builder& B, uint32_t begin, uint32_t end, const Aabb& centroidBox, Bins& bins) {
+    bins.reset();
+    float scale[3];
+    for (int a = 0; a < 3; ++a) {
+        float extent = centroidBox.hi[a] - centroidBox.lo[a];
+        scale[a] = extent > 0.0f ? kBins / extent : 0.0f;
+    }
+    for (uint32_t k = begin; k < end; ++k) {
+        uint32_t p = B.order[k];
+        for (int a = 0; a < 3; ++a) {
+            int b = std::min((int)((B.centroids[p * 3 + a] - centroidBox.lo[a]) * scale[a]), kBins - 1);
+            bins.box[a][b].grow(B.bounds[p]);
+            ++bins.count[a][b];
+        }
+    }
+}
+
+// 이 구간에 쓸 bin 채우기 스레드 수. 현재 스레드 말고 더 쓰는 만큼을
+// fork 와 같은 방식으로 freeThreads 에서 예약한다 (release_bin_workers 로 반납)
+int reserve_bin_workers(Builder& B, uint32_t count) {
+    if (count < kParallelBinMin) return 1;
+    int want = (int)(count / (kParallelBinMin / 2)) - 1;
+    int idle = B.freeThreads.load(), take = 0;
+    do {
+        take = std::min(idle, want);
+        if (take <= 0) return 1;
+    } while (!B.freeThreads.compare_exchange_weak(idle, idle - take));
+    return take + 1;
+}
+
+void release_bin_workers(Builder& B, int workers) {
+    if (workers > 1) B.freeThreads += workers - 1;
+}
+
+void build_node(Builder& B, uint32_t nodeIndex, uint32_t begin, uint32_t end, int depth) {
+    uint32_t count = end - begin;
+    int workers = reserve_bin_workers(B, count);
+
+    Aabb box, centroidBox;
+    if (workers > 1) {
+        std::vector<Aabb> boxes(workers * 2);
+        parallel_ranges(begin, end, workers, [&](uint32_t b, uint32_t e, int w) {
+            measure(B, b, e, boxes[w * 2], boxes[w * 2 + 1]);
+        });
+        box = boxes[0];
+        centroidBox = boxes[1];
+        for (int w = 1; w < workers; ++w) {
+            box.grow(boxes[w * 2]);
+            centroidBox.grow(boxes[w * 2 + 1]);
+        }
+    }
+    else {
+        measure(B, begin, end, box, centroidBox);
+    }
+    BvhNode& node = B.arena[nodeIndex];
+    memcpy(node.bmin, box.lo, sizeof(node.bmin));
+    memcpy(node.bmax, box.hi, sizeof(node.bmax));
+    if (count <= B.options.maxLeafSize) {
+        release_bin_workers(B, workers);
+        node.leftOrFirst = begin;
+        node.count = count;
+        return;
+    }
+
+    // --- 가장 싼 축/경계 찾기 ---
+    int bestAxis = -1, bestSplit = 0;
+    float bestCost = FLT_MAX;
+    if (depth < kBvhForceMedianDepth) {
+        Bins bins;
+        if (workers > 1) {
+            std::vector<Bins> partial(workers);
+            parallel_ranges(begin, end, workers, [&](uint32_t b, uint32_t e, int w) {
+                fill_bins(B, b, e, centroidBox, partial[w]);
+            });
+            bins = partial[0];
+            for (int w = 1; w < workers; ++w)
+                bins.merge(partial[w]);
+        }
+        else {
+            fill_bins(B, begin, end, centroidBox, bins);
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            if (centroidBox.hi[axis] - centroidBox.lo[axis] <= 0.0f) continue;
+            // 오른쪽부터 누적한 면적/개수
+            float rightArea[kBins];
+            uint32_t rightCount[kBins];
+            Aabb acc;
+            acc.reset();
+            uint32_t n = 0;
+            for (int b = kBins - 1; b > 0; --b) {
+                acc.grow(bins.box[axis][b]);
+                n += bins.count[axis][b];
+                rightArea[b] = acc.area();
+                rightCount[b] = n;
+            }
+            acc.reset();
+            n = 0;
+            for (int b = 0; b < kBins - 1; ++b) {
+                acc.grow(bins.box[axis][b]);
+                n += bins.count[axis][b];
+                if (n == 0 || rightCount[b + 1] == 0) continue;
+                float cost = acc.area() * n + rightArea[b + 1] * rightCount[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b + 1;
+                }
+            }
+        }
+    }
+    release_bin_workers(B, workers);
+
+    uint32_t mid;
+    const float* c = B.centroids.data();
+    if (bestAxis >= 0) {
+        float lo = centroidBox.lo[bestAxis];
+        float scale = kBins / (centroidBox.hi[bestAxis] - lo);
+        mid = (uint32_t)(std::partition(B.order.begin() + begin, B.order.begin() + end, [&](uint32_t p) {
+            return std::min((int)((c[p * 3 + bestAxis] - lo) * scale), kBins - 1) < bestSplit;
+        }) - B.order.begin());
+    }
+    else {
+        // 무게중심이 모두 같거나 너무 깊다: 가장 긴 축의 개수 중앙값
+        int axis = 0;
+        for (int a = 1; a < 3; ++a)
+            if (centroidBox.hi[a] - centroidBox.lo[a] > centroidBox.hi[axis] - centroidBox.lo[axis]) axis = a;
+        mid = begin + count / 2;
+        std::nth_element(B.order.begin() + begin, B.order.begin() + mid, B.order.begin() + end,
+            [&](uint32_t a, uint32_t b) { return c[a * 3 + axis] < c[b * 3 + axis]; });
+    }
+
+    uint32_t left = B.nextNode.fetch_add(2);
+    node.leftOrFirst = left;
+    node.count = 0;
+
+    // 양쪽 다 충분히 크고 남는 스레드가 있으면 왼쪽을 새 스레드로
+    bool fork = false;
+    if (std::min(mid - begin, end - mid) >= B.options.sequentialBelow) {
+        int idle = B.freeThreads.load();
+        while (idle > 0 && !B.freeThreads.compare_exchange_weak(idle, idle - 1)) {}
+        fork = idle > 0;
+    }
+    if (fork) {
+        std::thread task([&B, left, begin, mid, depth]() { build_node(B, left, begin, mid, depth + 1); });
+        build_node(B, left + 1, mid, end, depth + 1);
+        task.join();
+        ++B.freeThreads;
+    }
+    else {
+        build_node(B, left, begin, mid, depth + 1);
+        build_node(B, left + 1, mid, end, depth + 1);
+    }
+}
+
+// arena 의 트리를 깊이 우선 순서로 옮긴다 (부모 다음에 두 자식이 나란히, 그 다음 왼쪽 부분 트리)
+void compact(const std::vector<BvhNode>& arena, std::vector<BvhNode>& nodes) {
+    nodes.clear();
+    nodes.reserve(arena.size());
+    nodes.push_back(arena[0]);
+    uint32_t stack[2 * kBvhForceMedianDepth + 64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        uint32_t index = stack[--top];
+        if (nodes[index].count > 0) continue;
+        uint32_t from = nodes[index].leftOrFirst, left = (uint32_t)nodes.size();
+        nodes.push_back(arena[from]);
+        nodes.push_back(arena[from + 1]);
+        nodes[index].leftOrFirst = left;
+        stack[top++] = left + 1;
+        stack[top++] = left;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// LBVH (Karras 2012)
+//   1. 무게중심 상자 안에서 축마다 10 (또는 21) 비트로 양자화해 30 (63) 비트 Morton 코드
+//   2. (코드, 번호) 를 8 비트씩 LSD 기수 정렬. 스레드마다 자기 구간의 히스토그램을 세고,
+//      자리 값 -> 스레드 순으로 시작 위치를 정해 각자 흩뿌린다 (안정 정렬)
+//   3. 정렬된 코드의 이진 기수 트리: 내부 노드 i 마다 덮는 구간과 분할 위치를 독립적으로 계산
+//      (같은 코드는 번호로 구분). 노드끼리 의존이 없어 그대로 병렬
+//   4. 루트부터 깊이 우선으로 BvhNode 를 늘어놓는다. kBvhForceMedianDepth 부터와
+//      maxLeafSize 이하 구간은 SAH 빌드와 같은 규칙 (가운데에서 나누기 / 잎)
+//   5. 상자는 refit_bvh 로 아래에서 위로
+// ----------------------------------------------------------------------------
+uint32_t expand_bits10(uint32_t v) {
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v << 8)) & 0x0300f00f;
+    v = (v | (v << 4)) & 0x030c30c3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+}
+
+uint64_t expand_bits21(uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | (v << 32)) & 0x001f00000000ffffull;
+    v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+    v = (v | (v << 8)) & 0x100f00f00f00f00full;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ull;
+    v = (v | (v << 2)) & 0x1249249249249249ull;
+    return v;
+}
+
+// x != 0
+int count_leading_zeros(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanReverse(&index, (unsigned long)(x >> 32))) return 31 - (int)index;
+    _BitScanReverse(&index, (unsigned long)x);
+    return 63 - (int)index;
+#else
+    return __builtin_clzll(x);
+#endif
+}
+
+void radix_sort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int bits, int workers) {
+    uint32_t n = (uint32_t)keys.size();
+    std::vector<uint64_t> keys2(n);
+    std::vector<uint32_t> values2(n);
+    std::vector<uint32_t> offsets(workers * 256);
+    for (int shift = 0; shift < bits; shift += 8) {
+        parallel_ranges(0, n, workers, [&](uint32_t b, uint32_t e, int w) {
+            uint32_t* h = &offsets[w * 256];
+            memset(h, 0, 256 * sizeof(uint32_t));
+            for (uint32_t k = b; k < e; ++k)
+                ++h[(keys[k] >> shift) & 255];
+        });
+        uint32_t sum = 0;
+        bool constant = false;
+        for (int digit = 0; digit < 256; ++digit) {
+            uint32_t start = sum;
+            for (int w = 0; w < workers; ++w) {
+                uint32_t c = offsets[w * 256 + digit];
+                offsets[w * 256 + digit] = sum;
+                sum += c;
+            }
+            constant = constant || sum - start == n;
+        }
+        if (constant) continue;     // 이 자리는 모두 같다
+        parallel_ranges(0, n, workers, [&](uint32_t b, uint32_t e, int w) {
+            uint32_t* h = &offsets[w * 256];
+            for (uint32_t k = b; k < e; ++k) {
+                uint32_t pos = h[(keys[k] >> shift) & 255]++;
+                keys2[pos] = keys[k];
+                values2[pos] = values[k];
+            }
+        });
+        keys.swap(keys2);
+        values.swap(values2);
+    }
+}
+
+// 정렬된 코드 i, j 의 공통 접두 비트 수 (j 가 범위 밖이면 -1, 코드가 같으면 번호로 이어서)
+struct PrefixLength {
+    const uint64_t* keys;
+    int n;
+
+    int operator()(int i, int j) const {
+        if (j < 0 || j >= n) return -1;
+        uint64_t x = keys[i] ^ keys[j];
+        return x ? count_leading_zeros(x) : 64 + count_leading_zeros((uint64_t)(i ^ j));
+    }
+};
+
+// 내부 노드 i 의 분할 위치 gamma: 왼쪽 자식은 [first, gamma], 오른쪽은 [gamma + 1, last]
+int karras_split(const PrefixLength& delta, int i) {
+    int d = delta(i, i + 1) > delta(i, i - 1) ? 1 : -1;
+    int deltaMin = delta(i, i - d);
+    int lmax = 2;
+    while (delta(i, i + lmax * d) > deltaMin)
+        lmax *= 2;
+    int l = 0;
+    for (int t = lmax / 2; t >= 1; t /= 2)
+        if (delta(i, i + (l + t) * d) > deltaMin) l += t;
+    int deltaNode = delta(i, i + l * d);
+    int s = 0, t = l;
+    do {
+        t = (t + 1) / 2;
+        if (delta(i, i + (s + t) * d) > deltaNode) s += t;
+    } while (t > 1);
+    return i + s * d + std::min(d, 0);
+}
+
+void build_lbvh(Builder& B, uint32_t count, std::vector<BvhNode>& nodes) {
+    int workers = count >= kParallelLbvhMin ? B.threads : 1;
+    int bits = B.options.method == BVH_BUILD_LBVH63 ? 63 : 30;
+
+    // --- Morton 코드 ---
+    std::vector<Aabb> partial(workers);
+    parallel_ranges(0, count, workers, [&](uint32_t b, uint32_t e, int w) {
+        partial[w].reset();
+        for (uint32_t p = b; p < e; ++p)
+            partial[w].grow(&B.centroids[p * 3]);
+    });
+    Aabb centroidBox = partial[0];
+    for (int w = 1; w < workers; ++w)
+        centroidBox.grow(partial[w]);
+    float cells = bits == 63 ? 2097151.0f : 1023.0f;
+    float scale[3];
+    for (int a = 0; a < 3; ++a) {
+        float extent = centroidBox.hi[a] - centroidBox.lo[a];
+        scale[a] = extent > 0.0f ? cells / extent : 0.0f;
+    }
+    std::vector<uint64_t> keys(count);
+    parallel_ranges(0, count, workers, [&](uint32_t b, uint32_t e, int) {
+        for (uint32_t p = b; p < e; ++p) {
+            uint32_t q[3];
+            for (int a = 0; a < 3; ++a)
+                q[a] = (uint32_t)std::min((B.centroids[p * 3 + a] - centroidBox.lo[a]) * scale[a], cells);
+            keys[p] = bits == 63
+                ? (expand_bits21(q[0]) << 2) | (expand_bits21(q[1]) << 1) | expand_bits21(q[2])
+                : (uint64_t)morton_code30(q[0], q[1], q[2]);
+        }
+    });
+    radix_sort(keys, B.order, bits, workers);
+
+    // --- 내부 노드 n - 1 개의 분할 (루트는 0 번, [0, n - 1] 을 덮는다) ---
+    PrefixLength delta = { keys.data(), (int)count };
+    std::vector<uint32_t> split(count > 1 ? count - 1 : 0);
+    parallel_ranges(0, (uint32_t)split.size(), workers, [&](uint32_t b, uint32_t e, int) {
+        for (uint32_t i = b; i < e; ++i)
+            split[i] = (uint32_t)karras_split(delta, (int)i);
+    });
+
+    // --- 깊이 우선으로 노드 배치. 구간 [first, last] 의 내부 노드 번호는 internal (없으면 -1) ---
+    struct Range { uint32_t node, first, last; int internal, depth; };
+    Range stack[2 * kBvhForceMedianDepth + 64];
+    int top = 0;
+    nodes.clear();
+    nodes.reserve(count / 2 + 1);
+    nodes.emplace_back();
+    stack[top++] = { 0, 0, count - 1, 0, 0 };
+    while (top > 0) {
+        Range r = stack[--top];
+        uint32_t n = r.last - r.first + 1;
+        if (n <= B.options.maxLeafSize) {
+            nodes[r.node].leftOrFirst = r.first;
+            nodes[r.node].count = n;
+            continue;
+        }
+        uint32_t gamma;
+        int leftInternal = -1, rightInternal = -1;
+        if (r.internal >= 0 && r.depth < kBvhForceMedianDepth) {
+            gamma = split[r.internal];
+            leftInternal = (int)gamma;
+            rightInternal = (int)gamma + 1;
+        }
+        else {
+            gamma = r.first + n / 2 - 1;
+        }
+        uint32_t left = (uint32_t)nodes.size();
+        nodes.emplace_back();
+        nodes.emplace_back();
+        nodes[r.node].leftOrFirst = left;
+        nodes[r.node].count = 0;
+        stack[top++] = { left + 1, gamma + 1, r.last, rightInternal, r.depth + 1 };
+        stack[top++] = { left, r.first, gamma, leftInternal, r.depth + 1 };
+    }
+
+    refit_bvh(nodes, [&](const BvhNode& node, float lo[3], float hi[3]) {
+        Aabb box;
+        box.reset();
+        for (uint32_t k = 0; k < node.count; ++k)
+            box.grow(B.bounds[B.order[node.leftOrFirst + k]]);
+        memcpy(lo, box.lo, sizeof(box.lo));
+        memcpy(hi, box.hi, sizeof(box.hi));
+    });
+}
+
+} // namespace
+
+uint32_t morton_code30(uint32_t x, uint32_t y, uint32_t z) {
+    return (expand_bits10(x) << 2) | (expand_bits10(y) << 1) | expand_bits10(z);
+}
+
+void radix_sort_by_key(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int bits, int threads) {
+    if (threads <= 0) threads = std::max(1, (int)std::thread::hardware_concurrency());
+    radix_sort(keys, values, bits, keys.size() >= kParallelLbvhMin ? threads : 1);
+}
+
+const char* bvh_build_method_name(BvhBuildMethod method) {
+    switch (method) {
+    case BVH_BUILD_LBVH30: return "LBVH30";
+    case BVH_BUILD_LBVH63: return "LBVH63";
+    default:               return "SAH";
+    }
+}
+
+void build_bvh(const float* bounds, size_t count, const BvhBuildOptions& options, BvhBuildResult& result) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    result.nodes.clear();
+    result.order.clear();
+
+    Builder B;
+    B.bounds = (const Aabb*)bounds;     // 프리미티브당 float 6 개는 Aabb 와 같은 배치
+    B.options = options;
+    B.options.maxLeafSize = std::max(options.maxLeafSize, 1u);
+    B.threads = options.threads > 0 ? options.threads : (int)std::max(std::thread::hardware_concurrency(), 1u);
+    B.freeThreads = B.threads - 1;
+    B.nextNode = 1;
+    B.centroids.resize(count * 3);
+    B.order.resize(count);
+    parallel_ranges(0, (uint32_t)count, count >= kParallelBinMin ? B.threads : 1, [&](uint32_t b, uint32_t e, int) {
+        for (uint32_t p = b; p < e; ++p) {
+            for (int a = 0; a < 3; ++a)
+                B.centroids[p * 3 + a] = 0.5f * (B.bounds[p].lo[a] + B.bounds[p].hi[a]);
+            B.order[p] = p;
+        }
+    });
+
+    if (count > 0 && options.method != BVH_BUILD_SAH) {
+        build_lbvh(B, (uint32_t)count, result.nodes);
+    }
+    else if (count > 0) {
+        // 잎이 하나씩만 가져도 노드는 2n - 1 개를 넘지 않는다
+        B.arena.resize(2 * count - 1);
+        build_node(B, 0, 0, (uint32_t)count, 0);
+        B.arena.resize(B.nextNode.load());
+        compact(B.arena, result.nodes);
+    }
+    result.order.swap(B.order);
+    result.threads = B.threads;
+    result.ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
@@ -0,0 +1,133 @@
+﻿#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// BVH 빌드 (프리미티브 종류와 무관: 상자만 받는다. 메쉬 삼각형, 구 등)
+//   - 축마다 16 칸 binned SAH. 깊이 kBvhForceMedianDepth 부터는 개수 중앙값으로 나눈다
+//   - 위쪽 (프리미티브가 sequentialBelow 개 이상) 은 fork-join: 왼쪽 자식을 새 스레드에서,
+//     오른쪽은 지금 스레드에서 만들고 기다린다. 동시에 도는 스레드는 threads 개 이하
+//   - 아주 큰 구간 (루트 근처) 의 bin 채우기는 구간을 나눠 여러 스레드가 같이 한다
+//   - 노드는 미리 잡아 둔 배열 (프리미티브 n 개면 2n - 1 개) 에서 원자적 카운터로 두 개씩 받는다.
+//     끝나면 깊이 우선 순서로 다시 번호를 매겨 압축하므로 결과는 스레드 수와 무관하게 같다
+//   - LBVH: 무게중심 Morton 코드를 병렬 기수 정렬하고 Karras 방식으로 선형 시간에 트리를 만든다.
+//     SAH 보다 훨씬 빠르지만 트리 품질은 낮다 (매 프레임 다시 만드는 동적 장면용).
+//     결과 형식은 같으므로 순회 코드는 그대로 쓴다
+// ----------------------------------------------------------------------------
+const int kBvhForceMedianDepth = 32;
+
+// 32 바이트. count > 0 이면 잎, 아니면 자식은 leftOrFirst, leftOrFirst + 1.
+// build_bvh 결과에서 잎의 leftOrFirst 는 order 의 시작 위치 (메쉬 BVH 는 이를 잎 블록 번호로 바꾼다)
+struct BvhNode {
+    float    bmin[3];
+    uint32_t leftOrFirst;
+    float    bmax[3];
+    uint32_t count;
+};
+
+enum BvhBuildMethod {
+    BVH_BUILD_SAH,
+    BVH_BUILD_LBVH30,                   // 축당 10 비트 Morton 코드
+    BVH_BUILD_LBVH63                    // 축당 21 비트 (큰 장면에서 같은 코드가 덜 생긴다)
+};
+
+const char* bvh_build_method_name(BvhBuildMethod method);
+
+// 10 비트 정수 좌표 세 개의 비트를 섞은 30 비트 Morton 코드 (x 가 가장 높은 비트)
+uint32_t morton_code30(uint32_t x, uint32_t y, uint32_t z);
+
+// keys 의 아래 bits 비트로 (keys, values) 쌍을 안정 정렬 (LSD 기수 정렬, 8 비트씩). LBVH 가 쓰는 것과 같다
+//   threads: 0 이면 hardware_concurrency. 개수가 적으면 한 스레드로
+void radix_sort_by_key(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int bits, int threads = 0);
+
+struct BvhBuildOptions {
+    BvhBuildMethod method = BVH_BUILD_SAH;
+    int            threads = 0;             // 0 이면 hardware_concurrency
+    uint32_t       maxLeafSize = 8;
+    uint32_t       sequentialBelow = 8192;  // SAH: 이보다 작은 구간은 새 작업을 만들지 않는다
+};
+
+struct BvhBuildResult {
+    std::vector<BvhNode>  nodes;        // 0 이 루트, 부모가 자식보다 앞 (깊이 우선)
+    std::vector<uint32_t> order;        // 잎 순서로 늘어놓은 프리미티브 번호
+    int                   threads = 1;  // 실제로 쓴 스레드 수
+    double                ms = 0.0;
+};
+
+// bounds: 프리미티브당 6 (lo xyz, hi xyz)
+void build_bvh(const float* bounds, size_t count, const BvhBuildOptions& options, BvhBuildResult& result);
+
+// 잎 상자가 바뀐 뒤 (변형 메쉬) 위상은 그대로 두고 내부 노드 상자만 아래에서 위로 다시 계산
+//   leafBounds(node, lo, hi) 가 잎 하나의 새 상자를 채운다
+template <class LeafBounds>
+void refit_bvh(std::vector<BvhNode>& nodes, LeafBounds leafBounds) {
+    // 자식은 항상 부모 뒤에 있으므로 뒤에서부터 한 번 훑으면 된다
+    for (size_t k = nodes.size(); k-- > 0;) {
+        BvhNode& n = nodes[k];
+        if (n.count > 0) {
+            leafBounds(n, n.bmin, n.bmax);
+            continue;
+        }
+        const BvhNode& l = nodes[n.leftOrFirst];
+        const BvhNode& r = nodes[n.leftOrFirst + 1];
+        for (int a = 0; a < 3; ++a) {
+            n.bmin[a] = l.bmin[a] < r.bmin[a] ? l.bmin[a] : r.bmin[a];
+            n.bmax[a] = l.bmax[a] > r.bmax[a] ? l.bmax[a] : r.bmax[a];
+        }
+    }
+}
+
+// 가장 가까운 교차를 찾는 순회 (구처럼 잎을 직접 검사하는 프리미티브용. 메쉬는 mesh_bvh 의 순회를 쓴다)
+//   leafHit(first, count, tMax) 는 order[first, first + count) 를 검사하고, tMax 보다 가까운
+//   교차가 있으면 tMax 를 줄이고 true. anyHit 이면 처음 맞은 잎에서 멈춘다
+template <class LeafHit>
+bool traverse_bvh(const std::vector<BvhNode>& nodes, const float origin[3], const float dir[3], float& tMax,
+                  bool anyHit, LeafHit leafHit) {
+    if (nodes.empty()) return false;
+    float inv[3];
+    for (int a = 0; a < 3; ++a)
+        inv[a] = 1.0f / (dir[a] == 0.0f ? 0.0f : dir[a]);
+
+    // 상자 진입 t (놓치면 -1). 면 평면 위의 광선 (0 * inf = NaN) 은 그 축을 무시한다
+    auto enter = [&](const BvhNode& n) {
+        float t0 = 0.0f, t1 = tMax;
+        for (int a = 0; a < 3; ++a) {
+            float ta = (n.bmin[a] - origin[a]) * inv[a];
+            float tb = (n.bmax[a] - origin[a]) * inv[a];
+            float tNear = inv[a] >= 0.0f ? ta : tb;
+            float tFar = inv[a] >= 0.0f ? tb : ta;
+            t0 = tNear > t0 ? tNear : t0;
+            t1 = tFar < t1 ? tFar : t1;
+        }
+        return t0 <= t1 ? t0 : -1.0f;
+    };
+
+    struct Entry { uint32_t node; float t; };
+    Entry stack[2 * kBvhForceMedianDepth];
+    int top = 0;
+    float t = enter(nodes[0]);
+    if (t < 0.0f) return false;
+    stack[top++] = { 0, t };
+    bool found = false;
+    while (top > 0) {
+        Entry e = stack[--top];
+        if (e.t > tMax) continue;
+        const BvhNode& n = nodes[e.node];
+        if (n.count > 0) {
+            if (leafHit(n.leftOrFirst, n.count, tMax)) {
+                found = true;
+                if (anyHit) return true;
+            }
+            continue;
+        }
+        // 가까운 자식을 나중에 넣어 먼저 꺼낸다
+        float tl = enter(nodes[n.leftOrFirst]), tr = enter(nodes[n.leftOrFirst + 1]);
+        bool leftFirst = tl <= tr;
+        Entry first = { n.leftOrFirst + (leftFirst ? 0u : 1u), leftFirst ? tl : tr };
+        Entry second = { n.leftOrFirst + (leftFirst ? 1u : 0u), leftFirst ? tr : tl };
+        if (second.t >= 0.0f) stack[top++] = second;
+        if (first.t >= 0.0f) stack[top++] = first;
+    }
+    return found;
+}
@@ -0,0 +1,77 @@
+﻿#include "camera.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CAMERA_SSE2 1
+#include <emmintrin.h>
+#endif
+
+void camera_setup(Camera& cam, const SceneCamera& view, int width, int height, bool fitAspect) {
+    float l = view.l, r = view.r;
+    if (fitAspect && width > 0 && height > 0) {
+        float halfWidth = 0.5f * (view.t - view.b) * width / height;
+        float center = 0.5f * (view.l + view.r);
+        if (halfWidth != 0.5f * (view.r - view.l)) {
+            l = center - halfWidth;
+            r = center + halfWidth;
+        }
+    }
+    float sx = width > 0 ? (r - l) / width : 0.0f;
+    float sy = height > 0 ? (view.t - view.b) / height : 0.0f;
+    for (int a = 0; a < 3; ++a) {
+        cam.eye[a] = view.eye[a];
+        cam.corner[a] = -view.distance * view.w[a] + l * view.u[a] + view.b * view.v[a];
+        cam.du[a] = sx * view.u[a];
+        cam.dv[a] = sy * view.v[a];
+    }
+    cam.width = width;
+    cam.height = height;
+}
+
+void camera_row_dirs(const Camera& cam, int j, float* dx, float* dy, float* dz) {
+    // 줄의 첫 픽셀 중심
+    float y = j + 0.5f;
+    float base[3];
+    for (int a = 0; a < 3; ++a)
+        base[a] = cam.corner[a] + 0.5f * cam.du[a] + y * cam.dv[a];
+
+    int i = 0;
+#if CAMERA_SSE2
+    // 네 픽셀씩: 위치에 4 * du 를 더해 가며 1 / sqrt 로 정규화
+    const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    __m128 px = _mm_add_ps(_mm_set1_ps(base[0]), _mm_mul_ps(lane, _mm_set1_ps(cam.du[0])));
+    __m128 py = _mm_add_ps(_mm_set1_ps(base[1]), _mm_mul_ps(lane, _mm_set1_ps(cam.du[1])));
+    __m128 pz = _mm_add_ps(_mm_set1_ps(base[2]), _mm_mul_ps(lane, _mm_set1_ps(cam.du[2])));
+    const __m128 sx = _mm_set1_ps(4.0f * cam.du[0]);
+    const __m128 sy = _mm_set1_ps(4.0f * cam.du[1]);
+    const __m128 sz = _mm_set1_ps(4.0f * cam.du[2]);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= cam.width; i += 4) {
+        __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), _mm_mul_ps(pz, pz));
+        __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(len2));
+        _mm_storeu_ps(dx + i, _mm_mul_ps(px, inv));
+        _mm_storeu_ps(dy + i, _mm_mul_ps(py, inv));
+        _mm_storeu_ps(dz + i, _mm_mul_ps(pz, inv));
+        px = _mm_add_ps(px, sx);
+        py = _mm_add_ps(py, sy);
+        pz = _mm_add_ps(pz, sz);
+    }
+#endif
+    float p[3];
+    for (int a = 0; a < 3; ++a)
+        p[a] = base[a] + i * cam.du[a];
+    for (; i < cam.width; ++i) {
+        float inv = 1.0f / sqrtf(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        dx[i] = p[0] * inv;
+        dy[i] = p[1] * inv;
+        dz[i] = p[2] * inv;
+        for (int a = 0; a < 3; ++a)
+            p[a] += cam.du[a];
+    }
+}
+
+const char* camera_kernel_name() {
+#if CAMERA_SSE2
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <math.h>
+#include "scene_file.h"
+
+// ----------------------------------------------------------------------------
+// 카메라 광선 생성 (HW1 / HW2 레이 트레이서)
+//   픽셀마다 u_coord = l + (r - l) * (i + 0.5) / Width 처럼 나눗셈 두 번과 기저 조합을 하던 것을
+//   크기가 정해질 때 한 번만 계산한다: 방향 = corner + x * du + y * dv (x, y 는 픽셀 단위 좌표)
+//   - camera_row_dirs: 한 줄의 픽셀 중심 방향을 du 를 더해 가며 만들고 SSE 로 4개씩 정규화
+//   - fitAspect 면 창 비율에 맞춰 가로 범위를 바꾼다 (세로 범위와 중심은 그대로, 정사각형 창이면 그대로)
+//   - look-at / 시야각은 장면 파일의 "target", "up", "fov" (scene_file.h)
+// ----------------------------------------------------------------------------
+struct Camera {
+    float eye[3];
+    float corner[3];       // 픽셀 좌표 (0, 0) 으로 가는 방향 (정규화 전). 첫 줄 = 화면 아래
+    float du[3], dv[3];    // 픽셀 한 칸
+    int   width, height;
+};
+
+void camera_setup(Camera& cam, const SceneCamera& view, int width, int height, bool fitAspect = true);
+
+// 픽셀 좌표 (x, y) 로 가는 정규화된 방향. 픽셀 (i, j) 중심은 (i + 0.5, j + 0.5)
+inline void camera_ray_dir(const Camera& cam, float x, float y, float dir[3]) {
+    for (int a = 0; a < 3; ++a)
+        dir[a] = cam.corner[a] + x * cam.du[a] + y * cam.dv[a];
+    float inv = 1.0f / sqrtf(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+    dir[0] *= inv;
+    dir[1] *= inv;
+    dir[2] *= inv;
+}
+
+// j 번째 줄 픽셀 중심 width 개의 정규화된 방향 (성분별 배열)
+void camera_row_dirs(const Camera& cam, int j, float* dx, float* dy, float* dz);
+
+// 빌드한 커널 이름 ("SSE2" 또는 "scalar")
+const char* camera_kernel_name();
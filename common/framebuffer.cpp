@@ -0,0 +1,141 @@
+﻿#include "framebuffer.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+static const size_t kFramebufferAlign = 64;
+
+static uint8_t* aligned_bytes(size_t size) {
+#if defined(_MSC_VER)
+    return (uint8_t*)_aligned_malloc(size, kFramebufferAlign);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, kFramebufferAlign, size) == 0 ? (uint8_t*)p : nullptr;
+#endif
+}
+
+static void free_aligned_bytes(uint8_t* p) {
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+Framebuffer::~Framebuffer() {
+    free_aligned_bytes(pixels);
+}
+
+void Framebuffer::resize(int w, int h) {
+    resize(w, h, format);
+}
+
+void Framebuffer::resize(int w, int h, FramebufferFormat f) {
+    width = w > 0 ? w : 0;
+    height = h > 0 ? h : 0;
+    format = f;
+    size_t need = bytes();
+    if (need <= capacity) return;
+    free_aligned_bytes(pixels);
+    pixels = aligned_bytes(need);
+    capacity = pixels ? need : 0;
+    if (!pixels) width = height = 0;
+}
+
+void Framebuffer::fill(float r, float g, float b) {
+    if (bytes() == 0) return;
+    // 첫 픽셀을 쓰고 두 배씩 복사해 늘린다
+    set(0, 0, r, g, b);
+    size_t done = pixel_bytes(), total = bytes();
+    while (done < total) {
+        size_t n = done < total - done ? done : total - done;
+        memcpy(pixels + done, pixels, n);
+        done += n;
+    }
+}
+
+void Framebuffer::get(int x, int y, float rgb[3]) const {
+    const uint8_t* p = pixels + ((size_t)y * width + x) * pixel_bytes();
+    for (int c = 0; c < 3; ++c) {
+        switch (format) {
+        case FB_RGB32F: rgb[c] = ((const float*)p)[c]; break;
+        case FB_RGB16F: rgb[c] = half_to_float(((const uint16_t*)p)[c]); break;
+        case FB_RGBA8:  rgb[c] = p[c] * (1.0f / 255.0f); break;
+        }
+    }
+}
+
+void Framebuffer::to_rgb(std::vector<float>& rgb) const {
+    rgb.resize((size_t)width * height * 3);
+    if (format == FB_RGB32F) {
+        if (!rgb.empty()) memcpy(rgb.data(), pixels, bytes());
+        return;
+    }
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x)
+            get(x, y, &rgb[((size_t)y * width + x) * 3]);
+}
+
+// IEEE 754 binary16, 가장 가까운 짝수로 반올림. 너무 크면 inf, 너무 작으면 subnormal / 0
+uint16_t Framebuffer::float_to_half(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000u;
+    uint32_t absx = x & 0x7fffffffu;
+    if (absx >= 0x7f800000u)                              // inf, NaN
+        return (uint16_t)(sign | 0x7c00u | (absx > 0x7f800000u ? 0x200u : 0u));
+    if (absx >= 0x477ff000u)                              // 65520 이상은 반올림하면 inf
+        return (uint16_t)(sign | 0x7c00u);
+    if (absx < 0x38800000u) {                             // 2^-14 미만: subnormal
+        if (absx < 0x33000000u) return (uint16_t)sign;    // 2^-25 미만은 0
+        uint32_t mant = (absx & 0x7fffffu) | 0x800000u;
+        int shift = 126 - (int)(absx >> 23);              // 14 .. 24
+        uint32_t half = mant >> shift;
+        uint32_t rest = mant & ((1u << shift) - 1);
+        uint32_t mid = 1u << (shift - 1);
+        if (rest > mid || (rest == mid && (half & 1u))) ++half;
+        return (uint16_t)(sign | half);
+    }
+    uint32_t h = ((absx - 0x38000000u) >> 13);            // 지수 편향 127 -> 15
+    uint32_t rest = absx & 0x1fffu;
+    if (rest > 0x1000u || (rest == 0x1000u && (h & 1u))) ++h;
+    return (uint16_t)(sign | h);
+}
+
+float Framebuffer::half_to_float(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1fu;
+    uint32_t mant = h & 0x3ffu;
+    uint32_t x;
+    if (exp == 0x1fu) {
+        x = sign | 0x7f800000u | (mant << 13);
+    }
+    else if (exp != 0) {
+        x = sign | ((exp + 112u) << 23) | (mant << 13);
+    }
+    else if (mant == 0) {
+        x = sign;
+    }
+    else {
+        // subnormal: 정규화
+        int e = -1;
+        do {
+            ++e;
+            mant <<= 1;
+        } while (!(mant & 0x400u));
+        x = sign | ((uint32_t)(112 - e) << 23) | ((mant & 0x3ffu) << 13);
+    }
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+const char* framebuffer_format_name(FramebufferFormat format) {
+    switch (format) {
+    case FB_RGB16F: return "RGB16F";
+    case FB_RGBA8:  return "RGBA8";
+    default:        return "RGB32F";
+    }
+}
@@ -0,0 +1,94 @@
+﻿#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// 뷰어 출력 이미지 (EmptyViewer, HW1, HW2_*)
+//   예전에는 OutputImage (std::vector<float>) 를 clear 하고 픽셀마다 push_back 했다.
+//   그러면 화면 순서로만 쓸 수 있고 (스레드로 나눠 쓸 수 없다), clear 뒤에 reserve 하므로
+//   창 크기가 바뀔 때마다 다시 잡혔다.
+//   - set(x, y, rgb) 로 어느 순서로든 쓴다 (다른 픽셀이면 여러 스레드가 동시에 써도 된다)
+//   - 저장 형식: RGB float (기본), RGB half, RGBA8. glDrawPixels 에 그대로 넘긴다
+//   - 저장소는 64 바이트 정렬. resize 는 필요한 크기가 용량보다 클 때만 다시 잡는다
+//   줄 순서는 glDrawPixels 와 같다 (y = 0 이 화면 아래), 줄 사이 여백 없음 (GL_UNPACK_ALIGNMENT 1)
+// ----------------------------------------------------------------------------
+enum FramebufferFormat {
+    FB_RGB32F,          // float 3개 (12 바이트)
+    FB_RGB16F,          // half 3개 (6 바이트)
+    FB_RGBA8,           // [0, 1] 을 8비트로 (4 바이트, 알파 255)
+};
+
+struct Framebuffer {
+    int               width = 0, height = 0;
+    FramebufferFormat format = FB_RGB32F;
+
+    Framebuffer() {}
+    ~Framebuffer();
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+
+    // 크기 (와 형식) 을 바꾼다. 다시 잡을 때만 내용이 사라진다
+    void resize(int w, int h);
+    void resize(int w, int h, FramebufferFormat f);
+
+    void fill(float r, float g, float b);
+
+    void set(int x, int y, float r, float g, float b) {
+        uint8_t* p = pixels + ((size_t)y * width + x) * pixel_bytes();
+        switch (format) {
+        case FB_RGB32F: {
+            float* f = (float*)p;
+            f[0] = r;
+            f[1] = g;
+            f[2] = b;
+            break;
+        }
+        case FB_RGB16F: {
+            uint16_t* h = (uint16_t*)p;
+            h[0] = float_to_half(r);
+            h[1] = float_to_half(g);
+            h[2] = float_to_half(b);
+            break;
+        }
+        case FB_RGBA8:
+            p[0] = to_unorm8(r);
+            p[1] = to_unorm8(g);
+            p[2] = to_unorm8(b);
+            p[3] = 255;
+            break;
+        }
+    }
+    void set(int x, int y, const float rgb[3]) { set(x, y, rgb[0], rgb[1], rgb[2]); }
+
+    void get(int x, int y, float rgb[3]) const;
+
+    // 형식과 무관하게 float RGB (width * height * 3) 로 (비교, 파일 저장용)
+    void to_rgb(std::vector<float>& rgb) const;
+
+    size_t pixel_bytes() const { return format == FB_RGB32F ? 12 : format == FB_RGB16F ? 6 : 4; }
+    size_t bytes() const { return (size_t)width * height * pixel_bytes(); }
+    size_t capacity_bytes() const { return capacity; }
+    const void* data() const { return pixels; }
+
+    // glDrawPixels / glTexImage2D 의 format, type (GL 헤더 없이 값만)
+    unsigned gl_format() const { return format == FB_RGBA8 ? 0x1908u /* GL_RGBA */ : 0x1907u /* GL_RGB */; }
+    unsigned gl_type() const {
+        return format == FB_RGB32F ? 0x1406u     // GL_FLOAT
+             : format == FB_RGB16F ? 0x140Bu     // GL_HALF_FLOAT
+             : 0x1401u;                          // GL_UNSIGNED_BYTE
+    }
+
+    static uint16_t float_to_half(float f);
+    static float    half_to_float(uint16_t h);
+    static uint8_t  to_unorm8(float f) {
+        f = f < 0.0f ? 0.0f : f > 1.0f ? 1.0f : f;
+        return (uint8_t)(f * 255.0f + 0.5f);
+    }
+
+private:
+    uint8_t* pixels = nullptr;
+    size_t   capacity = 0;
+};
+
+const char* framebuffer_format_name(FramebufferFormat format);
@@ -0,0 +1,154 @@
+﻿#include "framebuffer_display.h"
+#include <GL/glew.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+static double elapsed_ms(std::chrono::high_resolution_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+DisplayMode display_mode_from_args(int& argc, char**& argv) {
+    if (argc > 2 && strcmp(argv[1], "-display") == 0) {
+        DisplayMode mode = strcmp(argv[2], "pixels") == 0 ? DISPLAY_DRAW_PIXELS : DISPLAY_PBO_TEXTURE;
+        if (mode == DISPLAY_PBO_TEXTURE && strcmp(argv[2], "pbo") != 0)
+            printf("WARNING: unknown -display %s, using pbo\n", argv[2]);
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+        return mode;
+    }
+    return DISPLAY_PBO_TEXTURE;
+}
+
+void display_init(FramebufferDisplay& display, DisplayMode mode) {
+    display.mode = mode;
+    display.dirty = true;
+    if (mode == DISPLAY_PBO_TEXTURE) {
+        if (glewInit() != GLEW_OK || !GLEW_VERSION_2_1) {
+            printf("WARNING: pixel buffer objects need OpenGL 2.1, using glDrawPixels\n");
+            display.mode = DISPLAY_DRAW_PIXELS;
+        }
+        else {
+            glGenTextures(1, &display.texture);
+            glGenBuffers(1, &display.pbo);
+            display.halfTextures = GLEW_VERSION_3_0 || GLEW_ARB_texture_float;
+            if (!display.halfTextures)
+                printf("WARNING: no half-float textures (OpenGL 3.0 / ARB_texture_float), uploading RGBA8\n");
+        }
+    }
+    printf("[Display] %s\n", display_mode_name(display.mode));
+}
+
+void display_release(FramebufferDisplay& display) {
+    if (display.texture) glDeleteTextures(1, &display.texture);
+    if (display.pbo) glDeleteBuffers(1, &display.pbo);
+    display.texture = display.pbo = 0;
+    display.texWidth = display.texHeight = 0;
+}
+
+// RGB32F 는 RGBA8 로 올린다. RGB16F 는 half-float 텍스처를 만들 수 있을 때만 그대로
+static FramebufferFormat upload_format(const FramebufferDisplay& display, const Framebuffer& fb) {
+    if (fb.format == FB_RGB32F || (fb.format == FB_RGB16F && !display.halfTextures)) return FB_RGBA8;
+    return fb.format;
+}
+
+// float / half RGB 를 PBO 에 RGBA8 로 줄여 쓴다
+template <typename T, typename F>
+static void pack_rgba8(uint8_t* dst, const T* src, size_t pixels, F to_float) {
+    for (size_t k = 0; k < pixels; ++k, src += 3, dst += 4) {
+        dst[0] = Framebuffer::to_unorm8(to_float(src[0]));
+        dst[1] = Framebuffer::to_unorm8(to_float(src[1]));
+        dst[2] = Framebuffer::to_unorm8(to_float(src[2]));
+        dst[3] = 255;
+    }
+}
+
+static void upload(FramebufferDisplay& display, const Framebuffer& fb) {
+    FramebufferFormat format = upload_format(display, fb);
+    GLenum glFormat = format == FB_RGB16F ? GL_RGB : GL_RGBA;
+    GLenum glType = format == FB_RGB16F ? GL_HALF_FLOAT : GL_UNSIGNED_BYTE;
+    glBindTexture(GL_TEXTURE_2D, display.texture);
+    if (fb.width != display.texWidth || fb.height != display.texHeight || format != display.texFormat) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, format == FB_RGB16F ? GL_RGB16F : GL_RGBA8, fb.width, fb.height, 0, glFormat,
+                     glType, nullptr);
+        display.texWidth = fb.width;
+        display.texHeight = fb.height;
+        display.texFormat = format;
+    }
+
+    size_t bytes = (size_t)fb.width * fb.height * (format == FB_RGB16F ? 6 : 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, display.pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    uint8_t* dst = (uint8_t*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (dst) {
+        if (format == fb.format) {
+            memcpy(dst, fb.data(), bytes);
+        }
+        else if (fb.format == FB_RGB16F) {
+            pack_rgba8(dst, (const uint16_t*)fb.data(), (size_t)fb.width * fb.height, Framebuffer::half_to_float);
+        }
+        else {
+            pack_rgba8(dst, (const float*)fb.data(), (size_t)fb.width * fb.height, [](float f) { return f; });
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        // PBO 가 묶여 있으면 마지막 인자는 버퍼 안의 오프셋
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, fb.width, fb.height, glFormat, glType, nullptr);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void display_draw(FramebufferDisplay& display, const Framebuffer& fb, int width, int height) {
+    if (fb.width == 0 || fb.height == 0) return;
+    if (width <= 0 || height <= 0) {
+        width = fb.width;
+        height = fb.height;
+    }
+    bool stretch = width != fb.width || height != fb.height;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    if (display.mode == DISPLAY_DRAW_PIXELS) {
+        if (stretch) glPixelZoom((float)width / fb.width, (float)height / fb.height);
+        glDrawPixels(fb.width, fb.height, fb.gl_format(), fb.gl_type(), fb.data());
+        if (stretch) glPixelZoom(1.0f, 1.0f);
+    }
+    else {
+        if (display.dirty) {
+            upload(display, fb);
+            display.dirty = false;
+            display.uploads++;
+            display.uploadMs += elapsed_ms(t0);
+        }
+        glBindTexture(GL_TEXTURE_2D, display.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, stretch ? GL_LINEAR : GL_NEAREST);
+        glEnable(GL_TEXTURE_2D);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+        glBegin(GL_QUADS);
+        glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, 0.0f);
+        glTexCoord2f(1.0f, 0.0f); glVertex2f((float)width, 0.0f);
+        glTexCoord2f(1.0f, 1.0f); glVertex2f((float)width, (float)height);
+        glTexCoord2f(0.0f, 1.0f); glVertex2f(0.0f, (float)height);
+        glEnd();
+        glDisable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    display.drawMs += elapsed_ms(t0);
+
+    if (++display.frames == kDisplayReportFrames) {
+        printf("[Display] %s %dx%d %s: %.3f ms CPU/frame", display_mode_name(display.mode), fb.width, fb.height,
+               framebuffer_format_name(fb.format), display.drawMs / display.frames);
+        if (display.mode == DISPLAY_PBO_TEXTURE)
+            printf(", %d uploads (%.2f ms each, %s)", display.uploads,
+                   display.uploads ? display.uploadMs / display.uploads : 0.0, framebuffer_format_name(display.texFormat));
+        printf("\n");
+        display.frames = display.uploads = 0;
+        display.drawMs = display.uploadMs = 0.0;
+    }
+}
+
+const char* display_mode_name(DisplayMode mode) {
+    return mode == DISPLAY_DRAW_PIXELS ? "glDrawPixels" : "PBO texture";
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+#include "framebuffer.h"
+
+// ----------------------------------------------------------------------------
+// 뷰어 화면 출력 (EmptyViewer, HW1, HW2_*)
+//   DISPLAY_DRAW_PIXELS: 예전처럼 매 프레임 glDrawPixels. float RGB 면 드라이버가 CPU 에서
+//     변환하므로 영상이 그대로여도 매 프레임 비싸다
+//   DISPLAY_PBO_TEXTURE: 영상이 바뀌었을 때 (dirty) 만 픽셀 버퍼 (PBO) 를 거쳐 텍스처로 올리고,
+//     매 프레임은 텍스처 입힌 사각형 하나만 그린다
+//       - RGBA8 / RGB16F Framebuffer 는 그대로 올린다
+//       - RGB32F 는 PBO 에 복사하면서 RGBA8 로 줄인다 (화면은 8비트라 보이는 차이 없음)
+//       - RGB16F 텍스처 (OpenGL 3.0 또는 ARB_texture_float) 가 없으면 RGB16F 도 RGBA8 로 줄인다
+//       - PBO 는 매번 glBufferData(NULL) 로 버리고 다시 받아 GPU 가 쓰는 중인 버퍼를 기다리지 않는다
+//   뷰어의 glOrtho(0, Width, 0, Height) 투영을 그대로 쓰고, glDrawPixels 와 같이 (0, 0) 부터 그린다.
+//   늘려 그릴 때는 PBO 방식은 선형 필터, glDrawPixels 는 glPixelZoom.
+//   두 방식 모두 출력에 쓴 CPU 시간을 재서 kDisplayReportFrames 프레임마다 출력한다
+// ----------------------------------------------------------------------------
+const int kDisplayReportFrames = 600;
+
+enum DisplayMode {
+    DISPLAY_DRAW_PIXELS,
+    DISPLAY_PBO_TEXTURE,
+};
+
+struct FramebufferDisplay {
+    DisplayMode       mode = DISPLAY_PBO_TEXTURE;
+    bool              dirty = true;     // 다음 display_draw 에서 텍스처를 다시 올린다
+
+    // GL 객체 (PBO 방식)
+    unsigned          texture = 0, pbo = 0;
+    int               texWidth = 0, texHeight = 0;
+    FramebufferFormat texFormat = FB_RGBA8;
+    bool              halfTextures = false;     // GL_RGB16F 텍스처를 만들 수 있다
+
+    // 측정 (kDisplayReportFrames 마다 비운다)
+    int               frames = 0, uploads = 0;
+    double            drawMs = 0.0, uploadMs = 0.0;
+};
+
+// 인자 맨 앞의 "-display pixels|pbo" 를 읽고 argv 에서 뺀다 (없으면 PBO)
+DisplayMode display_mode_from_args(int& argc, char**& argv);
+
+// GL context 가 current 여야 한다 (glewInit 도 여기서). PBO 를 못 쓰면 glDrawPixels 로 되돌린다
+void display_init(FramebufferDisplay& display, DisplayMode mode);
+void display_release(FramebufferDisplay& display);
+
+// Framebuffer 내용이 바뀌었을 때 (렌더링, 창 크기 변경) 부른다
+inline void display_mark_dirty(FramebufferDisplay& display) { display.dirty = true; }
+
+// 한 프레임 그리기 (glClear 뒤, SwapBuffers 전). width, height 를 주면 (0, 0) 부터 그 크기로
+// 늘려 그린다 (창 크기와 다른 해상도의 미리보기나 이전 영상). 0 이면 fb 크기 그대로
+void display_draw(FramebufferDisplay& display, const Framebuffer& fb, int width = 0, int height = 0);
+
+const char* display_mode_name(DisplayMode mode);
@@ -0,0 +1,96 @@
+﻿#include "light_tiles.h"
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+// ----------------------------------------------------------------------------
+// 영향 구의 보수적인 화면 사각형 (ndc). 구가 near 평면에 걸치면 화면 전체.
+// ----------------------------------------------------------------------------
+static void project_sphere(const TileLight& l, const LightTileCamera& cam,
+                           float& x0, float& x1, float& y0, float& y1) {
+    float zn = -(l.z + l.radius);   // 가까운 쪽 거리
+    float zf = -(l.z - l.radius);   // 먼 쪽 거리
+    if (zn <= cam.nearPlane) {
+        x0 = y0 = -1.0f; x1 = y1 = 1.0f;
+        return;
+    }
+    // x/(-z) 의 최소/최대: 분자의 부호에 따라 가까운/먼 거리로 나눈다
+    float lo = l.x - l.radius, hi = l.x + l.radius;
+    x0 = cam.sx * (lo >= 0 ? lo / zf : lo / zn);
+    x1 = cam.sx * (hi >= 0 ? hi / zn : hi / zf);
+    lo = l.y - l.radius; hi = l.y + l.radius;
+    y0 = cam.sy * (lo >= 0 ? lo / zf : lo / zn);
+    y1 = cam.sy * (hi >= 0 ? hi / zn : hi / zf);
+}
+
+void bin_lights(LightTileGrid& grid, int width, int height,
+                const LightTileCamera& camera, const float* viewDepth,
+                const TileLight* lights, int lightCount) {
+    const int ts = kLightTileSize;
+    grid.tileSize = ts;
+    grid.tilesX = (width + ts - 1) / ts;
+    grid.tilesY = (height + ts - 1) / ts;
+    const int tileCount = grid.tilesX * grid.tilesY;
+
+    // 1) 타일별 깊이 범위 (비어 있는 타일은 min > max)
+    std::vector<float> tileMin(tileCount, FLT_MAX), tileMax(tileCount, -FLT_MAX);
+    for (int y = 0; y < height; ++y) {
+        const float* row = viewDepth + (size_t)y * width;
+        int ty = y / ts;
+        for (int x = 0; x < width; ++x) {
+            float d = row[x];
+            if (d <= 0.0f) continue;
+            int t = ty * grid.tilesX + x / ts;
+            tileMin[t] = std::min(tileMin[t], d);
+            tileMax[t] = std::max(tileMax[t], d);
+        }
+    }
+
+    // 2) 광원마다 걸치는 타일 범위를 구해 타일별 목록에 넣는다 (개수 세기 -> 채우기)
+    struct Rect { int tx0, tx1, ty0, ty1; float d0, d1; };
+    std::vector<Rect> rects(lightCount);
+    std::vector<uint32_t> counts(tileCount + 1, 0);
+    for (int i = 0; i < lightCount; ++i) {
+        const TileLight& l = lights[i];
+        Rect& r = rects[i];
+        if (l.radius <= 0.0f) {
+            r = { 0, grid.tilesX - 1, 0, grid.tilesY - 1, 0.0f, FLT_MAX };
+        }
+        else {
+            float x0, x1, y0, y1;
+            project_sphere(l, camera, x0, x1, y0, y1);
+            if (camera.flipY) { float t = -y0; y0 = -y1; y1 = t; }
+            if (x1 < -1.0f || x0 > 1.0f || y1 < -1.0f || y0 > 1.0f) {
+                r = { 0, -1, 0, -1, 0.0f, 0.0f };   // 화면 밖
+                continue;
+            }
+            r.tx0 = std::max(0, (int)floorf((x0 + 1.0f) * 0.5f * width) / ts);
+            r.tx1 = std::min(grid.tilesX - 1, (int)floorf((x1 + 1.0f) * 0.5f * width) / ts);
+            r.ty0 = std::max(0, (int)floorf((y0 + 1.0f) * 0.5f * height) / ts);
+            r.ty1 = std::min(grid.tilesY - 1, (int)floorf((y1 + 1.0f) * 0.5f * height) / ts);
+            r.d0 = -l.z - l.radius;
+            r.d1 = -l.z + l.radius;
+        }
+        for (int ty = r.ty0; ty <= r.ty1; ++ty)
+            for (int tx = r.tx0; tx <= r.tx1; ++tx) {
+                int t = ty * grid.tilesX + tx;
+                if (r.d1 >= tileMin[t] && r.d0 <= tileMax[t]) counts[t + 1]++;
+            }
+    }
+
+    grid.offsets.resize(tileCount + 1);
+    grid.offsets[0] = 0;
+    for (int t = 0; t < tileCount; ++t)
+        grid.offsets[t + 1] = grid.offsets[t] + counts[t + 1];
+    grid.indices.resize(grid.offsets[tileCount]);
+
+    std::vector<uint32_t> cursor(grid.offsets.begin(), grid.offsets.end() - 1);
+    for (int i = 0; i < lightCount; ++i) {
+        const Rect& r = rects[i];
+        for (int ty = r.ty0; ty <= r.ty1; ++ty)
+            for (int tx = r.tx0; tx <= r.tx1; ++tx) {
+                int t = ty * grid.tilesX + tx;
+                if (r.d1 >= tileMin[t] && r.d0 <= tileMax[t]) grid.indices[cursor[t]++] = (uint32_t)i;
+            }
+    }
+}
@@ -0,0 +1,45 @@
+﻿#pragma once
+#include <stdint.h>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Tiled forward+ 조명 분류 (HW6_Q3 소프트웨어 래스터라이저와 HW7_Q1 GL 경로가 같이 사용)
+//   depth pre-pass 결과로 타일(기본 16x16 픽셀)마다 시점 공간 깊이 범위를 구하고,
+//   점광원의 영향 구가 타일의 화면 영역과 깊이 범위에 걸치는 경우에만 목록에 넣는다.
+//   좌표는 시점 공간 (카메라가 원점에서 -z 를 바라봄), 투영은 x_ndc = sx * x / -z.
+// ----------------------------------------------------------------------------
+const int kLightTileSize = 16;
+
+struct TileLight {
+    float x, y, z;      // 시점 공간 위치
+    float radius;       // 영향 반경 (<= 0 이면 감쇠 없음, 모든 타일에 들어감)
+    float r, g, b;      // Il
+    float pad;
+};
+
+struct LightTileGrid {
+    int tileSize;
+    int tilesX, tilesY;
+    std::vector<uint32_t> offsets;   // 타일 t 의 광원: indices[offsets[t] .. offsets[t+1])
+    std::vector<uint32_t> indices;
+};
+
+struct LightTileCamera {
+    float sx, sy;       // 투영 배율 (P[0][0], P[1][1])
+    float nearPlane;    // 양수 거리
+    bool  flipY;        // true: 깊이 배열 0 번째 줄이 화면 위쪽 (ndc y = +1)
+};
+
+// viewDepth: width*height 개의 시점 공간 거리 (-z, 양수). 배경은 0 또는 음수.
+void bin_lights(LightTileGrid& grid, int width, int height,
+                const LightTileCamera& camera, const float* viewDepth,
+                const TileLight* lights, int lightCount);
+
+// 빛 하나의 감쇠 (반경 밖은 0, 안쪽은 (1 - (d/r)^2)^2 로 부드럽게 줄어듦)
+inline float light_attenuation(float distance, float radius) {
+    if (radius <= 0.0f) return 1.0f;
+    float t = distance / radius;
+    if (t >= 1.0f) return 0.0f;
+    float s = 1.0f - t * t;
+    return s * s;
+}
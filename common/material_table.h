@@ -0,0 +1,31 @@
+﻿#pragma once
+#include <stdint.h>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// 재질 테이블 (HW2 레이 트레이서)
+//   물체는 재질 번호만 갖고, 셰이딩은 그 번호로 속성별 배열을 한 번씩 읽는다.
+//   ka/kd/ks 는 재질당 float 3개, specPow 는 1개. 재질이 몇 개든 조회 비용은 같다.
+//   specPow == 0 이면 pow(x, 0) = 1 이라 정반사 항은 ks 그대로 (반사 벡터, pow 불필요)
+//   kr/kt/ior 는 Whitted 추적의 2차 광선용 (SceneMaterial 과 같은 의미)
+// ----------------------------------------------------------------------------
+struct MaterialTable {
+    std::vector<float> ka, kd, ks;
+    std::vector<float> specPow;
+    std::vector<float> kr, kt, ior;
+
+    size_t size() const { return specPow.size(); }
+
+    // 새 재질의 번호를 돌려준다
+    uint32_t add(const float a[3], const float d[3], const float s[3], float p,
+                 float r = 0.0f, float t = 0.0f, float n = 1.0f) {
+        ka.insert(ka.end(), a, a + 3);
+        kd.insert(kd.end(), d, d + 3);
+        ks.insert(ks.end(), s, s + 3);
+        specPow.push_back(p);
+        kr.push_back(r);
+        kt.push_back(t);
+        ior.push_back(n);
+        return (uint32_t)(specPow.size() - 1);
+    }
+};
@@ -0,0 +1,668 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include "mesh_bvh.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#if defined(__AVX__)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_BVH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// OBJ
+// ----------------------------------------------------------------------------
+bool load_obj_mesh(const char* filename, TriMesh& mesh) {
+    mesh = TriMesh();
+    FILE* f = fopen(filename, "rb");
+    if (!f) {
+        printf("ERROR: cannot open %s\n", filename);
+        return false;
+    }
+    char line[1024];
+    int lineNo = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        ++lineNo;
+        float x, y, z;
+        if (!strncmp(line, "v ", 2) && sscanf(line + 2, "%f %f %f", &x, &y, &z) == 3) {
+            mesh.positions.insert(mesh.positions.end(), { x, y, z });
+        }
+        else if (!strncmp(line, "vn ", 3) && sscanf(line + 3, "%f %f %f", &x, &y, &z) == 3) {
+            mesh.normals.insert(mesh.normals.end(), { x, y, z });
+        }
+        else if (!strncmp(line, "f ", 2)) {
+            // "a", "a//a", "a/t/n" 모두 첫 번호만 쓴다. 사각형 이상은 부채꼴로 나눈다
+            uint32_t face[16];
+            int n = 0;
+            for (char* tok = strtok(line + 2, " \t\r\n"); tok && n < 16; tok = strtok(NULL, " \t\r\n")) {
+                long index = strtol(tok, NULL, 10);
+                if (index <= 0) {
+                    printf("ERROR: %s:%d: unsupported face index '%s'\n", filename, lineNo, tok);
+                    ok = false;
+                    break;
+                }
+                face[n++] = (uint32_t)(index - 1);
+            }
+            for (int k = 2; ok && k < n; ++k)
+                mesh.indices.insert(mesh.indices.end(), { face[0], face[k - 1], face[k] });
+        }
+    }
+    fclose(f);
+
+    size_t vertexCount = mesh.vertex_count();
+    for (uint32_t index : mesh.indices)
+        if (ok && index >= vertexCount) {
+            printf("ERROR: %s: face uses vertex %u of %u\n", filename, index + 1, (unsigned)vertexCount);
+            ok = false;
+        }
+    if (!ok || mesh.indices.empty()) {
+        if (ok) printf("ERROR: %s: no faces\n", filename);
+        mesh = TriMesh();
+        return false;
+    }
+
+    // vn 이 정점마다 하나씩 있지 않으면 면 노멀 (면적 가중) 평균으로 만든다
+    if (mesh.normals.size() != mesh.positions.size()) {
+        mesh.normals.assign(mesh.positions.size(), 0.0f);
+        const float* p = mesh.positions.data();
+        for (size_t t = 0; t < mesh.indices.size(); t += 3) {
+            const uint32_t* tri = &mesh.indices[t];
+            float e1[3], e2[3];
+            for (int a = 0; a < 3; ++a) {
+                e1[a] = p[tri[1] * 3 + a] - p[tri[0] * 3 + a];
+                e2[a] = p[tri[2] * 3 + a] - p[tri[0] * 3 + a];
+            }
+            float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            for (int k = 0; k < 3; ++k)
+                for (int a = 0; a < 3; ++a)
+                    mesh.normals[tri[k] * 3 + a] += n[a];
+        }
+    }
+    for (size_t v = 0; v < mesh.normals.size(); v += 3) {
+        float* n = &mesh.normals[v];
+        float len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (len > 0.0f) { n[0] /= len; n[1] /= len; n[2] /= len; }
+    }
+    return true;
+}
+
+void place_mesh(TriMesh& mesh, const float center[3], float scale) {
+    float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t v = 0; v < mesh.positions.size(); v += 3)
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], mesh.positions[v + a]);
+            hi[a] = std::max(hi[a], mesh.positions[v + a]);
+        }
+    float extent = std::max({ hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2] });
+    float s = extent > 0.0f ? 2.0f * scale / extent : 1.0f;
+    for (size_t v = 0; v < mesh.positions.size(); v += 3)
+        for (int a = 0; a < 3; ++a)
+            mesh.positions[v + a] = (mesh.positions[v + a] - 0.5f * (lo[a] + hi[a])) * s + center[a];
+}
+
+// ----------------------------------------------------------------------------
+// 빌드: 삼각형 상자로 build_bvh (bvh_build.h) 를 부르고 잎마다 TriBlock8 을 채운다
+// ----------------------------------------------------------------------------
+static void fill_block(const TriMesh& mesh, TriBlock8& block, const uint32_t* triangles, uint32_t count) {
+    const float* p = mesh.positions.data();
+    memset(&block, 0, sizeof(block));
+    for (int lane = 0; lane < kBvhLeafSize; ++lane) {
+        if ((uint32_t)lane >= count) {
+            block.triangle[lane] = UINT32_MAX;
+            continue;
+        }
+        uint32_t t = triangles[lane];
+        const uint32_t* tri = &mesh.indices[t * 3];
+        for (int a = 0; a < 3; ++a) {
+            block.v0[a][lane] = p[tri[0] * 3 + a];
+            block.e1[a][lane] = p[tri[1] * 3 + a] - p[tri[0] * 3 + a];
+            block.e2[a][lane] = p[tri[2] * 3 + a] - p[tri[0] * 3 + a];
+        }
+        block.triangle[lane] = t;
+    }
+}
+
+static void triangle_bounds(const TriMesh& mesh, uint32_t t, float lo[3], float hi[3]) {
+    for (int a = 0; a < 3; ++a) {
+        lo[a] = FLT_MAX;
+        hi[a] = -FLT_MAX;
+    }
+    for (int k = 0; k < 3; ++k) {
+        const float* v = &mesh.positions[mesh.indices[t * 3 + k] * 3];
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], v[a]);
+            hi[a] = std::max(hi[a], v[a]);
+        }
+    }
+}
+
+void build_mesh_bvh(MeshBvh& bvh, const TriMesh& mesh, int threads, BvhBuildMethod method) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    bvh.nodes.clear();
+    bvh.blocks.clear();
+    bvh.wide.clear();
+
+    size_t count = mesh.triangle_count();
+    std::vector<float> bounds(count * 6);
+    for (size_t t = 0; t < count; ++t)
+        triangle_bounds(mesh, (uint32_t)t, &bounds[t * 6], &bounds[t * 6 + 3]);
+
+    BvhBuildOptions options;
+    options.method = method;
+    options.threads = threads;
+    options.maxLeafSize = kBvhLeafSize;
+    BvhBuildResult result;
+    build_bvh(bounds.data(), count, options, result);
+
+    bvh.nodes.swap(result.nodes);
+    bvh.blocks.reserve(count / 4 + 1);
+    for (BvhNode& node : bvh.nodes) {
+        if (node.count == 0) continue;
+        bvh.blocks.emplace_back();
+        fill_block(mesh, bvh.blocks.back(), &result.order[node.leftOrFirst], node.count);
+        node.leftOrFirst = (uint32_t)(bvh.blocks.size() - 1);
+    }
+    bvh.buildThreads = result.threads;
+    bvh.buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+void refit_mesh_bvh(MeshBvh& bvh, const TriMesh& mesh) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    refit_bvh(bvh.nodes, [&](const BvhNode& node, float lo[3], float hi[3]) {
+        TriBlock8& block = bvh.blocks[node.leftOrFirst];
+        uint32_t triangles[kBvhLeafSize];
+        memcpy(triangles, block.triangle, sizeof(triangles));
+        fill_block(mesh, block, triangles, node.count);
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = FLT_MAX;
+            hi[a] = -FLT_MAX;
+        }
+        for (uint32_t lane = 0; lane < node.count; ++lane) {
+            float tlo[3], thi[3];
+            triangle_bounds(mesh, block.triangle[lane], tlo, thi);
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::min(lo[a], tlo[a]);
+                hi[a] = std::max(hi[a], thi[a]);
+            }
+        }
+    });
+    if (!bvh.wide.empty())
+        collapse_mesh_bvh4(bvh);
+    bvh.refitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+// ----------------------------------------------------------------------------
+// 4-wide 로 접기
+// ----------------------------------------------------------------------------
+static float node_area(const BvhNode& n) {
+    float dx = n.bmax[0] - n.bmin[0], dy = n.bmax[1] - n.bmin[1], dz = n.bmax[2] - n.bmin[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+// 이진 노드 binary 아래를 wide 노드 하나로 만들고 그 번호를 돌려준다
+static uint32_t collapse_node(MeshBvh& bvh, uint32_t binary) {
+    // 자식 후보: 내부 노드 중 넓이가 가장 큰 것을 두 자식으로 바꾸기를 4개가 될 때까지
+    uint32_t kids[4];
+    int count = 0;
+    const BvhNode& root = bvh.nodes[binary];
+    if (root.count > 0) {
+        kids[count++] = binary;
+    }
+    else {
+        kids[count++] = root.leftOrFirst;
+        kids[count++] = root.leftOrFirst + 1;
+    }
+    while (count < 4) {
+        int best = -1;
+        float bestArea = -1.0f;
+        for (int k = 0; k < count; ++k) {
+            const BvhNode& n = bvh.nodes[kids[k]];
+            if (n.count == 0 && node_area(n) > bestArea) {
+                bestArea = node_area(n);
+                best = k;
+            }
+        }
+        if (best < 0) break;
+        uint32_t left = bvh.nodes[kids[best]].leftOrFirst;
+        kids[best] = left;
+        kids[count++] = left + 1;
+    }
+
+    uint32_t index = (uint32_t)bvh.wide.size();
+    bvh.wide.emplace_back();
+    Bvh4Node w;
+    memset(&w, 0, sizeof(w));
+    w.childCount = (uint8_t)count;
+
+    // 부모 상자 = 자식 상자의 합. 축마다 255 칸에 들어가는 가장 작은 2 의 거듭제곱 간격
+    float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (int k = 0; k < count; ++k)
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], bvh.nodes[kids[k]].bmin[a]);
+            hi[a] = std::max(hi[a], bvh.nodes[kids[k]].bmax[a]);
+        }
+    for (int a = 0; a < 3; ++a) {
+        int e = 0;
+        frexpf((hi[a] - lo[a]) / 255.0f, &e);
+        e = std::max(e, -126);
+        w.origin[a] = lo[a];
+        w.exponent[a] = (int8_t)e;
+        float step = ldexpf(1.0f, e);
+        for (int k = 0; k < 4; ++k) {
+            if (k >= count) {
+                w.qlo[a][k] = 255;
+                w.qhi[a][k] = 0;
+                continue;
+            }
+            const BvhNode& n = bvh.nodes[kids[k]];
+            int qlo = std::max(0, (int)floorf((n.bmin[a] - lo[a]) / step));
+            int qhi = std::min(255, (int)ceilf((n.bmax[a] - lo[a]) / step));
+            // 복원할 때의 반올림까지 고려해 한 칸씩 더 넓힌다
+            while (qlo > 0 && lo[a] + qlo * step > n.bmin[a]) --qlo;
+            while (qhi < 255 && lo[a] + qhi * step < n.bmax[a]) ++qhi;
+            // 납작한 자식도 두께 한 칸 (경계 위를 스치는 광선이 tFar = tNear = 0 으로 빠지지 않게)
+            if (qhi == qlo) {
+                if (qhi < 255) ++qhi;
+                else --qlo;
+            }
+            w.qlo[a][k] = (uint8_t)qlo;
+            w.qhi[a][k] = (uint8_t)qhi;
+        }
+    }
+    for (int k = 0; k < 4; ++k)
+        w.child[k] = kBvh4Empty;
+    bvh.wide[index] = w;
+
+    // 자식 wide 노드는 이 노드 뒤에 깊이 우선으로 붙는다 (벡터가 다시 할당되므로 번호로만 접근)
+    for (int k = 0; k < count; ++k) {
+        const BvhNode& n = bvh.nodes[kids[k]];
+        uint32_t child = n.count > 0 ? (kBvh4Leaf | n.leftOrFirst) : collapse_node(bvh, kids[k]);
+        bvh.wide[index].child[k] = child;
+    }
+    return index;
+}
+
+void collapse_mesh_bvh4(MeshBvh& bvh) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    bvh.wide.clear();
+    if (!bvh.blocks.empty()) {
+        bvh.wide.reserve(bvh.nodes.size() / 3 + 1);
+        collapse_node(bvh, 0);
+    }
+    bvh.collapseMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+size_t mesh_bvh_bytes(const MeshBvh& bvh) {
+    size_t nodes = bvh.wide.empty() ? bvh.nodes.size() * sizeof(BvhNode) : bvh.wide.size() * sizeof(Bvh4Node);
+    return nodes + bvh.blocks.size() * sizeof(TriBlock8);
+}
+
+// ----------------------------------------------------------------------------
+// 순회
+// ----------------------------------------------------------------------------
+struct BvhRay {
+    float o[3], d[3], inv[3];
+};
+
+// -0 도 +0 으로 바꿔 성분이 0 이면 inv 는 항상 +inf
+static void make_ray(BvhRay& r, const float origin[3], const float dir[3]) {
+    for (int a = 0; a < 3; ++a) {
+        r.o[a] = origin[a];
+        r.d[a] = dir[a];
+        r.inv[a] = 1.0f / (dir[a] == 0.0f ? 0.0f : dir[a]);
+    }
+}
+
+// slab 검사. 맞으면 들어가는 t
+// 상자 검사에서 반올림으로 가장자리를 놓치지 않도록 tFar 를 늘리는 비율. 상자가 광선 원점의
+// float 간격보다 작으면 (멀리 있는 작은 메쉬) tNear 와 tFar 가 반올림 차이만큼 뒤집힐 수 있다
+static const float kBoxGrow = 1.0f + 4.0f * FLT_EPSILON;
+
+static bool hit_box(const BvhNode& n, const BvhRay& r, float tMax, float& tEnter) {
+    // 광선이 면 평면 위에 있으면 0 * inf = NaN. 비교가 거짓이 되는 쪽으로 써서 그 축은 무시한다
+    float t0 = 0.0f, t1 = tMax;
+    for (int a = 0; a < 3; ++a) {
+        float ta = (n.bmin[a] - r.o[a]) * r.inv[a];
+        float tb = (n.bmax[a] - r.o[a]) * r.inv[a];
+        float tNear = r.inv[a] >= 0.0f ? ta : tb;
+        float tFar = r.inv[a] >= 0.0f ? tb : ta;
+        t0 = tNear > t0 ? tNear : t0;
+        t1 = tFar < t1 ? tFar : t1;
+    }
+    tEnter = t0;
+    return t0 <= t1 * kBoxGrow;
+}
+
+#if defined(__AVX__)
+static int lowest_bit(int mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, (unsigned long)mask);
+    return (int)index;
+#else
+    return __builtin_ctz((unsigned)mask);
+#endif
+}
+#endif
+
+// 블록의 8 개 삼각형 중 (0, tMax) 안의 가장 가까운 교차. 없으면 -1
+static int intersect_block(const TriBlock8& b, const BvhRay& r, float tMax, float& tHit, float& uHit, float& vHit) {
+#if defined(__AVX__)
+    const __m256 ox = _mm256_set1_ps(r.o[0]), oy = _mm256_set1_ps(r.o[1]), oz = _mm256_set1_ps(r.o[2]);
+    const __m256 dx = _mm256_set1_ps(r.d[0]), dy = _mm256_set1_ps(r.d[1]), dz = _mm256_set1_ps(r.d[2]);
+    const __m256 e1x = _mm256_loadu_ps(b.e1[0]), e1y = _mm256_loadu_ps(b.e1[1]), e1z = _mm256_loadu_ps(b.e1[2]);
+    const __m256 e2x = _mm256_loadu_ps(b.e2[0]), e2y = _mm256_loadu_ps(b.e2[1]), e2z = _mm256_loadu_ps(b.e2[2]);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+
+    // p = d x e2, det = e1 . p
+    __m256 px = _mm256_sub_ps(_mm256_mul_ps(dy, e2z), _mm256_mul_ps(dz, e2y));
+    __m256 py = _mm256_sub_ps(_mm256_mul_ps(dz, e2x), _mm256_mul_ps(dx, e2z));
+    __m256 pz = _mm256_sub_ps(_mm256_mul_ps(dx, e2y), _mm256_mul_ps(dy, e2x));
+    __m256 det = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e1x, px), _mm256_mul_ps(e1y, py)), _mm256_mul_ps(e1z, pz));
+    __m256 inv = _mm256_div_ps(one, det);
+
+    // s = o - v0, u = (s . p) / det
+    __m256 sx = _mm256_sub_ps(ox, _mm256_loadu_ps(b.v0[0]));
+    __m256 sy = _mm256_sub_ps(oy, _mm256_loadu_ps(b.v0[1]));
+    __m256 sz = _mm256_sub_ps(oz, _mm256_loadu_ps(b.v0[2]));
+    __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sx, px), _mm256_mul_ps(sy, py)), _mm256_mul_ps(sz, pz)), inv);
+
+    // q = s x e1, v = (d . q) / det, t = (e2 . q) / det
+    __m256 qx = _mm256_sub_ps(_mm256_mul_ps(sy, e1z), _mm256_mul_ps(sz, e1y));
+    __m256 qy = _mm256_sub_ps(_mm256_mul_ps(sz, e1x), _mm256_mul_ps(sx, e1z));
+    __m256 qz = _mm256_sub_ps(_mm256_mul_ps(sx, e1y), _mm256_mul_ps(sy, e1x));
+    __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, qx), _mm256_mul_ps(dy, qy)), _mm256_mul_ps(dz, qz)), inv);
+    __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e2x, qx), _mm256_mul_ps(e2y, qy)), _mm256_mul_ps(e2z, qz)), inv);
+
+    // det == 0 (빈 칸, 평행) 이면 inv 가 inf 라 u/v/t 가 NaN 이나 inf 가 되어 아래 비교에서 빠진다
+    __m256 mask = _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+    mask = _mm256_and_ps(mask, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+    mask = _mm256_and_ps(mask, _mm256_cmp_ps(t, zero, _CMP_GT_OQ));
+    mask = _mm256_and_ps(mask, _mm256_cmp_ps(t, _mm256_set1_ps(tMax), _CMP_LT_OQ));
+    if (_mm256_testz_ps(mask, mask)) return -1;
+
+    // 맞은 칸 중 가장 작은 t
+    __m256 tm = _mm256_blendv_ps(_mm256_set1_ps(FLT_MAX), t, mask);
+    __m256 m = _mm256_min_ps(tm, _mm256_permute2f128_ps(tm, tm, 1));
+    m = _mm256_min_ps(m, _mm256_permute_ps(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm256_min_ps(m, _mm256_permute_ps(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    int lane = lowest_bit(_mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(tm, m, _CMP_EQ_OQ), mask)));
+    float ts[8], us[8], vs[8];
+    _mm256_storeu_ps(ts, t);
+    _mm256_storeu_ps(us, u);
+    _mm256_storeu_ps(vs, v);
+    tHit = ts[lane];
+    uHit = us[lane];
+    vHit = vs[lane];
+    return lane;
+#else
+    int best = -1;
+    for (int k = 0; k < kBvhLeafSize; ++k) {
+        float e1[3] = { b.e1[0][k], b.e1[1][k], b.e1[2][k] };
+        float e2[3] = { b.e2[0][k], b.e2[1][k], b.e2[2][k] };
+        float p[3] = { r.d[1] * e2[2] - r.d[2] * e2[1], r.d[2] * e2[0] - r.d[0] * e2[2], r.d[0] * e2[1] - r.d[1] * e2[0] };
+        float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        float inv = 1.0f / det;
+        float s[3] = { r.o[0] - b.v0[0][k], r.o[1] - b.v0[1][k], r.o[2] - b.v0[2][k] };
+        float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv;
+        float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+        float v = (r.d[0] * q[0] + r.d[1] * q[1] + r.d[2] * q[2]) * inv;
+        float t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv;
+        if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t > 0.0f && t < tMax) {
+            tMax = t;
+            tHit = t;
+            uHit = u;
+            vHit = v;
+            best = k;
+        }
+    }
+    return best;
+#endif
+}
+
+// anyHit 이면 처음 맞은 잎에서 멈춘다
+static bool traverse2(const MeshBvh& bvh, const float origin[3], const float dir[3], float tMax, bool anyHit,
+                      MeshHit* hit, BvhTraceStats* stats) {
+    if (bvh.blocks.empty()) return false;
+    BvhRay r;
+    make_ray(r, origin, dir);
+
+    struct Entry { uint32_t node; float t; };
+    Entry stack[kBvhStackSize];
+    int top = 0;
+    float tEnter;
+    if (bvh.nodes.empty() || !hit_box(bvh.nodes[0], r, tMax, tEnter)) return false;
+    stack[top++] = { 0, tEnter };
+
+    bool found = false;
+    while (top > 0) {
+        Entry e = stack[--top];
+        if (e.t > tMax) continue;   // 넣은 뒤에 더 가까운 교차를 찾았다
+        const BvhNode& node = bvh.nodes[e.node];
+        if (node.count > 0) {
+            if (stats) ++stats->leaves;
+            float t, u, v;
+            int lane = intersect_block(bvh.blocks[node.leftOrFirst], r, tMax, t, u, v);
+            if (lane >= 0) {
+                found = true;
+                if (anyHit) return true;
+                tMax = t;
+                hit->t = t;
+                hit->u = u;
+                hit->v = v;
+                hit->triangle = bvh.blocks[node.leftOrFirst].triangle[lane];
+            }
+            continue;
+        }
+        // 가까운 자식을 나중에 넣어 먼저 꺼낸다
+        if (stats) ++stats->nodes;
+        float t0, t1;
+        bool h0 = hit_box(bvh.nodes[node.leftOrFirst], r, tMax, t0);
+        bool h1 = hit_box(bvh.nodes[node.leftOrFirst + 1], r, tMax, t1);
+        if (h0 && h1) {
+            if (t0 <= t1) {
+                stack[top++] = { node.leftOrFirst + 1, t1 };
+                stack[top++] = { node.leftOrFirst, t0 };
+            }
+            else {
+                stack[top++] = { node.leftOrFirst, t0 };
+                stack[top++] = { node.leftOrFirst + 1, t1 };
+            }
+        }
+        else if (h0) {
+            stack[top++] = { node.leftOrFirst, t0 };
+        }
+        else if (h1) {
+            stack[top++] = { node.leftOrFirst + 1, t1 };
+        }
+    }
+    return found;
+}
+
+// 2^e (정규화 범위의 e 만)
+static float exp2i(int e) {
+    uint32_t bits = (uint32_t)(e + 127) << 23;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+#if MESH_BVH_SSE2
+static __m128 load_u8x4(const uint8_t q[4]) {
+    int32_t packed;
+    memcpy(&packed, q, sizeof(packed));
+    __m128i zero = _mm_setzero_si128();
+    __m128i x = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(x, zero));
+}
+#endif
+
+// 자식 4개와 교차. 맞은 자식의 비트 마스크와 들어가는 t
+//   t = (origin + q * step - o) * inv = q * (step * inv) + (origin - o) * inv
+//   반올림으로 상자 가장자리를 놓치지 않도록 tFar 를 아주 조금 늘린다 (kBoxGrow).
+//   빈 칸 (qlo > qhi) 도 멀리서 보면 q * scale 이 bias 에 묻혀 tNear == tFar 가 되므로
+//   childCount 로 마스크를 잘라 낸다 (빈 칸의 child 는 잎 비트가 켜진 kBvh4Empty)
+static int hit_children(const Bvh4Node& n, const BvhRay& r, float tMax, float tEnter[4]) {
+#if MESH_BVH_SSE2
+    __m128 tNear = _mm_setzero_ps(), tFar = _mm_set1_ps(tMax);
+    for (int a = 0; a < 3; ++a) {
+        __m128 scale = _mm_set1_ps(exp2i(n.exponent[a]) * r.inv[a]);
+        __m128 bias = _mm_set1_ps((n.origin[a] - r.o[a]) * r.inv[a]);
+        __m128 tlo = _mm_add_ps(_mm_mul_ps(load_u8x4(n.qlo[a]), scale), bias);
+        __m128 thi = _mm_add_ps(_mm_mul_ps(load_u8x4(n.qhi[a]), scale), bias);
+        if (r.inv[a] >= 0.0f) {
+            tNear = _mm_max_ps(tNear, tlo);
+            tFar = _mm_min_ps(tFar, thi);
+        }
+        else {
+            tNear = _mm_max_ps(tNear, thi);
+            tFar = _mm_min_ps(tFar, tlo);
+        }
+    }
+    _mm_storeu_ps(tEnter, tNear);
+    return _mm_movemask_ps(_mm_cmple_ps(tNear, _mm_mul_ps(tFar, _mm_set1_ps(kBoxGrow)))) & ((1 << n.childCount) - 1);
+#else
+    int mask = 0;
+    for (int k = 0; k < n.childCount; ++k) {
+        float t0 = 0.0f, t1 = tMax;
+        for (int a = 0; a < 3; ++a) {
+            float scale = exp2i(n.exponent[a]) * r.inv[a];
+            float bias = (n.origin[a] - r.o[a]) * r.inv[a];
+            float tlo = n.qlo[a][k] * scale + bias, thi = n.qhi[a][k] * scale + bias;
+            t0 = std::max(t0, r.inv[a] >= 0.0f ? tlo : thi);
+            t1 = std::min(t1, r.inv[a] >= 0.0f ? thi : tlo);
+        }
+        tEnter[k] = t0;
+        if (t0 <= t1 * kBoxGrow) mask |= 1 << k;
+    }
+    return mask;
+#endif
+}
+
+static bool traverse4(const MeshBvh& bvh, const float origin[3], const float dir[3], float tMax, bool anyHit,
+                      MeshHit* hit, BvhTraceStats* stats) {
+    BvhRay r;
+    make_ray(r, origin, dir);
+    // 양자화 경계는 q * (step * inv) 로 계산하므로 0 * inf (NaN) 가 나오지 않게 inv 를 유한하게
+    for (int a = 0; a < 3; ++a)
+        if (!(fabsf(dir[a]) > 1e-20f)) r.inv[a] = dir[a] < 0.0f ? -1e20f : 1e20f;
+
+    struct Entry { uint32_t child; float t; };
+    Entry stack[kBvh4StackSize];
+    int top = 0;
+    stack[top++] = { 0, 0.0f };
+
+    bool found = false;
+    while (top > 0) {
+        Entry e = stack[--top];
+        if (e.t > tMax) continue;
+        if (e.child & kBvh4Leaf) {
+            if (stats) ++stats->leaves;
+            const TriBlock8& block = bvh.blocks[e.child & ~kBvh4Leaf];
+            float t, u, v;
+            int lane = intersect_block(block, r, tMax, t, u, v);
+            if (lane >= 0) {
+                found = true;
+                if (anyHit) return true;
+                tMax = t;
+                hit->t = t;
+                hit->u = u;
+                hit->v = v;
+                hit->triangle = block.triangle[lane];
+            }
+            continue;
+        }
+
+        if (stats) ++stats->nodes;
+        const Bvh4Node& node = bvh.wide[e.child];
+        float tEnter[4];
+        int mask = hit_children(node, r, tMax, tEnter);
+        if (mask == 0) continue;
+
+        // 맞은 자식을 먼 것부터 넣는다 (가까운 것이 스택 맨 위). 많아야 4개라 삽입 정렬
+        Entry hits[4];
+        int n = 0;
+        for (int k = 0; k < 4; ++k) {
+            if (!(mask & (1 << k))) continue;
+            Entry h = { node.child[k], tEnter[k] };
+            int j = n++;
+            while (j > 0 && hits[j - 1].t < h.t) {
+                hits[j] = hits[j - 1];
+                --j;
+            }
+            hits[j] = h;
+        }
+        for (int k = 0; k < n; ++k)
+            stack[top++] = hits[k];
+    }
+    return found;
+}
+
+bool intersect_mesh_bvh(const MeshBvh& bvh, const float origin[3], const float dir[3], float tMax, MeshHit& hit,
+                        BvhTraceStats* stats) {
+    if (bvh.wide.empty()) return traverse2(bvh, origin, dir, tMax, false, &hit, stats);
+    return traverse4(bvh, origin, dir, tMax, false, &hit, stats);
+}
+
+bool occluded_mesh_bvh(const MeshBvh& bvh, const float origin[3], const float dir[3], float tMax,
+                       BvhTraceStats* stats) {
+    if (bvh.wide.empty()) return traverse2(bvh, origin, dir, tMax, true, nullptr, stats);
+    return traverse4(bvh, origin, dir, tMax, true, nullptr, stats);
+}
+
+bool intersect_mesh_bvh2(const MeshBvh& bvh, const float origin[3], const float dir[3], float tMax, MeshHit& hit,
+                         BvhTraceStats* stats) {
+    return traverse2(bvh, origin, dir, tMax, false, &hit, stats);
+}
+
+bool occluded_mesh_bvh2(const MeshBvh& bvh, const float origin[3], const float dir[3], float tMax,
+                        BvhTraceStats* stats) {
+    return traverse2(bvh, origin, dir, tMax, true, nullptr, stats);
+}
+
+void mesh_hit_normal(const TriMesh& mesh, const MeshHit& hit, float normal[3]) {
+    const uint32_t* tri = &mesh.indices[hit.triangle * 3];
+    float w0 = 1.0f - hit.u - hit.v;
+    for (int a = 0; a < 3; ++a)
+        normal[a] = w0 * mesh.normals[tri[0] * 3 + a] + hit.u * mesh.normals[tri[1] * 3 + a]
+            + hit.v * mesh.normals[tri[2] * 3 + a];
+    float len = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    normal[0] /= len;
+    normal[1] /= len;
+    normal[2] /= len;
+}
+
+void mesh_triangle_normal(const TriMesh& mesh, uint32_t triangle, float normal[3]) {
+    const uint32_t* tri = &mesh.indices[triangle * 3];
+    const float* p = mesh.positions.data();
+    float e1[3], e2[3];
+    for (int a = 0; a < 3; ++a) {
+        e1[a] = p[tri[1] * 3 + a] - p[tri[0] * 3 + a];
+        e2[a] = p[tri[2] * 3 + a] - p[tri[0] * 3 + a];
+    }
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    float len = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    normal[0] /= len;
+    normal[1] /= len;
+    normal[2] /= len;
+}
+
+const char* mesh_bvh_kernel_name() {
+#if defined(__AVX__)
+    return "AVX";
+#else
+    return "scalar";
+#endif
+}
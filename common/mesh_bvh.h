@@ -0,0 +1,119 @@
+﻿#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "bvh_build.h"
+
+// ----------------------------------------------------------------------------
+// 삼각형 메쉬 광선 추적 (HW2_Q3 의 장면 "meshes" 중 .obj)
+//   - OBJ 는 HW8 load_mesh 와 같은 형식 (v / vn / f a//a, 정점과 노멀 번호가 같다)
+//   - BVH: build_bvh (bvh_build.h, 병렬 binned SAH) 로 만들고 잎은 삼각형 8개 이하.
+//     정점이 움직이면 (변형 메쉬) refit_mesh_bvh 로 위상은 그대로 두고 상자만 고친다
+//   - 잎의 삼각형은 성분별 배열 (TriBlock8) 로 옮겨 두고 Möller-Trumbore 를
+//     8개에 한꺼번에 적용한다. __AVX__ 면 AVX, 아니면 같은 계산을 스칼라로
+//   - 순회용으로 이진 트리를 4-wide 노드 (Bvh4Node) 로 접는다. 자식 경계는 부모 상자
+//     기준 8비트로 양자화하고, 자식 4개를 SSE 한 묶음으로 검사한다. 잎 블록은 같이 쓴다
+// ----------------------------------------------------------------------------
+const int kBvhLeafSize = 8;
+const int kBvhStackSize = 64;
+const int kBvh4StackSize = 3 * kBvhStackSize + 1;     // 깊이마다 형제 최대 3개
+
+struct TriMesh {
+    std::vector<float>    positions;   // 정점당 3
+    std::vector<float>    normals;     // 정점당 3 (vn 이 없으면 면 노멀 평균)
+    std::vector<uint32_t> indices;     // 삼각형당 3
+
+    size_t vertex_count() const { return positions.size() / 3; }
+    size_t triangle_count() const { return indices.size() / 3; }
+};
+
+// 실패하면 오류를 출력하고 false
+bool load_obj_mesh(const char* filename, TriMesh& mesh);
+
+// bounding box 중심을 center 로, 가장 긴 변의 절반을 scale 로 맞춘다 (SceneMesh 의 center/scale)
+void place_mesh(TriMesh& mesh, const float center[3], float scale);
+
+// 잎 하나의 삼각형 (빈 칸은 e1 = e2 = 0 이라 교차하지 않는다)
+struct TriBlock8 {
+    float    v0[3][kBvhLeafSize];
+    float    e1[3][kBvhLeafSize];
+    float    e2[3][kBvhLeafSize];
+    uint32_t triangle[kBvhLeafSize];
+};
+
+// 64 바이트 (캐시 라인 하나). 축 a 의 자식 k 경계는
+//   origin[a] + q{lo,hi}[a][k] * 2^exponent[a]   (lo 는 내림, hi 는 올림이라 원래 상자를 덮는다)
+// 자식은 앞의 childCount 칸. 빈 칸은 qlo = 255, qhi = 0 이지만 멀리서는 반올림으로 교차할 수 있어
+// 순회가 childCount 로 거른다
+const uint32_t kBvh4Leaf = 0x80000000u;     // child 의 이 비트가 있으면 잎 블록 번호
+const uint32_t kBvh4Empty = 0xffffffffu;
+
+struct Bvh4Node {
+    float    origin[3];
+    int8_t   exponent[3];
+    uint8_t  childCount;
+    uint8_t  qlo[3][4];
+    uint8_t  qhi[3][4];
+    uint32_t child[4];
+    uint32_t pad[2];
+};
+
+// 잎 블록에 꼭짓점을 복사해 두므로 순회에는 메쉬가 필요 없다
+//   nodes 의 잎은 leftOrFirst = 블록 번호
+struct MeshBvh {
+    std::vector<BvhNode>   nodes;
+    std::vector<TriBlock8> blocks;
+    std::vector<Bvh4Node>  wide;        // collapse_mesh_bvh4 전에는 비어 있다
+    int                    buildThreads = 1;
+    double                 buildMs = 0.0;
+    double                 collapseMs = 0.0;
+    double                 refitMs = 0.0;
+};
+
+// 순회 통계 (측정용, 넘기지 않으면 세지 않는다)
+struct BvhTraceStats {
+    uint64_t nodes = 0;                 // 방문한 내부 노드
+    uint64_t leaves = 0;                // 검사한 잎 블록
+};
+
+struct MeshHit {
+    float    t, u, v;                  // 무게중심 좌표 (v0 이 1 - u - v)
+    uint32_t triangle;
+};
+
+// threads: 0 이면 hardware_concurrency
+void build_mesh_bvh(MeshBvh& bvh, const TriMesh& mesh, int threads = 0, BvhBuildMethod method = BVH_BUILD_SAH);
+
+// mesh 의 정점만 바뀌었을 때 (삼각형 수와 인덱스는 빌드 때와 같아야 한다).
+// 잎 블록 꼭짓점과 노드 상자를 다시 계산하고, wide 가 있으면 다시 접는다
+void refit_mesh_bvh(MeshBvh& bvh, const TriMesh& mesh);
+
+// 이진 트리를 4-wide 로 접는다 (넓이가 가장 큰 내부 자식부터 펼친다)
+void collapse_mesh_bvh4(MeshBvh& bvh);
+
+// 노드 + 잎 블록 크기 (메쉬 자체는 제외). wide 가 있으면 이진 노드 대신 wide 노드를 센다
+size_t mesh_bvh_bytes(const MeshBvh& bvh);
+
+// 가장 가까운 교차 (t < tMax). dir 은 정규화하지 않아도 된다
+// wide 가 있으면 4-wide 로, 없으면 이진 트리로 순회한다
+bool intersect_mesh_bvh(const MeshBvh& bvh, const float origin[3], const float dir[3], float tMax, MeshHit& hit,
+                        BvhTraceStats* stats = nullptr);
+
+// [0, tMax) 에 교차가 하나라도 있으면 true (그림자 광선)
+bool occluded_mesh_bvh(const MeshBvh& bvh, const float origin[3], const float dir[3], float tMax,
+                       BvhTraceStats* stats = nullptr);
+
+// 비교용: wide 가 있어도 이진 트리로 순회
+bool intersect_mesh_bvh2(const MeshBvh& bvh, const float origin[3], const float dir[3], float tMax, MeshHit& hit,
+                         BvhTraceStats* stats = nullptr);
+bool occluded_mesh_bvh2(const MeshBvh& bvh, const float origin[3], const float dir[3], float tMax,
+                        BvhTraceStats* stats = nullptr);
+
+// 정점 노멀을 무게중심 좌표로 보간 (정규화)
+void mesh_hit_normal(const TriMesh& mesh, const MeshHit& hit, float normal[3]);
+
+// 삼각형 면 노멀 (v0 -> v1 -> v2 반시계 방향이 앞면, 정규화)
+void mesh_triangle_normal(const TriMesh& mesh, uint32_t triangle, float normal[3]);
+
+// 빌드한 커널 이름 ("AVX" 또는 "scalar")
+const char* mesh_bvh_kernel_name();
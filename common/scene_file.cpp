@@ -0,0 +1,707 @@
+﻿#define _CRT_SECURE_NO_WARNINGS
+#include "scene_file.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>
+
+void SceneSpheres::add(float x, float y, float z, float r, uint32_t m) {
+    cx.push_back(x);
+    cy.push_back(y);
+    cz.push_back(z);
+    radius.push_back(r);
+    material.push_back(m);
+}
+
+static bool read_file(const char* filename, std::vector<char>& out) {
+    FILE* f = fopen(filename, "rb");
+    if (!f) {
+        printf("ERROR: cannot open %s\n", filename);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    out.resize((size_t)size + 1);
+    size_t got = fread(out.data(), 1, (size_t)size, f);
+    fclose(f);
+    out.resize(got + 1);
+    out[got] = 0;   // 파서가 끝을 따로 검사하지 않도록
+    return true;
+}
+
+static void set3(float v[3], float x, float y, float z) {
+    v[0] = x; v[1] = y; v[2] = z;
+}
+
+static void default_camera(SceneCamera& c) {
+    set3(c.eye, 0, 0, 0);
+    set3(c.u, 1, 0, 0);
+    set3(c.v, 0, 1, 0);
+    set3(c.w, 0, 0, 1);
+    c.l = -0.1f; c.r = 0.1f; c.b = -0.1f; c.t = 0.1f;
+    c.distance = 0.1f;
+}
+
+// ----------------------------------------------------------------------------
+// JSON 읽기: 장면 구조에 맞춘 스트리밍 파서 (DOM 을 만들지 않음)
+//   키는 고정 버퍼에 읽고, 숫자는 strtod 대신 직접 변환해서 객체 100만 개도 빠르게
+// ----------------------------------------------------------------------------
+struct JsonReader {
+    const char* p;
+    const char* begin;
+    const char* filename;
+    bool        failed;
+
+    void ws() {
+        while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') ++p;
+    }
+
+    bool error(const char* what) {
+        if (!failed) {
+            int line = 1;
+            for (const char* q = begin; q < p; ++q)
+                if (*q == '\n') ++line;
+            printf("ERROR: %s:%d: %s\n", filename, line, what);
+        }
+        failed = true;
+        return false;
+    }
+
+    bool expect(char c) {
+        ws();
+        if (*p != c) {
+            char msg[32];
+            sprintf(msg, "'%c' expected", c);
+            return error(msg);
+        }
+        ++p;
+        return true;
+    }
+
+    bool string(char* buf, size_t size) {
+        if (!expect('"')) return false;
+        size_t n = 0;
+        while (*p && *p != '"') {
+            char c = *p++;
+            if (c == '\\' && *p) c = *p++;   // \" \\ 만 의미가 있다
+            if (n + 1 < size) buf[n++] = c;
+        }
+        buf[n] = 0;
+        if (*p != '"') return error("unterminated string");
+        ++p;
+        return true;
+    }
+
+    bool number(double& out) {
+        static const double kPow10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        ws();
+        bool neg = *p == '-';
+        if (neg) ++p;
+        if (*p < '0' || *p > '9') return error("number expected");
+
+        uint64_t mantissa = 0;
+        int digits = 0, exp10 = 0;
+        for (; *p >= '0' && *p <= '9'; ++p) {
+            if (digits < 18) { mantissa = mantissa * 10 + (*p - '0'); if (mantissa) ++digits; }
+            else ++exp10;
+        }
+        if (*p == '.') {
+            for (++p; *p >= '0' && *p <= '9'; ++p)
+                if (digits < 18) { mantissa = mantissa * 10 + (*p - '0'); if (mantissa) ++digits; --exp10; }
+        }
+        if (*p == 'e' || *p == 'E') {
+            ++p;
+            bool eneg = *p == '-';
+            if (*p == '-' || *p == '+') ++p;
+            int e = 0;
+            for (; *p >= '0' && *p <= '9'; ++p)
+                if (e < 1000) e = e * 10 + (*p - '0');
+            exp10 += eneg ? -e : e;
+        }
+
+        double v = (double)mantissa;
+        if (exp10 >= 0) v *= exp10 <= 22 ? kPow10[exp10] : pow(10.0, exp10);
+        else v /= -exp10 <= 22 ? kPow10[-exp10] : pow(10.0, -exp10);
+        out = neg ? -v : v;
+        return true;
+    }
+
+    bool number(float& out) {
+        double v;
+        if (!number(v)) return false;
+        out = (float)v;
+        return true;
+    }
+
+    bool integer(int& out) {
+        double v;
+        if (!number(v)) return false;
+        out = (int)v;
+        return true;
+    }
+
+    bool index(uint32_t& out) {
+        double v;
+        if (!number(v)) return false;
+        if (v < 0) return error("negative index");
+        out = (uint32_t)v;
+        return true;
+    }
+
+    bool floats(float* v, int n) {
+        if (!expect('[')) return false;
+        for (int i = 0; i < n; ++i)
+            if ((i > 0 && !expect(',')) || !number(v[i])) return false;
+        return expect(']');
+    }
+
+    // { "key": value, ... } 순회. 끝이나 오류면 false (오류는 failed 로 구분)
+    bool next_member(bool& first, char* key, size_t size) {
+        ws();
+        if (*p == '}') { ++p; return false; }
+        if (!first && !expect(',')) return false;
+        first = false;
+        return string(key, size) && expect(':');
+    }
+
+    // [ value, ... ] 순회
+    bool next_element(bool& first) {
+        ws();
+        if (*p == ']') { ++p; return false; }
+        if (!first && !expect(',')) return false;
+        first = false;
+        return true;
+    }
+
+    // 모르는 키의 값은 통째로 건너뛴다
+    bool skip() {
+        ws();
+        if (*p == '"') {
+            char tmp[1];
+            return string(tmp, 1);
+        }
+        if (*p == '{' || *p == '[') {
+            char close = *p == '{' ? '}' : ']';
+            ++p;
+            bool first = true;
+            char key[64];
+            while (close == '}' ? next_member(first, key, sizeof(key)) : next_element(first))
+                if (!skip()) return false;
+            return !failed;
+        }
+        if (*p == '-' || (*p >= '0' && *p <= '9')) {
+            double v;
+            return number(v);
+        }
+        if (!strncmp(p, "true", 4) || !strncmp(p, "null", 4)) { p += 4; return true; }
+        if (!strncmp(p, "false", 5)) { p += 5; return true; }
+        return error("value expected");
+    }
+};
+
+static void normalize3(float v[3]) {
+    float len = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (len > 0.0f)
+        for (int a = 0; a < 3; ++a) v[a] /= len;
+}
+
+static void cross3(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// w = eye - target 방향 (카메라는 -w 를 본다), u = up x w, v = w x u
+static void look_at(SceneCamera& c, const float target[3], const float up[3]) {
+    for (int a = 0; a < 3; ++a) c.w[a] = c.eye[a] - target[a];
+    normalize3(c.w);
+    cross3(up, c.w, c.u);
+    normalize3(c.u);
+    cross3(c.w, c.u, c.v);
+}
+
+static bool parse_camera(JsonReader& in, SceneCamera& c) {
+    if (!in.expect('{')) return false;
+    bool first = true;
+    char key[64];
+    float target[3], up[3] = { 0.0f, 1.0f, 0.0f };
+    float fov = 0.0f;
+    bool hasTarget = false;
+    while (in.next_member(first, key, sizeof(key))) {
+        bool ok;
+        if (!strcmp(key, "eye")) ok = in.floats(c.eye, 3);
+        else if (!strcmp(key, "u")) ok = in.floats(c.u, 3);
+        else if (!strcmp(key, "v")) ok = in.floats(c.v, 3);
+        else if (!strcmp(key, "w")) ok = in.floats(c.w, 3);
+        else if (!strcmp(key, "window")) ok = in.floats(&c.l, 4);
+        else if (!strcmp(key, "distance")) ok = in.number(c.distance);
+        else if (!strcmp(key, "target")) ok = hasTarget = in.floats(target, 3);
+        else if (!strcmp(key, "up")) ok = in.floats(up, 3);
+        else if (!strcmp(key, "fov")) ok = in.number(fov);
+        else ok = in.skip();
+        if (!ok) return false;
+    }
+    if (hasTarget) look_at(c, target, up);
+    if (fov > 0.0f) {
+        // 정사각형 창. 다른 비율은 카메라 (camera_setup) 가 가로를 맞춘다
+        c.t = c.distance * tanf(0.5f * fov * 3.14159265f / 180.0f);
+        c.b = -c.t;
+        c.r = c.t;
+        c.l = -c.t;
+    }
+    return !in.failed;
+}
+
+static bool parse_light(JsonReader& in, SceneLight& l) {
+    set3(l.position, 0, 0, 0);
+    set3(l.color, 1, 1, 1);
+    l.radius = 0.0f;
+    if (!in.expect('{')) return false;
+    bool first = true;
+    char key[64];
+    while (in.next_member(first, key, sizeof(key))) {
+        bool ok;
+        if (!strcmp(key, "position")) ok = in.floats(l.position, 3);
+        else if (!strcmp(key, "color")) ok = in.floats(l.color, 3);
+        else if (!strcmp(key, "radius")) ok = in.number(l.radius);
+        else ok = in.skip();
+        if (!ok) return false;
+    }
+    return !in.failed;
+}
+
+static bool parse_material(JsonReader& in, SceneMaterial& m) {
+    memset(&m, 0, sizeof(m));
+    m.ior = 1.0f;
+    if (!in.expect('{')) return false;
+    bool first = true;
+    char key[64];
+    while (in.next_member(first, key, sizeof(key))) {
+        bool ok;
+        if (!strcmp(key, "ka")) ok = in.floats(m.ka, 3);
+        else if (!strcmp(key, "kd")) ok = in.floats(m.kd, 3);
+        else if (!strcmp(key, "ks")) ok = in.floats(m.ks, 3);
+        else if (!strcmp(key, "spec_pow")) ok = in.number(m.specPow);
+        else if (!strcmp(key, "kr")) ok = in.number(m.kr);
+        else if (!strcmp(key, "kt")) ok = in.number(m.kt);
+        else if (!strcmp(key, "ior")) ok = in.number(m.ior);
+        else if (!strcmp(key, "emission")) ok = in.floats(m.emission, 3);
+        else ok = in.skip();
+        if (!ok) return false;
+    }
+    return !in.failed;
+}
+
+static bool parse_sphere(JsonReader& in, SceneSpheres& spheres) {
+    float c[3] = { 0, 0, 0 }, r = 1.0f;
+    uint32_t material = 0;
+    if (!in.expect('{')) return false;
+    bool first = true;
+    char key[64];
+    while (in.next_member(first, key, sizeof(key))) {
+        bool ok;
+        if (!strcmp(key, "center")) ok = in.floats(c, 3);
+        else if (!strcmp(key, "radius")) ok = in.number(r);
+        else if (!strcmp(key, "material")) ok = in.index(material);
+        else ok = in.skip();
+        if (!ok) return false;
+    }
+    if (in.failed) return false;
+    spheres.add(c[0], c[1], c[2], r, material);
+    return true;
+}
+
+static bool parse_plane(JsonReader& in, ScenePlane& pl) {
+    set3(pl.normal, 0, 1, 0);
+    pl.offset = 0.0f;
+    pl.material = 0;
+    if (!in.expect('{')) return false;
+    bool first = true;
+    char key[64];
+    while (in.next_member(first, key, sizeof(key))) {
+        bool ok;
+        if (!strcmp(key, "normal")) ok = in.floats(pl.normal, 3);
+        else if (!strcmp(key, "offset")) ok = in.number(pl.offset);
+        else if (!strcmp(key, "material")) ok = in.index(pl.material);
+        else ok = in.skip();
+        if (!ok) return false;
+    }
+    if (in.failed) return false;
+
+    // 법선을 정규화하고 offset 도 같은 비율로
+    float len = sqrtf(pl.normal[0] * pl.normal[0] + pl.normal[1] * pl.normal[1] + pl.normal[2] * pl.normal[2]);
+    if (len == 0.0f) return in.error("plane normal is zero");
+    set3(pl.normal, pl.normal[0] / len, pl.normal[1] / len, pl.normal[2] / len);
+    pl.offset /= len;
+    return true;
+}
+
+static bool parse_mesh(JsonReader& in, SceneMesh& m) {
+    m.source.clear();
+    m.slices = 32;
+    m.stacks = 16;
+    set3(m.center, 0, 0, 0);
+    m.scale = 1.0f;
+    m.material = 0;
+    if (!in.expect('{')) return false;
+    bool first = true;
+    char key[64];
+    while (in.next_member(first, key, sizeof(key))) {
+        bool ok;
+        if (!strcmp(key, "source")) {
+            char source[260];
+            ok = in.string(source, sizeof(source));
+            m.source = source;
+        }
+        else if (!strcmp(key, "slices")) ok = in.integer(m.slices);
+        else if (!strcmp(key, "stacks")) ok = in.integer(m.stacks);
+        else if (!strcmp(key, "center")) ok = in.floats(m.center, 3);
+        else if (!strcmp(key, "scale")) ok = in.number(m.scale);
+        else if (!strcmp(key, "material")) ok = in.index(m.material);
+        else ok = in.skip();
+        if (!ok) return false;
+    }
+    return !in.failed;
+}
+
+static bool parse_scene_json(const std::vector<char>& text, const char* filename, SceneData& scene) {
+    JsonReader in = { text.data(), text.data(), filename, false };
+    if (!in.expect('{')) return false;
+    bool first = true;
+    char key[64];
+    while (in.next_member(first, key, sizeof(key))) {
+        if (!strcmp(key, "camera")) {
+            if (!parse_camera(in, scene.camera)) return false;
+            continue;
+        }
+        bool known = !strcmp(key, "lights") || !strcmp(key, "materials") || !strcmp(key, "spheres")
+            || !strcmp(key, "planes") || !strcmp(key, "meshes");
+        if (!known) {
+            if (!in.skip()) return false;
+            continue;
+        }
+
+        if (!in.expect('[')) return false;
+        bool firstElement = true;
+        while (in.next_element(firstElement)) {
+            bool ok;
+            if (key[0] == 'l') {
+                scene.lights.emplace_back();
+                ok = parse_light(in, scene.lights.back());
+            }
+            else if (key[0] == 'm' && key[1] == 'a') {
+                scene.materials.emplace_back();
+                ok = parse_material(in, scene.materials.back());
+            }
+            else if (key[0] == 's') {
+                ok = parse_sphere(in, scene.spheres);
+            }
+            else if (key[0] == 'p') {
+                scene.planes.emplace_back();
+                ok = parse_plane(in, scene.planes.back());
+            }
+            else {
+                scene.meshes.emplace_back();
+                ok = parse_mesh(in, scene.meshes.back());
+            }
+            if (!ok) return false;
+        }
+        if (in.failed) return false;
+    }
+    return !in.failed;
+}
+
+// ----------------------------------------------------------------------------
+// 바이너리: 헤더 + 카메라 + 광원/재질 배열 + 구 성분 배열 + 평면 배열 + 메시
+// ----------------------------------------------------------------------------
+struct SceneBinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t lights, materials, spheres, planes, meshes;
+    uint32_t reserved;
+};
+static const uint32_t kSceneMagic = 0x424e4353;   // "SCNB"
+static const uint32_t kSceneVersion = 3;      // 2: 재질에 kr/kt/ior 추가, 3: emission 추가
+
+// 버전별 재질 크기. 필드는 뒤에만 붙으므로 예전 재질은 앞부분만 채우고 나머지는 기본값
+static const size_t kMaterialSize[kSceneVersion + 1] = { 0, 10 * sizeof(float), 13 * sizeof(float), sizeof(SceneMaterial) };
+
+struct BinaryReader {
+    const char* p;
+    const char* end;
+
+    bool take(void* dst, size_t n) {
+        if ((size_t)(end - p) < n) return false;
+        memcpy(dst, p, n);
+        p += n;
+        return true;
+    }
+
+    // 남은 바이트로 size 바이트짜리 count 개를 담을 수 있는가 (헤더의 개수를 믿고
+    // 크게 잡기 전에 확인한다)
+    bool fits(uint32_t count, size_t size) const {
+        return count <= (size_t)(end - p) / size;
+    }
+
+    template <typename T>
+    bool array(std::vector<T>& out, uint32_t count) {
+        if (!fits(count, sizeof(T))) return false;
+        out.resize(count);
+        return count == 0 || take(out.data(), count * sizeof(T));
+    }
+};
+
+static bool parse_scene_binary(const std::vector<char>& data, const char* filename, SceneData& scene) {
+    BinaryReader in = { data.data(), data.data() + data.size() - 1 };
+    SceneBinaryHeader h;
+    if (!in.take(&h, sizeof(h)) || h.magic != kSceneMagic || h.version < 1 || h.version > kSceneVersion) {
+        printf("ERROR: %s: unsupported binary scene version\n", filename);
+        return false;
+    }
+    bool ok = in.take(&scene.camera, sizeof(SceneCamera))
+        && in.array(scene.lights, h.lights);
+    if (h.version < kSceneVersion) {
+        ok = ok && in.fits(h.materials, kMaterialSize[h.version]);
+        scene.materials.resize(ok ? h.materials : 0);
+        for (SceneMaterial& m : scene.materials) {
+            memset(&m, 0, sizeof(m));
+            m.ior = 1.0f;
+            ok = ok && in.take(&m, kMaterialSize[h.version]);
+        }
+    }
+    else {
+        ok = ok && in.array(scene.materials, h.materials);
+    }
+    ok = ok && in.array(scene.spheres.cx, h.spheres)
+        && in.array(scene.spheres.cy, h.spheres)
+        && in.array(scene.spheres.cz, h.spheres)
+        && in.array(scene.spheres.radius, h.spheres)
+        && in.array(scene.spheres.material, h.spheres)
+        && in.array(scene.planes, h.planes);
+    ok = ok && in.fits(h.meshes, sizeof(uint32_t));
+    scene.meshes.resize(ok ? h.meshes : 0);
+    for (SceneMesh& m : scene.meshes) {
+        uint32_t length = 0;
+        ok = ok && in.take(&length, sizeof(length)) && (size_t)(in.end - in.p) >= length;
+        if (!ok) break;
+        m.source.assign(in.p, length);
+        in.p += length;
+        ok = in.take(&m.slices, sizeof(m.slices)) && in.take(&m.stacks, sizeof(m.stacks))
+            && in.take(m.center, sizeof(m.center)) && in.take(&m.scale, sizeof(m.scale))
+            && in.take(&m.material, sizeof(m.material));
+    }
+    if (!ok) printf("ERROR: %s: truncated binary scene\n", filename);
+    return ok;
+}
+
+// ----------------------------------------------------------------------------
+// 공개 함수
+// ----------------------------------------------------------------------------
+static bool check_materials(const SceneData& scene, const char* filename) {
+    uint32_t count = (uint32_t)scene.materials.size();
+    for (size_t i = 0; i < scene.spheres.size(); ++i)
+        if (scene.spheres.material[i] >= count) {
+            printf("ERROR: %s: sphere %d uses material %u of %u\n", filename, (int)i, scene.spheres.material[i], count);
+            return false;
+        }
+    for (size_t i = 0; i < scene.planes.size(); ++i)
+        if (scene.planes[i].material >= count) {
+            printf("ERROR: %s: plane %d uses material %u of %u\n", filename, (int)i, scene.planes[i].material, count);
+            return false;
+        }
+    for (size_t i = 0; i < scene.meshes.size(); ++i)
+        if (scene.meshes[i].material >= count) {
+            printf("ERROR: %s: mesh %d uses material %u of %u\n", filename, (int)i, scene.meshes[i].material, count);
+            return false;
+        }
+    return true;
+}
+
+bool load_scene(const char* filename, SceneData& scene) {
+    scene = SceneData();
+    default_camera(scene.camera);
+
+    std::vector<char> data;
+    if (!read_file(filename, data)) return false;
+
+    bool binary = data.size() > 4 && !memcmp(data.data(), "SCNB", 4);
+    bool ok = binary ? parse_scene_binary(data, filename, scene) : parse_scene_json(data, filename, scene);
+    if (ok) ok = check_materials(scene, filename);
+    if (!ok) {
+        scene = SceneData();
+        default_camera(scene.camera);
+    }
+    return ok;
+}
+
+// 다시 읽었을 때 같은 float 가 되는 가장 짧은 표기 (0.1 -> "0.1", "0.100000001" 이 아니라)
+static const char* format_float(char* buf, float v) {
+    for (int precision = 6; precision < 9; ++precision) {
+        sprintf(buf, "%.*g", precision, v);
+        if (strtof(buf, nullptr) == v) return buf;
+    }
+    sprintf(buf, "%.9g", v);
+    return buf;
+}
+
+static void write_floats(FILE* f, const float* v, int n) {
+    char buf[32];
+    fputc('[', f);
+    for (int i = 0; i < n; ++i)
+        fprintf(f, i ? ", %s" : "%s", format_float(buf, v[i]));
+    fputc(']', f);
+}
+
+static void close_array(FILE* f, size_t count, const char* tail) {
+    fprintf(f, count ? "\n  ]%s" : "]%s", tail);
+}
+
+bool save_scene_json(const char* filename, const SceneData& scene) {
+    FILE* f = fopen(filename, "wb");
+    if (!f) {
+        printf("ERROR: cannot write %s\n", filename);
+        return false;
+    }
+    char buf[32];
+    const SceneCamera& c = scene.camera;
+    fprintf(f, "{\n  \"camera\": { \"eye\": ");
+    write_floats(f, c.eye, 3);
+    fprintf(f, ", \"u\": ");
+    write_floats(f, c.u, 3);
+    fprintf(f, ", \"v\": ");
+    write_floats(f, c.v, 3);
+    fprintf(f, ", \"w\": ");
+    write_floats(f, c.w, 3);
+    fprintf(f, ",\n              \"window\": ");
+    write_floats(f, &c.l, 4);
+    fprintf(f, ", \"distance\": %s },\n", format_float(buf, c.distance));
+
+    fprintf(f, "  \"lights\": [");
+    for (size_t i = 0; i < scene.lights.size(); ++i) {
+        const SceneLight& l = scene.lights[i];
+        fprintf(f, "%s\n    { \"position\": ", i ? "," : "");
+        write_floats(f, l.position, 3);
+        fprintf(f, ", \"color\": ");
+        write_floats(f, l.color, 3);
+        fprintf(f, ", \"radius\": %s }", format_float(buf, l.radius));
+    }
+    close_array(f, scene.lights.size(), ",\n  \"materials\": [");
+    for (size_t i = 0; i < scene.materials.size(); ++i) {
+        const SceneMaterial& m = scene.materials[i];
+        fprintf(f, "%s\n    { \"ka\": ", i ? "," : "");
+        write_floats(f, m.ka, 3);
+        fprintf(f, ", \"kd\": ");
+        write_floats(f, m.kd, 3);
+        fprintf(f, ", \"ks\": ");
+        write_floats(f, m.ks, 3);
+        fprintf(f, ", \"spec_pow\": %s", format_float(buf, m.specPow));
+        // 불투명 재질은 kr/kt/ior 를 생략 (읽을 때 기본값과 같다)
+        if (m.kr != 0.0f || m.kt != 0.0f || m.ior != 1.0f) {
+            fprintf(f, ", \"kr\": %s", format_float(buf, m.kr));
+            fprintf(f, ", \"kt\": %s", format_float(buf, m.kt));
+            fprintf(f, ", \"ior\": %s", format_float(buf, m.ior));
+        }
+        if (m.emission[0] != 0.0f || m.emission[1] != 0.0f || m.emission[2] != 0.0f) {
+            fprintf(f, ", \"emission\": ");
+            write_floats(f, m.emission, 3);
+        }
+        fprintf(f, " }");
+    }
+    close_array(f, scene.materials.size(), ",\n  \"spheres\": [");
+    const SceneSpheres& s = scene.spheres;
+    for (size_t i = 0; i < s.size(); ++i) {
+        float center[3] = { s.cx[i], s.cy[i], s.cz[i] };
+        fprintf(f, "%s\n    { \"center\": ", i ? "," : "");
+        write_floats(f, center, 3);
+        fprintf(f, ", \"radius\": %s, \"material\": %u }", format_float(buf, s.radius[i]), s.material[i]);
+    }
+    close_array(f, s.size(), ",\n  \"planes\": [");
+    for (size_t i = 0; i < scene.planes.size(); ++i) {
+        const ScenePlane& p = scene.planes[i];
+        fprintf(f, "%s\n    { \"normal\": ", i ? "," : "");
+        write_floats(f, p.normal, 3);
+        fprintf(f, ", \"offset\": %s, \"material\": %u }", format_float(buf, p.offset), p.material);
+    }
+    close_array(f, scene.planes.size(), ",\n  \"meshes\": [");
+    for (size_t i = 0; i < scene.meshes.size(); ++i) {
+        const SceneMesh& m = scene.meshes[i];
+        fprintf(f, "%s\n    { \"source\": \"%s\", \"slices\": %d, \"stacks\": %d, \"center\": ",
+            i ? "," : "", m.source.c_str(), m.slices, m.stacks);
+        write_floats(f, m.center, 3);
+        fprintf(f, ", \"scale\": %s, \"material\": %u }", format_float(buf, m.scale), m.material);
+    }
+    close_array(f, scene.meshes.size(), "\n}\n");
+    fclose(f);
+    return true;
+}
+
+bool save_scene_binary(const char* filename, const SceneData& scene) {
+    FILE* f = fopen(filename, "wb");
+    if (!f) {
+        printf("ERROR: cannot write %s\n", filename);
+        return false;
+    }
+    SceneBinaryHeader h = { kSceneMagic, kSceneVersion,
+        (uint32_t)scene.lights.size(), (uint32_t)scene.materials.size(), (uint32_t)scene.spheres.size(),
+        (uint32_t)scene.planes.size(), (uint32_t)scene.meshes.size(), 0 };
+    const SceneSpheres& s = scene.spheres;
+    fwrite(&h, sizeof(h), 1, f);
+    fwrite(&scene.camera, sizeof(SceneCamera), 1, f);
+    fwrite(scene.lights.data(), sizeof(SceneLight), scene.lights.size(), f);
+    fwrite(scene.materials.data(), sizeof(SceneMaterial), scene.materials.size(), f);
+    fwrite(s.cx.data(), sizeof(float), s.size(), f);
+    fwrite(s.cy.data(), sizeof(float), s.size(), f);
+    fwrite(s.cz.data(), sizeof(float), s.size(), f);
+    fwrite(s.radius.data(), sizeof(float), s.size(), f);
+    fwrite(s.material.data(), sizeof(uint32_t), s.size(), f);
+    fwrite(scene.planes.data(), sizeof(ScenePlane), scene.planes.size(), f);
+    for (const SceneMesh& m : scene.meshes) {
+        uint32_t length = (uint32_t)m.source.size();
+        fwrite(&length, sizeof(length), 1, f);
+        fwrite(m.source.data(), 1, length, f);
+        fwrite(&m.slices, sizeof(m.slices), 1, f);
+        fwrite(&m.stacks, sizeof(m.stacks), 1, f);
+        fwrite(m.center, sizeof(m.center), 1, f);
+        fwrite(&m.scale, sizeof(m.scale), 1, f);
+        fwrite(&m.material, sizeof(m.material), 1, f);
+    }
+    fclose(f);
+    return true;
+}
+
+void make_hw2_scene(SceneData& scene) {
+    scene = SceneData();
+    default_camera(scene.camera);
+
+    SceneLight light = { { -4, 4, -3 }, { 1, 1, 1 }, 0.0f };
+    scene.lights.push_back(light);
+
+    const SceneMaterial materials[] = {
+        { { 0.2f, 0, 0 }, { 1, 0, 0 }, { 0, 0, 0 }, 0, 0, 0, 1, { 0, 0, 0 } },
+        { { 0, 0.2f, 0 }, { 0, 0.5f, 0 }, { 0.5f, 0.5f, 0.5f }, 32, 0, 0, 1, { 0, 0, 0 } },
+        { { 0, 0, 0.2f }, { 0, 0, 1 }, { 0, 0, 0 }, 0, 0, 0, 1, { 0, 0, 0 } },
+        { { 0.2f, 0.2f, 0.2f }, { 1, 1, 1 }, { 0, 0, 0 }, 0, 0, 0, 1, { 0, 0, 0 } },
+    };
+    scene.materials.assign(materials, materials + 4);
+
+    scene.spheres.add(-4, 0, -7, 1, 0);
+    scene.spheres.add(0, 0, -7, 2, 1);
+    scene.spheres.add(4, 0, -7, 1, 2);
+
+    ScenePlane plane = { { 0, 1, 0 }, -2.0f, 3 };
+    scene.planes.push_back(plane);
+}
+
+void load_scene_or_default(const char* filename, SceneData& scene) {
+    if (filename && load_scene(filename, scene)) {
+        printf("[Scene] %s: %d spheres, %d planes, %d meshes, %d lights, %d materials\n", filename,
+            (int)scene.spheres.size(), (int)scene.planes.size(), (int)scene.meshes.size(),
+            (int)scene.lights.size(), (int)scene.materials.size());
+        return;
+    }
+    printf("[Scene] using the built-in HW2 scene\n");
+    make_hw2_scene(scene);
+}
@@ -0,0 +1,94 @@
+﻿#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// 장면 파일 (HW2 레이 트레이서, HW6_Q3 / HW7_Q1 래스터라이저가 같이 사용)
+//   텍스트: JSON (scenes/hw2.json 참고). 모르는 키는 건너뛴다.
+//   바이너리: "SCNB" 헤더 + 배열을 그대로 덤프 (큰 장면을 빨리 읽을 때)
+//   load_scene 은 파일 앞 4바이트로 형식을 구분한다.
+//
+//   {
+//     "camera":    { "eye": [x,y,z], "u": [..], "v": [..], "w": [..],
+//                    "window": [l, r, b, t], "distance": d },
+//                  u/v/w 대신 "target": [..], "up": [0,1,0] 이면 look-at 기저를,
+//                  "fov": 세로 시야각 (도) 이면 window 를 distance * tan(fov / 2) 로 계산한다
+//     "lights":    [ { "position": [..], "color": [..], "radius": 0 } ],
+//     "materials": [ { "ka": [..], "kd": [..], "ks": [..], "spec_pow": 32,
+//                      "kr": 0, "kt": 0, "ior": 1, "emission": [0,0,0] } ],
+//     "spheres":   [ { "center": [..], "radius": 1, "material": 0 } ],
+//     "planes":    [ { "normal": [0,1,0], "offset": -2, "material": 3 } ],
+//     "meshes":    [ { "source": "sphere", "slices": 32, "stacks": 16,
+//                      "center": [..], "scale": 1, "material": 0 } ]
+//   }
+// ----------------------------------------------------------------------------
+
+// HW2 의 카메라: eye 에서 -w 방향으로 distance 만큼 떨어진 [l,r] x [b,t] 이미지 평면
+struct SceneCamera {
+    float eye[3], u[3], v[3], w[3];
+    float l, r, b, t;
+    float distance;
+};
+
+struct SceneLight {
+    float position[3];
+    float color[3];
+    float radius;          // <= 0 이면 감쇠 없음 (TileLight 와 같은 의미)
+};
+
+// kr/kt/ior/emission 은 HW2_Q3 의 Whitted / 경로 추적에서만 쓴다.
+// 생략하면 0, 0, 1, 0 (불투명, 반사 없음, 발광 없음)
+struct SceneMaterial {
+    float ka[3], kd[3], ks[3];
+    float specPow;         // 0 이면 정반사 없음
+    float kr;              // 거울 반사율
+    float kt;              // 유전체 (유리) 비율: Fresnel 로 반사/굴절을 나눈다
+    float ior;             // 굴절률
+    float emission[3];     // 방출 radiance. 이 재질의 구는 경로 추적에서 면광원이 된다
+};
+
+// dot(normal, p) = offset
+struct ScenePlane {
+    float    normal[3];
+    float    offset;
+    uint32_t material;
+};
+
+// 외부 메시 참조. source 가 "sphere" 면 slices x stacks 로 테셀레이션하는 단위 구
+struct SceneMesh {
+    std::string source;
+    int         slices, stacks;
+    float       center[3];
+    float       scale;
+    uint32_t    material;
+};
+
+// 구는 개수가 많을 수 있으므로 성분별 배열 (교차 검사 루프가 필요한 배열만 읽는다)
+struct SceneSpheres {
+    std::vector<float>    cx, cy, cz, radius;
+    std::vector<uint32_t> material;
+
+    size_t size() const { return radius.size(); }
+    void   add(float x, float y, float z, float r, uint32_t m);
+};
+
+struct SceneData {
+    SceneCamera                camera;
+    std::vector<SceneLight>    lights;
+    std::vector<SceneMaterial> materials;
+    SceneSpheres               spheres;
+    std::vector<ScenePlane>    planes;
+    std::vector<SceneMesh>     meshes;
+};
+
+// 실패하면 오류를 출력하고 false (scene 은 비워진다)
+bool load_scene(const char* filename, SceneData& scene);
+bool save_scene_json(const char* filename, const SceneData& scene);
+bool save_scene_binary(const char* filename, const SceneData& scene);
+
+// HW2_Q1 에 하드코딩되어 있던 장면 (구 3개 + y = -2 평면 + 광원 (-4,4,-3))
+void make_hw2_scene(SceneData& scene);
+
+// filename 을 읽고, 없거나 잘못되었으면 make_hw2_scene 으로 대신한다
+void load_scene_or_default(const char* filename, SceneData& scene);
@@ -0,0 +1,113 @@
+﻿#include "shadow_map.h"
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+static void normalize3(float v[3]) {
+    float len = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    v[0] /= len; v[1] /= len; v[2] /= len;
+}
+
+static void cross3(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// 월드 좌표 -> 맵 texel 좌표 (sx, sy) 와 빛 시점 거리 z
+static void project(const ShadowMap& sm, const float p[3], float& sx, float& sy, float& z) {
+    float d[3] = { p[0] - sm.lightPos[0], p[1] - sm.lightPos[1], p[2] - sm.lightPos[2] };
+    z = d[0] * sm.axis[0] + d[1] * sm.axis[1] + d[2] * sm.axis[2];
+    float x = (d[0] * sm.right[0] + d[1] * sm.right[1] + d[2] * sm.right[2]) * sm.scale / z;
+    float y = (d[0] * sm.up[0] + d[1] * sm.up[1] + d[2] * sm.up[2]) * sm.scale / z;
+    sx = (x * 0.5f + 0.5f) * sm.size;
+    sy = (y * 0.5f + 0.5f) * sm.size;
+}
+
+void setup_shadow_map(ShadowMap& sm, int size, const float lightPos[3],
+                      const float casterCenter[3], float casterRadius) {
+    sm.size = size;
+    for (int i = 0; i < 3; ++i) {
+        sm.lightPos[i] = lightPos[i];
+        sm.axis[i] = casterCenter[i] - lightPos[i];
+    }
+    float dist = sqrtf(sm.axis[0] * sm.axis[0] + sm.axis[1] * sm.axis[1] + sm.axis[2] * sm.axis[2]);
+    normalize3(sm.axis);
+
+    float hint[3] = { 0.0f, 1.0f, 0.0f };
+    if (fabsf(sm.axis[1]) > 0.99f) { hint[1] = 0.0f; hint[2] = 1.0f; }
+    cross3(sm.axis, hint, sm.right);
+    normalize3(sm.right);
+    cross3(sm.right, sm.axis, sm.up);
+
+    // 경계 구에 접하는 원뿔: sin(fov/2) = r / d. 빛이 구 안에 있으면 90도로 제한
+    float sinHalf = std::min(casterRadius / dist, 0.7071f);
+    sm.scale = sqrtf(1.0f - sinHalf * sinHalf) / sinHalf;
+    sm.nearPlane = std::max(dist - casterRadius, 0.01f * dist);
+
+    sm.depth.assign((size_t)size * size, FLT_MAX);
+}
+
+// ----------------------------------------------------------------------------
+// 깊이 패스: 화면 공간에서 1/z 를 선형 보간 (원근 보정) 하고 가까운 값을 남긴다
+// ----------------------------------------------------------------------------
+void shadow_map_triangle(ShadowMap& sm, const float p0[3], const float p1[3], const float p2[3]) {
+    float x[3], y[3], z[3];
+    project(sm, p0, x[0], y[0], z[0]);
+    project(sm, p1, x[1], y[1], z[1]);
+    project(sm, p2, x[2], y[2], z[2]);
+    if (z[0] < sm.nearPlane || z[1] < sm.nearPlane || z[2] < sm.nearPlane) return;
+
+    float area = (x[2] - x[0]) * (y[1] - y[0]) - (y[2] - y[0]) * (x[1] - x[0]);
+    if (area == 0.0f) return;
+    float invArea = 1.0f / area;
+
+    int minX = std::max(0, (int)floorf(std::min({ x[0], x[1], x[2] })));
+    int maxX = std::min(sm.size - 1, (int)ceilf(std::max({ x[0], x[1], x[2] })));
+    int minY = std::max(0, (int)floorf(std::min({ y[0], y[1], y[2] })));
+    int maxY = std::min(sm.size - 1, (int)ceilf(std::max({ y[0], y[1], y[2] })));
+
+    for (int py = minY; py <= maxY; ++py) {
+        float cy = py + 0.5f;
+        float* row = &sm.depth[(size_t)py * sm.size];
+        for (int px = minX; px <= maxX; ++px) {
+            float cx = px + 0.5f;
+            float w0 = ((cx - x[1]) * (y[2] - y[1]) - (cy - y[1]) * (x[2] - x[1])) * invArea;
+            float w1 = ((cx - x[2]) * (y[0] - y[2]) - (cy - y[2]) * (x[0] - x[2])) * invArea;
+            float w2 = 1.0f - w0 - w1;
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+            float d = 1.0f / (w0 / z[0] + w1 / z[1] + w2 / z[2]);
+            if (d < row[px]) row[px] = d;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// PCF: 주변 (2r+1)^2 texel 과 비교한 결과의 평균
+//   acne 방지: texel 하나의 월드 크기만큼 노멀 방향으로 띄우고, 같은 크기의 bias 를 더 준다
+// ----------------------------------------------------------------------------
+float shadow_visibility(const ShadowMap& sm, const float pos[3], const float normal[3], int pcfRadius) {
+    float sx, sy, z;
+    project(sm, pos, sx, sy, z);
+    if (z < sm.nearPlane) return 1.0f;   // 모든 caster 보다 빛에 가깝다
+
+    float texel = 2.0f * z / (sm.scale * sm.size);
+    float offset[3] = {
+        pos[0] + 1.5f * texel * normal[0],
+        pos[1] + 1.5f * texel * normal[1],
+        pos[2] + 1.5f * texel * normal[2] };
+    project(sm, offset, sx, sy, z);
+    float receiver = z - texel;
+
+    int cx = (int)floorf(sx), cy = (int)floorf(sy);
+    int lit = 0, taps = 0;
+    for (int dy = -pcfRadius; dy <= pcfRadius; ++dy)
+        for (int dx = -pcfRadius; dx <= pcfRadius; ++dx) {
+            int tx = cx + dx, ty = cy + dy;
+            ++taps;
+            if (tx < 0 || ty < 0 || tx >= sm.size || ty >= sm.size
+                || receiver <= sm.depth[(size_t)ty * sm.size + tx])
+                ++lit;
+        }
+    return (float)lit / taps;
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// 점광원 그림자 맵 (HW6_Q3 소프트웨어 래스터라이저용, HW7_Q1 GL 경로와 같은 구성)
+//   빛 위치에서 그림자를 드리우는 물체들의 경계 구를 바라보는 원근 투영 하나로
+//   빛 시점 거리를 기록하고, 셰이딩 때 PCF 로 주변 texel 을 비교해 가림 비율을 구한다.
+//   맵 밖 (경계 구를 지나지 않는 빛 경로) 은 가릴 물체가 없으므로 항상 빛을 받는다.
+//   좌표는 모두 HW2 장면과 같은 월드/시점 공간.
+// ----------------------------------------------------------------------------
+const int kShadowMapSize = 1024;
+const int kShadowPcfRadius = 1;     // 1 -> 3x3 texel
+
+struct ShadowMap {
+    int   size;
+    float lightPos[3];
+    float axis[3], right[3], up[3];  // 빛 시점 기저 (axis: 빛 -> 경계 구 중심)
+    float scale;                     // 1 / tan(fov / 2)
+    float nearPlane;
+    std::vector<float> depth;        // size*size 개의 axis 방향 거리, 빈 texel 은 FLT_MAX
+};
+
+// 빛이 center/radius 경계 구 전체를 보도록 투영을 맞추고 깊이를 비운다
+void setup_shadow_map(ShadowMap& sm, int size, const float lightPos[3],
+                      const float casterCenter[3], float casterRadius);
+
+// 그림자를 드리우는 삼각형 하나를 깊이 맵에 그린다 (월드 좌표, 면 방향 무관)
+void shadow_map_triangle(ShadowMap& sm, const float p0[3], const float p1[3], const float p2[3]);
+
+// pos 가 빛을 받는 비율 (0: 완전 그림자, 1: 빛). normal 은 acne 를 막는 오프셋에 쓴다
+float shadow_visibility(const ShadowMap& sm, const float pos[3], const float normal[3],
+                        int pcfRadius = kShadowPcfRadius);